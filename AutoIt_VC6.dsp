@@ -53,7 +53,7 @@ BSC32=bscmake.exe
 # ADD BSC32 /nologo
 LINK32=link.exe
 # ADD BASE LINK32 kernel32.lib user32.lib gdi32.lib winspool.lib comdlg32.lib advapi32.lib shell32.lib ole32.lib oleaut32.lib uuid.lib odbc32.lib odbccp32.lib /nologo /subsystem:windows /machine:I386
-# ADD LINK32 kernel32.lib user32.lib gdi32.lib winspool.lib comdlg32.lib advapi32.lib shell32.lib ole32.lib oleaut32.lib uuid.lib odbc32.lib odbccp32.lib winmm.lib version.lib wsock32.lib comctl32.lib mpr.lib /nologo /subsystem:windows /pdb:none /machine:I386 /out:"bin/AutoIt3.exe" /libpath:"src/lib" /opt:nowin98 /opt:ref /tsaware
+# ADD LINK32 kernel32.lib user32.lib gdi32.lib winspool.lib comdlg32.lib advapi32.lib shell32.lib ole32.lib oleaut32.lib uuid.lib odbc32.lib odbccp32.lib winmm.lib version.lib wsock32.lib comctl32.lib mpr.lib /nologo /subsystem:windows /pdb:none /machine:I386 /out:"bin/AutoIt3.exe" /libpath:"src/lib" /stack:0x1000000 /opt:nowin98 /opt:ref /tsaware
 # Begin Special Build Tool
 SOURCE="$(InputPath)"
 PostBuild_Cmds=bin\upx.exe --best bin\AutoIt3.exe
@@ -83,7 +83,7 @@ BSC32=bscmake.exe
 # ADD BSC32 /nologo
 LINK32=link.exe
 # ADD BASE LINK32 kernel32.lib user32.lib gdi32.lib winspool.lib comdlg32.lib advapi32.lib shell32.lib ole32.lib oleaut32.lib uuid.lib odbc32.lib odbccp32.lib /nologo /subsystem:windows /debug /machine:I386 /pdbtype:sept
-# ADD LINK32 kernel32.lib user32.lib gdi32.lib winspool.lib comdlg32.lib advapi32.lib shell32.lib ole32.lib oleaut32.lib uuid.lib odbc32.lib odbccp32.lib winmm.lib version.lib wsock32.lib comctl32.lib mpr.lib /nologo /subsystem:windows /debug /machine:I386 /out:"bin/AutoIt3.exe" /pdbtype:sept
+# ADD LINK32 kernel32.lib user32.lib gdi32.lib winspool.lib comdlg32.lib advapi32.lib shell32.lib ole32.lib oleaut32.lib uuid.lib odbc32.lib odbccp32.lib winmm.lib version.lib wsock32.lib comctl32.lib mpr.lib /nologo /subsystem:windows /debug /machine:I386 /out:"bin/AutoIt3.exe" /pdbtype:sept /stack:0x1000000
 
 !ENDIF 
 
@@ -103,6 +103,10 @@ SOURCE=.\src\astring_datatype.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\bytecode_datatype.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\stack_int_datatype.cpp
 # End Source File
 # Begin Source File
@@ -257,6 +261,22 @@ SOURCE=.\src\utility.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\string_search.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\string_search_sse2.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\line_reader.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\name_hash.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\variabletable.cpp
 # End Source File
 # End Group
@@ -272,6 +292,10 @@ SOURCE=.\src\astring_datatype.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\bytecode_datatype.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\stack_int_datatype.h
 # End Source File
 # Begin Source File
@@ -385,6 +409,18 @@ SOURCE=.\src\utility.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\string_search.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\line_reader.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\name_hash.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\variabletable.h
 # End Source File
 # End Group
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// bench.h
+//
+// Helpers shared by the benchmark programs in this directory (see
+// README.txt).  Each benchmark is a single console program that includes
+// this file once: it provides a timer and counts every call to new so that
+// allocation counts can be reported alongside the times.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+#include <new>
+
+
+// Number of calls to new/new[] so far
+static long	g_nBenchAllocs = 0;
+
+#if __cplusplus < 201103L
+	#define BENCH_THROW_BADALLOC	throw(std::bad_alloc)
+#else
+	#define BENCH_THROW_BADALLOC
+#endif
+
+void * operator new(size_t nSize) BENCH_THROW_BADALLOC
+{
+	void	*p = malloc(nSize ? nSize : 1);
+
+	++g_nBenchAllocs;
+	if (p == NULL)
+		throw std::bad_alloc();
+	return p;
+}
+
+void * operator new[](size_t nSize) BENCH_THROW_BADALLOC
+{
+	void	*p = malloc(nSize ? nSize : 1);
+
+	++g_nBenchAllocs;
+	if (p == NULL)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) throw()	{ free(p); }
+void operator delete[](void *p) throw()	{ free(p); }
+
+#if __cplusplus >= 201402L						// Sized deletes (C++14 compilers)
+void operator delete(void *p, size_t) throw()	{ free(p); }
+void operator delete[](void *p, size_t) throw()	{ free(p); }
+#endif
+
+
+// Seconds since an arbitrary start point
+static double Bench_Now(void)
+{
+	static LARGE_INTEGER	liFreq;
+	LARGE_INTEGER			liNow;
+
+	if (liFreq.QuadPart == 0)
+		QueryPerformanceFrequency(&liFreq);
+	QueryPerformanceCounter(&liNow);
+
+	return (double)liNow.QuadPart / (double)liFreq.QuadPart;
+}
+
+
+// Size arguments: the sizes on the command line, or the defaults
+static int Bench_Sizes(int argc, char *argv[], int *pnSizes, int nMax, const int *pnDefaults, int nDefaults)
+{
+	int	i, n = 0;
+
+	for (i = 1; i < argc && n < nMax; ++i)
+		pnSizes[n++] = atoi(argv[i]);
+
+	if (n == 0)
+	{
+		for (i = 0; i < nDefaults && i < nMax; ++i)
+			pnSizes[n++] = pnDefaults[i];
+	}
+
+	return n;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
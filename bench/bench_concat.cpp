@@ -0,0 +1,205 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// bench_concat.cpp
+//
+// Building a long string from N appends of a 102 byte line.  Compares the
+// old Variant::Concat() (a reference copy below, which strcpy/strcat's the
+// whole string) with the current one, both in place as "&=" does, and as
+// "$s = $s & $line" does it: copy $s onto the expression stack, append,
+// and assign the result back.  The rows that are quadratic are skipped
+// above 20000 appends.
+//
+// bench_concat [N ...]		(default 5000 10000 1000000)
+//
+// concat.au3 does the same from a script.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench.h"
+#include "variant_datatype.h"
+
+
+#define BENCH_QUADMAX	20000
+
+// The string part of the old Variant, with its Concat()
+class OldString
+{
+public:
+	OldString() : m_nStrLen(0), m_nStrAlloc(1) { m_szValue = new char[1]; m_szValue[0] = '\0'; }
+	OldString(const OldString &sOp2) { m_szValue = NULL; *this = sOp2; }
+	~OldString() { delete [] m_szValue; }
+
+	OldString& operator=(const OldString &sOp2)
+	{
+		if (this == &sOp2)
+			return *this;
+		delete [] m_szValue;
+		m_nStrLen	= sOp2.m_nStrLen;
+		m_nStrAlloc	= m_nStrLen + 1;
+		m_szValue	= new char[m_nStrAlloc];
+		strcpy(m_szValue, sOp2.m_szValue);
+		return *this;
+	}
+
+	OldString& operator=(const char *szOp2)
+	{
+		delete [] m_szValue;
+		m_nStrLen	= (int)strlen(szOp2);
+		m_nStrAlloc	= m_nStrLen + 1;
+		m_szValue	= new char[m_nStrAlloc];
+		strcpy(m_szValue, szOp2);
+		return *this;
+	}
+
+	void Concat(const OldString &sOp2)
+	{
+		m_nStrLen += sOp2.m_nStrLen;
+		if ( (m_nStrLen+1) > m_nStrAlloc)
+		{
+			m_nStrAlloc = (m_nStrLen << 1) + 1;
+			char	*szTempString = new char[m_nStrAlloc];
+			strcpy(szTempString, m_szValue);
+			strcat(szTempString, sOp2.m_szValue);
+			delete [] m_szValue;
+			m_szValue = szTempString;
+		}
+		else
+			strcat(m_szValue, sOp2.m_szValue);
+	}
+
+	int		length(void) const { return m_nStrLen; }
+
+private:
+	char	*m_szValue;
+	int		m_nStrLen;
+	int		m_nStrAlloc;
+};
+
+
+// Same operations on the current Variant
+class NewString
+{
+public:
+	NewString() { m_vValue = ""; }
+	NewString& operator=(const char *szOp2) { m_vValue = szOp2; return *this; }
+	void	Concat(NewString &sOp2) { m_vValue.Concat(sOp2.m_vValue); }
+	int		length(void) { return (int)strlen(m_vValue.szValue()); }
+
+	Variant	m_vValue;
+};
+
+
+template <class T> static double AppendInPlace(int N, int &nLen)
+{
+	T		sResult, sLine;
+	double	t0 = Bench_Now();
+
+	sLine = "The quick brown fox jumps over the lazy dog, the quick brown fox jumps over the lazy dog again 1234567";
+	for (int i = 0; i < N; ++i)
+		sResult.Concat(sLine);				// $s &= $line
+
+	t0 = Bench_Now() - t0;
+	nLen = sResult.length();
+	return t0;
+}
+
+template <class T> static double AppendCopy(int N, int &nLen)
+{
+	T		sResult, sLine;
+	double	t0 = Bench_Now();
+
+	sLine = "The quick brown fox jumps over the lazy dog, the quick brown fox jumps over the lazy dog again 1234567";
+	for (int i = 0; i < N; ++i)
+	{
+		T	sTemp = sResult;				// $s = $s & $line
+		sTemp.Concat(sLine);
+		sResult = sTemp;
+	}
+
+	t0 = Bench_Now() - t0;
+	nLen = sResult.length();
+	return t0;
+}
+
+
+int main(int argc, char *argv[])
+{
+	static const int	nDefaults[] = { 5000, 10000, 1000000 };
+	int					nSizes[16], nNumSizes, s, N, nLen, nFails = 0;
+	double				t;
+
+	nNumSizes = Bench_Sizes(argc, argv, nSizes, 16, nDefaults, 3);
+
+	printf("%-24s %10s   %-8s %-8s\n", "", "N", "old", "new");
+
+	for (s = 0; s < nNumSizes; ++s)
+	{
+		N = nSizes[s];
+
+		printf("%-24s %10d   ", "$s &= $line", N);
+		if (N <= BENCH_QUADMAX)
+		{
+			t = AppendInPlace<OldString>(N, nLen);
+			nFails += nLen != N * 102;
+			printf("%-8.3f ", t);
+		}
+		else
+			printf("%-8s ", "skipped");
+		t = AppendInPlace<NewString>(N, nLen);
+		nFails += nLen != N * 102;
+		printf("%-8.3f\n", t);
+
+		printf("%-24s %10d   ", "$s = $s & $line", N);
+		if (N <= BENCH_QUADMAX)
+		{
+			t = AppendCopy<OldString>(N, nLen);
+			nFails += nLen != N * 102;
+			printf("%-8.3f ", t);
+			t = AppendCopy<NewString>(N, nLen);
+			nFails += nLen != N * 102;
+			printf("%-8.3f\n", t);
+		}
+		else
+			printf("%-8s %-8s\n", "skipped", "skipped");
+	}
+
+	if (nFails)
+		printf("FAILED: wrong result length\n");
+
+	return nFails ? 1 : 0;
+}
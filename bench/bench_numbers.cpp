@@ -0,0 +1,177 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// bench_numbers.cpp
+//
+// Variant::FormatInt64(), FormatDouble(), ParseInt64() and ParseDouble()
+// against the CRT calls they replaced in GenStringValue(), nValue() etc.
+// First checks that they give exactly the same results as the CRT for
+// random values, then times N calls of each.
+//
+// bench_numbers [N ...]		(default 5000000)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench.h"
+#include "variant_datatype.h"
+
+
+static int	g_nFails = 0;
+
+static __int64 Random64(void)
+{
+	__int64	n64 = 0;
+
+	for (int i = 0; i < 5; ++i)
+		n64 = (n64 << 15) ^ rand();				// rand() may only give 15 bits
+	n64 >>= rand() % 60;
+
+	return (rand() & 1) ? -n64 : n64;
+}
+
+static void CheckInt(__int64 n64)
+{
+	char	szA[32], szB[32];
+
+	Variant::FormatInt64(n64, szA);
+	_i64toa(n64, szB, 10);
+	if (strcmp(szA, szB) != 0)
+		++g_nFails;
+
+	__int64	n64Parsed;
+	if (Variant::ParseInt64(szB, n64Parsed, 18) && n64Parsed != _atoi64(szB))
+		++g_nFails;
+}
+
+static void CheckDouble(double fValue)
+{
+	char	szA[64], szB[64];
+	int		nLen = Variant::FormatDouble(fValue, szA);
+
+	sprintf(szB, "%.15g", fValue);
+	if (strcmp(szA, szB) != 0 || nLen != (int)strlen(szB))
+		++g_nFails;
+
+	if (fValue >= 1e18 || fValue <= -1e18)
+		return;									// "%f" would overflow szB
+
+	double	fParsed, fCRT;
+	sprintf(szB, "%.*f", rand() % 8, fValue);
+	fCRT = atof(szB);
+	if (Variant::ParseDouble(szB, fParsed) && memcmp(&fParsed, &fCRT, sizeof(double)) != 0)
+		++g_nFails;
+}
+
+
+int main(int argc, char *argv[])
+{
+	static const int	nDefaults[] = { 5000000 };
+	int					nSizes[16], nNumSizes, s, i, N;
+	char				szBuf[64];
+	double				t0, fSum = 0, fTemp;
+	__int64				n64Sum = 0, n64Temp;
+
+	// Correctness against the CRT
+	CheckInt(0);	CheckInt(-1);	CheckInt(2147483647);
+	CheckInt(-(__int64)2147483647 - 1);
+	CheckInt(((__int64)0x7fffffff << 32) | 0xffffffff);
+	CheckInt(-(((__int64)0x7fffffff << 32) | 0xffffffff) - 1);
+	CheckDouble(0.0);	CheckDouble(-0.0);	CheckDouble(1e15);	CheckDouble(999999999999999.0);
+	CheckDouble(0.1 + 0.2);	CheckDouble(1e300);	CheckDouble(-12.125);
+
+	srand(1);
+	for (i = 0; i < 1000000; ++i)
+	{
+		__int64	n64 = Random64();
+		CheckInt(n64);
+		CheckDouble((double)n64);
+		CheckDouble((double)n64 / (1 + rand() % 100000));
+		CheckDouble((double)(rand() % 100000));
+	}
+
+	printf("results against the CRT: %s\n\n", g_nFails ? "FAILED" : "ok");
+
+	nNumSizes = Bench_Sizes(argc, argv, nSizes, 16, nDefaults, 1);
+
+	printf("%-20s %10s   %-8s %-8s\n", "", "N", "CRT", "Variant");
+
+	for (s = 0; s < nNumSizes; ++s)
+	{
+		N = nSizes[s];
+
+		t0 = Bench_Now();
+		for (i = 0; i < N; ++i)		sprintf(szBuf, "%.15g", (double)i);
+		printf("%-20s %10d   %-8.3f ", "whole doubles", N, Bench_Now() - t0);
+		t0 = Bench_Now();
+		for (i = 0; i < N; ++i)		Variant::FormatDouble((double)i, szBuf);
+		printf("%-8.3f\n", Bench_Now() - t0);
+
+		t0 = Bench_Now();
+		for (i = 0; i < N; ++i)		sprintf(szBuf, "%.15g", i * 0.37);
+		printf("%-20s %10d   %-8.3f ", "fractional doubles", N, Bench_Now() - t0);
+		t0 = Bench_Now();
+		for (i = 0; i < N; ++i)		Variant::FormatDouble(i * 0.37, szBuf);
+		printf("%-8.3f\n", Bench_Now() - t0);
+
+		t0 = Bench_Now();
+		for (i = 0; i < N; ++i)		_i64toa(i, szBuf, 10);
+		printf("%-20s %10d   %-8.3f ", "int64", N, Bench_Now() - t0);
+		t0 = Bench_Now();
+		for (i = 0; i < N; ++i)		Variant::FormatInt64(i, szBuf);
+		printf("%-8.3f\n", Bench_Now() - t0);
+
+		t0 = Bench_Now();
+		for (i = 0; i < N; ++i)		fSum += atof("12345.678");
+		printf("%-20s %10d   %-8.3f ", "parse \"12345.678\"", N, Bench_Now() - t0);
+		t0 = Bench_Now();
+		for (i = 0; i < N; ++i)		{ Variant::ParseDouble("12345.678", fTemp); fSum += fTemp; }
+		printf("%-8.3f\n", Bench_Now() - t0);
+
+		t0 = Bench_Now();
+		for (i = 0; i < N; ++i)		n64Sum += _atoi64("1234567");
+		printf("%-20s %10d   %-8.3f ", "parse \"1234567\"", N, Bench_Now() - t0);
+		t0 = Bench_Now();
+		for (i = 0; i < N; ++i)		{ Variant::ParseInt64("1234567", n64Temp, 18); n64Sum += n64Temp; }
+		printf("%-8.3f\n", Bench_Now() - t0);
+	}
+
+	// Use the sums so the loops can't be optimised away
+	if (fSum == 0 || n64Sum == 0)
+		printf("\n");
+
+	return g_nFails ? 1 : 0;
+}
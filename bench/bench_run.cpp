@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// bench_run.cpp
+//
+// Driver for the .au3 benchmark scripts.  Runs a program (normally
+// AutoIt3.exe and a script) with its stdout on a pipe, drains the pipe,
+// and reports the wall clock time and the CPU time the process used.  The
+// pipe is what a collector reading a script's ConsoleWrite() output sees.
+//
+// bench_run [-q] <program> [parameters ...]
+//
+//   -q		Count the output bytes but don't show them
+//
+// e.g.	bench_run -q ..\bin\AutoIt3.exe console.au3 1000000 65536
+//		bench_run ..\bin\AutoIt3.exe wait.au3 idle
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench.h"
+
+
+static double FileTimeSecs(const FILETIME &ft)
+{
+	ULARGE_INTEGER	uli;
+
+	uli.LowPart		= ft.dwLowDateTime;
+	uli.HighPart	= ft.dwHighDateTime;
+
+	return (double)(__int64)uli.QuadPart / 10000000.0;	// 100ns units
+}
+
+
+int main(int argc, char *argv[])
+{
+	bool				bQuiet = false;
+	int					nArg = 1;
+	char				szCmdLine[4096] = "";
+	SECURITY_ATTRIBUTES	sa;
+	HANDLE				hRead, hWrite;
+	STARTUPINFO			si;
+	PROCESS_INFORMATION	pi;
+	char				szBuf[65536];
+	DWORD				dwRead, dwExitCode;
+	double				fBytes = 0, t0, fWall;
+	FILETIME			ftCreate, ftExit, ftKernel, ftUser;
+
+	if (nArg < argc && strcmp(argv[nArg], "-q") == 0)
+	{
+		bQuiet = true;
+		++nArg;
+	}
+
+	if (nArg >= argc)
+	{
+		printf("usage: bench_run [-q] <program> [parameters ...]\n");
+		return 1;
+	}
+
+	// Rebuild the command line, quoting each part
+	for (; nArg < argc; ++nArg)
+	{
+		if (strlen(szCmdLine) + strlen(argv[nArg]) + 4 >= sizeof(szCmdLine))
+		{
+			printf("command line too long\n");
+			return 1;
+		}
+		strcat(szCmdLine, "\"");
+		strcat(szCmdLine, argv[nArg]);
+		strcat(szCmdLine, "\" ");
+	}
+
+	// The child gets the write end of the pipe as its stdout
+	sa.nLength				= sizeof(sa);
+	sa.lpSecurityDescriptor	= NULL;
+	sa.bInheritHandle		= TRUE;
+
+	if (!CreatePipe(&hRead, &hWrite, &sa, 0))
+	{
+		printf("CreatePipe failed\n");
+		return 1;
+	}
+	SetHandleInformation(hRead, HANDLE_FLAG_INHERIT, 0);
+
+	memset(&si, 0, sizeof(si));
+	si.cb			= sizeof(si);
+	si.dwFlags		= STARTF_USESTDHANDLES;
+	si.hStdInput	= GetStdHandle(STD_INPUT_HANDLE);
+	si.hStdOutput	= hWrite;
+	si.hStdError	= GetStdHandle(STD_ERROR_HANDLE);
+
+	t0 = Bench_Now();
+
+	if (!CreateProcess(NULL, szCmdLine, NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi))
+	{
+		printf("couldn't run: %s\n", szCmdLine);
+		return 1;
+	}
+
+	// Close our copy of the write end so ReadFile() fails when the child exits
+	CloseHandle(hWrite);
+
+	while (ReadFile(hRead, szBuf, sizeof(szBuf), &dwRead, NULL) && dwRead)
+	{
+		fBytes += dwRead;
+		if (!bQuiet)
+			fwrite(szBuf, 1, dwRead, stdout);
+	}
+
+	WaitForSingleObject(pi.hProcess, INFINITE);
+	fWall = Bench_Now() - t0;
+
+	GetExitCodeProcess(pi.hProcess, &dwExitCode);
+	GetProcessTimes(pi.hProcess, &ftCreate, &ftExit, &ftKernel, &ftUser);
+
+	printf("\nwall %.3fs  user %.3fs  kernel %.3fs  output %.0f bytes  exit code %u\n",
+		fWall, FileTimeSecs(ftUser), FileTimeSecs(ftKernel), fBytes, (unsigned)dwExitCode);
+
+	CloseHandle(hRead);
+	CloseHandle(pi.hThread);
+	CloseHandle(pi.hProcess);
+
+	return 0;
+}
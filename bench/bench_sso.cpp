@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// bench_sso.cpp
+//
+// Short strings held inside the Variant (VAR_STRINLINE).  Each iteration
+// assigns a string to a Variant, copies it to a second one (as a value is
+// copied onto the stack or into a variable) and reads it back.  Strings of
+// up to 7 characters are stored inline; longer ones go to the heap, which
+// is what every string did before, so the 8 and 20 character rows show the
+// old cost per string as well as the overhead the inline check adds to
+// them.
+//
+// bench_sso [N ...]		(default 10000000)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench.h"
+#include "variant_datatype.h"
+
+
+int main(int argc, char *argv[])
+{
+	static const int	nDefaults[] = { 10000000 };
+	static const char	*szShort[] = { "a", "x", "Hello", "abc", "1234567" };
+	static const char	*szRows[] = { "1-7 chars", "8 chars", "20 chars" };
+	int					nSizes[16], nNumSizes, s, k, i, nFails = 0;
+	double				t0;
+	long				nAllocs;
+	size_t				nLen;
+
+	nNumSizes = Bench_Sizes(argc, argv, nSizes, 16, nDefaults, 1);
+
+	printf("%-10s %10s   %-8s %-12s\n", "strings", "N", "time", "allocs/iter");
+
+	for (s = 0; s < nNumSizes; ++s)
+	{
+		for (k = 0; k < 3; ++k)
+		{
+			nLen = 0;
+			nAllocs = g_nBenchAllocs;
+			t0 = Bench_Now();
+
+			for (i = 0; i < nSizes[s]; ++i)
+			{
+				const char	*szValue = k == 0 ? szShort[i % 5] : k == 1 ? "12345678" : "12345678901234567890";
+				Variant		vValue;
+
+				vValue = szValue;
+				Variant		vCopy = vValue;
+				nLen += strlen(vCopy.szValue());
+				if (vCopy.szValue()[0] != szValue[0])
+					++nFails;
+			}
+
+			printf("%-10s %10d   %-8.3f %-12.2f\n", szRows[k], nSizes[s], Bench_Now() - t0,
+				(double)(g_nBenchAllocs - nAllocs) / nSizes[s]);
+		}
+	}
+
+	if (nFails)
+		printf("FAILED: copied strings differ\n");
+
+	return nFails ? 1 : 0;
+}
@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// bench_stacks.cpp
+//
+// The expression operator and value stacks.  Each simulated expression is
+// $a + $b + $c + $d (or the same with &): it pushes 5 operators and 4
+// values and reduces them to one result.
+//
+// - old: a copy of the linked list stacks (one new per push), a fresh pair
+//   of stacks for every expression, and each reduce copies both operands off
+//   the stack and pushes a new result - as Parser_EvaluateExpression() did.
+// - new: StackInt/StackVariant shared by every expression and truncated
+//   back afterwards, with the operator applied in place on the stack.
+//
+// bench_stacks [N ...]		(default 1000000 expressions)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench.h"
+#include "variant_datatype.h"
+#include "stack_int_datatype.h"
+#include "stack_variant_datatype.h"
+
+
+// The old linked list stacks
+template <class T> class OldStack
+{
+public:
+	OldStack() : m_lpTop(NULL) {}
+	~OldStack() { while (m_lpTop) pop(); }
+
+	void	push(const T &Item)	{ Node *lpNew = new Node; lpNew->Item = Item; lpNew->lpNext = m_lpTop; m_lpTop = lpNew; }
+	void	pop(void)			{ Node *lpNext = m_lpTop->lpNext; delete m_lpTop; m_lpTop = lpNext; }
+	T &		top(void)			{ return m_lpTop->Item; }
+
+private:
+	struct Node
+	{
+		T		Item;
+		Node	*lpNext;
+	};
+
+	Node	*m_lpTop;
+};
+
+
+static void OldExpression(Variant *pvValues, bool bConcat, Variant &vResult)
+{
+	OldStack<int>		opStack;
+	OldStack<Variant>	valStack;
+	Variant				vOp1, vOp2;
+	int					i;
+
+	opStack.push(0);
+	for (i = 0; i < 4; ++i)
+	{
+		opStack.push(1);
+		valStack.push(pvValues[i]);
+	}
+
+	for (i = 0; i < 3; ++i)
+	{
+		vOp2 = valStack.top();	valStack.pop();
+		vOp1 = valStack.top();	valStack.pop();
+		if (bConcat)
+			vOp1.Concat(vOp2);
+		else
+			vOp1 += vOp2;
+		valStack.push(vOp1);
+		opStack.pop();
+	}
+
+	vResult = valStack.top();
+}
+
+
+static void NewExpression(StackInt &opStack, StackVariant &valStack, Variant *pvValues, bool bConcat, Variant &vResult)
+{
+	unsigned int	nOpBase = opStack.size(), nValBase = valStack.size();
+	int				i;
+
+	opStack.push(0);
+	for (i = 0; i < 4; ++i)
+	{
+		opStack.push(1);
+		valStack.push(pvValues[i]);
+	}
+
+	for (i = 0; i < 3; ++i)
+	{
+		if (bConcat)
+			valStack.top(1).Concat(valStack.top());
+		else
+			valStack.top(1) += valStack.top();
+		valStack.pop();
+		opStack.pop();
+	}
+
+	vResult.Swap(valStack.top());
+
+	opStack.truncate(nOpBase);
+	valStack.truncate(nValBase);
+}
+
+
+int main(int argc, char *argv[])
+{
+	static const int	nDefaults[] = { 1000000 };
+	int					nSizes[16], nNumSizes, s, i, k, nFails = 0;
+	Variant				vValues[2][4], vOld, vNew;
+	StackInt			opStack;
+	StackVariant		valStack;
+	double				t0, fOld, fNew;
+	long				nOldAllocs, nNewAllocs;
+
+	for (i = 0; i < 4; ++i)
+	{
+		vValues[0][i] = i + 1;
+		vValues[1][i] = "abc";
+	}
+
+	nNumSizes = Bench_Sizes(argc, argv, nSizes, 16, nDefaults, 1);
+
+	printf("%-8s %10s   %-10s %-12s   %-10s %-12s\n", "values", "N", "old", "old allocs", "new", "new allocs");
+
+	for (s = 0; s < nNumSizes; ++s)
+	{
+		for (k = 0; k < 2; ++k)
+		{
+			nOldAllocs = g_nBenchAllocs;
+			t0 = Bench_Now();
+			for (i = 0; i < nSizes[s]; ++i)
+				OldExpression(vValues[k], k == 1, vOld);
+			fOld = Bench_Now() - t0;
+			nOldAllocs = g_nBenchAllocs - nOldAllocs;
+
+			nNewAllocs = g_nBenchAllocs;
+			t0 = Bench_Now();
+			for (i = 0; i < nSizes[s]; ++i)
+				NewExpression(opStack, valStack, vValues[k], k == 1, vNew);
+			fNew = Bench_Now() - t0;
+			nNewAllocs = g_nBenchAllocs - nNewAllocs;
+
+			if (strcmp(vOld.szValue(), vNew.szValue()) != 0)
+				++nFails;
+
+			printf("%-8s %10d   %-10.3f %-12ld   %-10.3f %-12ld\n", k == 0 ? "int" : "string", nSizes[s], fOld, nOldAllocs, fNew, nNewAllocs);
+		}
+	}
+
+	if (nFails)
+		printf("FAILED: old and new results differ\n");
+
+	return nFails ? 1 : 0;
+}
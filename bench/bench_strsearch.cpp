@@ -0,0 +1,252 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// bench_strsearch.cpp
+//
+// StringSearch.  First checks find() and rfind() against a naive search on
+// random text (with and without SSE2, case sensitive and not), then times
+// searching a large text three ways:
+//
+// - old: strncmp()/strnicmp() at every offset, as AString::find_str() did
+// - horspool: StringSearch with the SSE2 path turned off
+// - sse2: StringSearch as used (only if the CPU has SSE2 and the build has
+//   the intrinsics, see string_search_sse2.cpp)
+//
+// The text repeats "The quick brown fox jumps over the lazy dog.\r\n".  The
+// workloads are StringInStr() of a "Needle" placed only at the very end
+// (10 times) and counting every "fox" as StringReplace() does.
+//
+// bench_strsearch [MB ...]		(default 1 10)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench.h"
+#include "string_search.h"
+
+
+// Naive reference searches (ASCII case folding, same as StringSearch)
+static bool NaiveMatch(const char *szT, const char *szP, int nLen, bool bCaseSense)
+{
+	for (int j = 0; j < nLen; ++j)
+	{
+		unsigned char	a = (unsigned char)szT[j], b = (unsigned char)szP[j];
+		if (!bCaseSense)
+		{
+			if (a >= 'A' && a <= 'Z')	a += 'a' - 'A';
+			if (b >= 'A' && b <= 'Z')	b += 'a' - 'A';
+		}
+		if (a != b)
+			return false;
+	}
+	return true;
+}
+
+static int NaiveFind(const char *szT, int nTextLen, const char *szP, bool bCaseSense, int nStart)
+{
+	int	nLen = (int)strlen(szP);
+
+	if (nLen == 0 || nStart < 0)
+		return -1;
+	for (int i = nStart; i + nLen <= nTextLen; ++i)
+	{
+		if (NaiveMatch(szT + i, szP, nLen, bCaseSense))
+			return i;
+	}
+	return -1;
+}
+
+static int NaiveRFind(const char *szT, int nTextLen, const char *szP, bool bCaseSense, int nStart)
+{
+	int	nLen = (int)strlen(szP);
+	int	i = nTextLen - nLen;
+
+	if (nLen == 0)
+		return -1;
+	if (nStart < i)
+		i = nStart;
+	for (; i >= 0; --i)
+	{
+		if (NaiveMatch(szT + i, szP, nLen, bCaseSense))
+			return i;
+	}
+	return -1;
+}
+
+
+// The old AString::find_str() inner loop (nth match from the start)
+static int OldFind(const char *szText, int nTextLen, const char *szP, bool bCaseSense, int nStart)
+{
+	int	nLen = (int)strlen(szP);
+
+	for (int i = nStart; i < nTextLen; ++i)
+	{
+		if ( (bCaseSense ? strncmp(szText+i, szP, nLen) : strnicmp(szText+i, szP, nLen)) == 0 )
+			return i;
+	}
+	return -1;
+}
+
+
+static int Check(void)
+{
+	static const char	szAlphabet[] = "aAbBzZ\x80\xc1";
+	char				szText[400], szPattern[32];
+	int					r, i, nTextLen, nLen, nStart, nFails = 0;
+	bool				bCaseSense;
+
+	srand(1);
+	for (r = 0; r < 200000; ++r)
+	{
+		nTextLen = rand() % 300;
+		nLen = 1 + rand() % 24;
+		for (i = 0; i < nTextLen; ++i)
+			szText[i] = szAlphabet[rand() % 8];
+		szText[nTextLen] = '\0';
+		for (i = 0; i < nLen; ++i)
+			szPattern[i] = szAlphabet[rand() % 8];
+		szPattern[nLen] = '\0';
+		bCaseSense = (rand() & 1) != 0;
+
+		StringSearch	oSearch(szPattern, bCaseSense);
+
+		nStart = rand() % 8;
+		if (oSearch.find(szText, nTextLen, nStart) != NaiveFind(szText, nTextLen, szPattern, bCaseSense, nStart))
+			++nFails;
+
+		nStart = nTextLen - rand() % 8;
+		if (oSearch.rfind(szText, nTextLen, nStart) != NaiveRFind(szText, nTextLen, szPattern, bCaseSense, nStart))
+			++nFails;
+	}
+
+	return nFails;
+}
+
+
+// Times 10 searches for the needle and one count of every fox
+static void Time(int nMethod, const char *szText, int nTextLen, bool bCaseSense, double &fNeedle, double &fFox, int &nFoxes)
+{
+	StringSearch	oNeedle("Needle", bCaseSense), oFox("fox", bCaseSense);
+	double			t0;
+	int				r, nPos = 0;
+
+	t0 = Bench_Now();
+	for (r = 0; r < 10; ++r)
+		nPos += nMethod == 0 ? OldFind(szText, nTextLen, "Needle", bCaseSense, 0) : oNeedle.find(szText, nTextLen, 0);
+	fNeedle = Bench_Now() - t0;
+
+	t0 = Bench_Now();
+	nFoxes = 0;
+	nPos = nMethod == 0 ? OldFind(szText, nTextLen, "fox", bCaseSense, 0) : oFox.find(szText, nTextLen, 0);
+	while (nPos >= 0)
+	{
+		++nFoxes;
+		nPos = nMethod == 0 ? OldFind(szText, nTextLen, "fox", bCaseSense, nPos + 3) : oFox.find(szText, nTextLen, nPos + 3);
+	}
+	fFox = Bench_Now() - t0;
+}
+
+
+int main(int argc, char *argv[])
+{
+	static const int	nDefaults[] = { 1, 10 };
+	static const char	*szWords[] = { "The ", "quick ", "brown ", "fox ", "jumps ", "over ", "the ", "lazy ", "dog.\r\n" };
+	int					nSizes[16], nNumSizes, s, m, cs, n, w, nFails = 0, nFoxes[3];
+	double				fNeedle[3], fFox[3];
+	bool				bSSE2;
+
+	bSSE2 = StringSearch::UseSSE2(true);
+
+	// Correctness, on both paths
+	nFails += Check();
+	StringSearch::UseSSE2(false);
+	nFails += Check();
+	printf("find/rfind against naive search: %s (SSE2 %s)\n\n", nFails ? "FAILED" : "ok", bSSE2 ? "available" : "not available");
+
+	nNumSizes = Bench_Sizes(argc, argv, nSizes, 16, nDefaults, 2);
+
+	printf("%5s %-7s   %-27s   %-27s\n", "", "", "10x needle at end", "count every fox");
+	printf("%5s %-7s   %-8s %-8s %-8s   %-8s %-8s %-8s\n", "MB", "case", "old", "horspool", "sse2", "old", "horspool", "sse2");
+
+	for (s = 0; s < nNumSizes; ++s)
+	{
+		int		nTextLen = nSizes[s] * 1024 * 1024;
+		char	*szText = new char[nTextLen + 16];
+
+		for (n = 0, w = 0; n < nTextLen; )
+		{
+			const char	*szWord = szWords[w++ % 9];
+			while (*szWord && n < nTextLen)
+				szText[n++] = *szWord++;
+		}
+		memcpy(szText + nTextLen - 8, "Needle\r\n", 8);
+		szText[nTextLen] = '\0';
+
+		for (cs = 1; cs >= 0; --cs)
+		{
+			for (m = 0; m < 3; ++m)
+			{
+				StringSearch::UseSSE2(m == 2);
+				if (m == 2 && !bSSE2)
+					fNeedle[m] = fFox[m] = -1;
+				else
+					Time(m, szText, nTextLen, cs != 0, fNeedle[m], fFox[m], nFoxes[m]);
+			}
+
+			if (nFoxes[0] != nFoxes[1] || (bSSE2 && nFoxes[0] != nFoxes[2]))
+				++nFails;
+
+			printf("%5d %-7s   ", nSizes[s], cs ? "sense" : "insense");
+			for (m = 0; m < 6; ++m)
+			{
+				double	f = m < 3 ? fNeedle[m] : fFox[m-3];
+				if (f < 0)
+					printf("%-8s ", "n/a");
+				else
+					printf("%-8.3f ", f);
+				if (m == 2)
+					printf("  ");
+			}
+			printf("\n");
+		}
+
+		delete [] szText;
+	}
+
+	StringSearch::UseSSE2(true);
+
+	return nFails ? 1 : 0;
+}
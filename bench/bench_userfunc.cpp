@@ -0,0 +1,248 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// bench_userfunc.cpp
+//
+// UserFuncList: storing N functions the way StoreUserFuncs() does (a
+// duplicate check with find() then add()) and then looking each one up 10
+// times.  OldFuncList is a copy of the linked list with a bubble sorted
+// index that UserFuncList used before it became a hash table.  Names are
+// stored in a scrambled order, as they are in a real script.  The old list
+// is skipped above 20000 functions.
+//
+// bench_userfunc [N ...]		(default 1000 10000 100000)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench.h"
+#include "astring_datatype.h"
+#include "userfunction_list.h"
+
+
+// The old UserFuncList (linear search until createindex() sorts an index)
+class OldFuncList
+{
+public:
+	OldFuncList() : m_lpFirst(NULL), m_lpLast(NULL), m_Index(NULL), m_nNumItems(0) {}
+	~OldFuncList()
+	{
+		while (m_lpFirst)
+		{
+			Node	*lpNext = m_lpFirst->lpNext;
+			delete m_lpFirst;
+			m_lpFirst = lpNext;
+		}
+		delete [] m_Index;
+	}
+
+	void add(const UserFuncDetails &uItem)
+	{
+		Node	*lpNew = new Node;
+		lpNew->uItem = uItem;
+		lpNew->uItem.sName.toupper();
+		lpNew->lpNext = NULL;
+
+		if (m_lpLast)
+			m_lpLast = m_lpLast->lpNext = lpNew;
+		else
+			m_lpFirst = m_lpLast = lpNew;
+		++m_nNumItems;
+	}
+
+	UserFuncDetails * find(AString sName)
+	{
+		sName.toupper();
+
+		if (m_Index == NULL)
+		{
+			for (Node *lpNode = m_lpFirst; lpNode; lpNode = lpNode->lpNext)
+			{
+				if (lpNode->uItem.sName == sName)
+					return &lpNode->uItem;
+			}
+			return NULL;
+		}
+
+		int	nFirst = 0, nLast = m_nNumItems - 1, nRes, i;
+		while (nFirst <= nLast)
+		{
+			i = (nFirst + nLast) / 2;
+			nRes = strcmp(sName.c_str(), m_Index[i]->sName.c_str());
+			if (nRes < 0)
+				nLast = i - 1;
+			else if (nRes > 0)
+				nFirst = i + 1;
+			else
+				return m_Index[i];
+		}
+		return NULL;
+	}
+
+	void createindex(void)
+	{
+		int				i;
+		bool			bSwapOccured = true;
+		Node			*lpNode = m_lpFirst;
+		UserFuncDetails	*lpTemp;
+
+		m_Index = new UserFuncDetails*[m_nNumItems];
+		for (i = 0; i < m_nNumItems; ++i, lpNode = lpNode->lpNext)
+			m_Index[i] = &lpNode->uItem;
+
+		while (bSwapOccured)
+		{
+			bSwapOccured = false;
+			for (i = 0; i < m_nNumItems-1; ++i)
+			{
+				if (m_Index[i]->sName > m_Index[i+1]->sName)
+				{
+					bSwapOccured = true;
+					lpTemp = m_Index[i];
+					m_Index[i] = m_Index[i+1];
+					m_Index[i+1] = lpTemp;
+				}
+			}
+		}
+	}
+
+private:
+	struct Node
+	{
+		UserFuncDetails	uItem;
+		Node			*lpNext;
+	};
+
+	Node			*m_lpFirst, *m_lpLast;
+	UserFuncDetails	**m_Index;
+	int				m_nNumItems;
+};
+
+
+// Adapts UserFuncList to the same interface (it needs no index)
+class NewFuncList
+{
+public:
+	void				add(const UserFuncDetails &uItem)	{ m_oList.add(uItem); }
+	UserFuncDetails *	find(const char *szName)			{ return m_oList.find(szName); }
+	void				createindex(void)					{ }
+private:
+	UserFuncList	m_oList;
+};
+
+
+// Times one run, returns the number of failures
+template <class T> static int Run(T &oList, char (*szNames)[24], int nNames, double &fStore, double &fFind)
+{
+	UserFuncDetails	uItem;
+	int				i, r, nFails = 0;
+	double			t0 = Bench_Now();
+
+	uItem.nNumParams = uItem.nNumParamsMin = uItem.nEndFuncLineNum = uItem.nNumSlots = 0;
+	uItem.pnSlotIDs = NULL;
+	uItem.lpParams = NULL;
+
+	for (i = 0; i < nNames; ++i)
+	{
+		if (oList.find(szNames[i]) != NULL)
+			++nFails;							// Reported as a duplicate
+		uItem.sName = szNames[i];
+		uItem.nFuncLineNum = i + 1;
+		oList.add(uItem);
+	}
+	oList.createindex();
+	fStore = Bench_Now() - t0;
+
+	t0 = Bench_Now();
+	for (r = 0; r < 10; ++r)
+	{
+		for (i = 0; i < nNames; ++i)
+		{
+			UserFuncDetails	*lpFunc = oList.find(szNames[i]);
+			if (lpFunc == NULL || lpFunc->nFuncLineNum != i + 1)
+				++nFails;
+		}
+	}
+	fFind = Bench_Now() - t0;
+
+	return nFails;
+}
+
+
+int main(int argc, char *argv[])
+{
+	static const int	nDefaults[] = { 1000, 10000, 100000 };
+	int					nSizes[16], nNumSizes, s, i, nFails = 0;
+	double				fStore, fFind;
+
+	nNumSizes = Bench_Sizes(argc, argv, nSizes, 16, nDefaults, 3);
+
+	printf("%8s   %-10s %-10s   %-10s %-10s\n", "N", "old store", "old 10xN", "new store", "new 10xN");
+
+	for (s = 0; s < nNumSizes; ++s)
+	{
+		int		nNames = nSizes[s];
+		char	(*szNames)[24] = new char[nNames][24];
+
+		// 7919 is prime so i*7919 % N visits every i
+		for (i = 0; i < nNames; ++i)
+			sprintf(szNames[i], "_Func%07d", (int)(((__int64)i * 7919) % nNames));
+
+		printf("%8d   ", nNames);
+
+		if (nNames > 20000)
+			printf("%-10s %-10s   ", "skipped", "");
+		else
+		{
+			OldFuncList	oOld;
+			nFails += Run(oOld, szNames, nNames, fStore, fFind);
+			printf("%-10.3f %-10.3f   ", fStore, fFind);
+		}
+
+		{
+			NewFuncList	oNew;
+			nFails += Run(oNew, szNames, nNames, fStore, fFind);
+			printf("%-10.3f %-10.3f\n", fStore, fFind);
+		}
+
+		delete [] szNames;
+	}
+
+	if (nFails)
+		printf("FAILED: %d lookups gave the wrong result\n", nFails);
+
+	return nFails ? 1 : 0;
+}
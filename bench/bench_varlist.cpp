@@ -0,0 +1,233 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// bench_varlist.cpp
+//
+// VariableList: adding N globals and looking each of them up 10 times, with
+// the names declared in sorted order (as generated includes do) and in a
+// scrambled order.  OldVarTree is a copy of the unbalanced binary tree that
+// VariableList used before it became a hash table, so both are timed in the
+// same run.  The old tree is skipped for sorted names above 30000 as it
+// degrades to a linked list.
+//
+// bench_varlist [N ...]		(default 1000 10000 100000)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench.h"
+#include "variable_list.h"
+
+
+// The old VariableList (unbalanced tree keyed on strcmp())
+class OldVarTree
+{
+public:
+	OldVarTree() : m_lpRoot(NULL) {}
+	~OldVarTree() { freenode(m_lpRoot); }
+
+	void addvar(const char *szName, const Variant &vVar)
+	{
+		Variant	*pvVar = findvar(szName);
+		if (pvVar)
+		{
+			*pvVar = vVar;
+			return;
+		}
+
+		Node	*lpNew = new Node;
+		lpNew->szName = new char[strlen(szName)+1];
+		strcpy(lpNew->szName, szName);
+		lpNew->pvVariant = new Variant;
+		*lpNew->pvVariant = vVar;
+		lpNew->lpLeft = lpNew->lpRight = NULL;
+
+		if (m_lpRoot == NULL)
+		{
+			m_lpRoot = lpNew;
+			return;
+		}
+
+		for (Node *lpCur = m_lpRoot; ; )
+		{
+			Node	**lplpNext = strcmp(lpCur->szName, szName) < 0 ? &lpCur->lpLeft : &lpCur->lpRight;
+			if (*lplpNext == NULL)
+			{
+				*lplpNext = lpNew;
+				break;
+			}
+			lpCur = *lplpNext;
+		}
+	}
+
+	Variant * findvar(const char *szName)
+	{
+		Node	*lpCur = m_lpRoot;
+		int		nRes;
+
+		while (lpCur)
+		{
+			nRes = strcmp(lpCur->szName, szName);
+			if (nRes == 0)
+				return lpCur->pvVariant;
+			lpCur = nRes < 0 ? lpCur->lpLeft : lpCur->lpRight;
+		}
+		return NULL;
+	}
+
+private:
+	struct Node
+	{
+		char	*szName;
+		Variant	*pvVariant;
+		Node	*lpLeft, *lpRight;
+	};
+
+	// Rotates left children up so that a degenerate tree can't overflow the stack
+	void freenode(Node *lpNode)
+	{
+		while (lpNode)
+		{
+			if (lpNode->lpLeft)
+			{
+				Node	*lpLeft = lpNode->lpLeft;
+				lpNode->lpLeft = lpLeft->lpRight;
+				lpLeft->lpRight = lpNode;
+				lpNode = lpLeft;
+			}
+			else
+			{
+				Node	*lpNext = lpNode->lpRight;
+				delete [] lpNode->szName;
+				delete lpNode->pvVariant;
+				delete lpNode;
+				lpNode = lpNext;
+			}
+		}
+	}
+
+	Node	*m_lpRoot;
+};
+
+
+// Times one run, returns the number of failed lookups
+template <class T> static int Run(T &oList, char (*szNames)[16], int nNames, double &fAdd, double &fFind)
+{
+	Variant	vValue;
+	int		i, r, nFails = 0;
+	double	t0 = Bench_Now();
+
+	for (i = 0; i < nNames; ++i)
+	{
+		vValue = i;
+		oList.addvar(szNames[i], vValue);
+	}
+	fAdd = Bench_Now() - t0;
+
+	t0 = Bench_Now();
+	for (r = 0; r < 10; ++r)
+	{
+		for (i = 0; i < nNames; ++i)
+		{
+			Variant	*pvVar = oList.findvar(szNames[i]);
+			if (pvVar == NULL || pvVar->nValue() != i)
+				++nFails;
+		}
+	}
+	fFind = Bench_Now() - t0;
+
+	return nFails;
+}
+
+
+// Adapts VariableList to the same interface
+class NewVarList
+{
+public:
+	void		addvar(const char *szName, const Variant &vVar)	{ m_oList.addvar(szName, vVar, false); }
+	Variant *	findvar(const char *szName)						{ bool bConst; return m_oList.findvar(szName, bConst); }
+private:
+	VariableList	m_oList;
+};
+
+
+int main(int argc, char *argv[])
+{
+	static const int	nDefaults[] = { 1000, 10000, 100000 };
+	int					nSizes[16], nNumSizes, s, i, o, nFails = 0;
+	double				fAdd, fFind;
+
+	nNumSizes = Bench_Sizes(argc, argv, nSizes, 16, nDefaults, 3);
+
+	printf("%-10s %8s   %-10s %-10s   %-10s %-10s\n", "order", "N", "old add", "old 10xN", "new add", "new 10xN");
+
+	for (s = 0; s < nNumSizes; ++s)
+	{
+		int		nNames = nSizes[s];
+		char	(*szNames)[16] = new char[nNames][16];
+
+		for (o = 0; o < 2; ++o)
+		{
+			// Sorted, or scrambled (7919 is prime so i*7919 % N visits every i)
+			for (i = 0; i < nNames; ++i)
+				sprintf(szNames[i], "V%07d", o == 0 ? i : (int)(((__int64)i * 7919) % nNames));
+
+			printf("%-10s %8d   ", o == 0 ? "sorted" : "scrambled", nNames);
+
+			if (o == 0 && nNames > 30000)
+				printf("%-10s %-10s   ", "skipped", "");
+			else
+			{
+				OldVarTree	oOld;
+				nFails += Run(oOld, szNames, nNames, fAdd, fFind);
+				printf("%-10.3f %-10.3f   ", fAdd, fFind);
+			}
+
+			{
+				NewVarList	oNew;
+				nFails += Run(oNew, szNames, nNames, fAdd, fFind);
+				printf("%-10.3f %-10.3f\n", fAdd, fFind);
+			}
+		}
+
+		delete [] szNames;
+	}
+
+	if (nFails)
+		printf("FAILED: %d lookups returned the wrong variable\n", nFails);
+
+	return nFails ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// bench_vectors.cpp
+//
+// VectorToken and VectorVariant.  For each simulated script line T int
+// tokens are pushed and then walked with operator[] by position, as the
+// parser does with ivPos, and a 3 argument VectorVariant is built for a
+// function call.  OldVector is a copy of the linked lists they replaced,
+// where operator[] walked from the first node.
+//
+// bench_vectors [lines tokens ...]	(default 1000000 8  1000000 20  10000 1000)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench.h"
+#include "variant_datatype.h"
+#include "token_datatype.h"
+#include "vector_token_datatype.h"
+#include "vector_variant_datatype.h"
+
+
+// The old linked list vectors
+template <class T> class OldVector
+{
+public:
+	OldVector() : m_lpFirst(NULL), m_lpLast(NULL), m_nItems(0) {}
+	~OldVector()
+	{
+		while (m_lpFirst)
+		{
+			Node	*lpNext = m_lpFirst->lpNext;
+			delete m_lpFirst;
+			m_lpFirst = lpNext;
+		}
+	}
+
+	void push_back(const T &Item)
+	{
+		Node	*lpNew = new Node;
+		lpNew->Item = Item;
+		lpNew->lpNext = NULL;
+		if (m_lpLast)
+			m_lpLast = m_lpLast->lpNext = lpNew;
+		else
+			m_lpFirst = m_lpLast = lpNew;
+		++m_nItems;
+	}
+
+	T & operator[](unsigned int nIndex)
+	{
+		Node	*lpNode = m_lpFirst;
+		while (nIndex--)
+			lpNode = lpNode->lpNext;
+		return lpNode->Item;
+	}
+
+	unsigned int size(void) const { return m_nItems; }
+
+private:
+	struct Node
+	{
+		T		Item;
+		Node	*lpNext;
+	};
+
+	Node			*m_lpFirst, *m_lpLast;
+	unsigned int	m_nItems;
+};
+
+
+template <class TT, class TV> static __int64 Run(int nLines, int nToks)
+{
+	__int64	nSum = 0;
+	int		l, i;
+
+	for (l = 0; l < nLines; ++l)
+	{
+		TT		vLineToks;
+		Token	tok;
+
+		tok.settype(TOK_INT32);
+		for (i = 0; i < nToks; ++i)
+		{
+			tok.nValue = i;
+			vLineToks.push_back(tok);
+		}
+
+		for (unsigned int ivPos = 0; ivPos < vLineToks.size(); ++ivPos)
+			nSum += vLineToks[ivPos].nValue;
+
+		TV		vParams;
+		Variant	vTemp;
+
+		vTemp = l;
+		for (i = 0; i < 3; ++i)
+			vParams.push_back(vTemp);
+		nSum += vParams[2].nValue();
+	}
+
+	return nSum;
+}
+
+
+int main(int argc, char *argv[])
+{
+	static const int	nDefaults[] = { 1000000, 8, 1000000, 20, 10000, 1000 };
+	int					nSizes[16], nNumSizes, s, nFails = 0;
+	__int64				nOldSum, nNewSum;
+	double				t0, fOld, fNew;
+	long				nOldAllocs, nNewAllocs;
+
+	nNumSizes = Bench_Sizes(argc, argv, nSizes, 16, nDefaults, 6);
+
+	printf("%10s %8s   %-10s %-14s   %-10s %-14s\n", "lines", "tokens", "old", "old allocs/ln", "new", "new allocs/ln");
+
+	for (s = 0; s+1 < nNumSizes; s += 2)
+	{
+		nOldAllocs = g_nBenchAllocs;
+		t0 = Bench_Now();
+		nOldSum = Run< OldVector<Token>, OldVector<Variant> >(nSizes[s], nSizes[s+1]);
+		fOld = Bench_Now() - t0;
+		nOldAllocs = g_nBenchAllocs - nOldAllocs;
+
+		nNewAllocs = g_nBenchAllocs;
+		t0 = Bench_Now();
+		nNewSum = Run<VectorToken, VectorVariant>(nSizes[s], nSizes[s+1]);
+		fNew = Bench_Now() - t0;
+		nNewAllocs = g_nBenchAllocs - nNewAllocs;
+
+		if (nOldSum != nNewSum)
+			++nFails;
+
+		printf("%10d %8d   %-10.3f %-14.2f   %-10.3f %-14.2f\n", nSizes[s], nSizes[s+1],
+			fOld, (double)nOldAllocs / nSizes[s], fNew, (double)nNewAllocs / nSizes[s]);
+	}
+
+	if (nFails)
+		printf("FAILED: old and new vectors gave different results\n");
+
+	return nFails ? 1 : 0;
+}
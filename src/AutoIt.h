@@ -48,7 +48,6 @@
 
 // Configuration options
 //#define AUT_CONFIG_GUI							// Enable GUI functionality
-#define AUT_CONFIG_LEXERCACHE					// Enable lexer caching
 //#define AUT_CONFIG_DEBUG						// Enable debug functionality
 
 
@@ -77,8 +76,11 @@ typedef unsigned long 		ulong;
 #define AUT_IDLE				10				// Number of ms to wait when idling
 #define AUT_ADLIB_DELAY			250				// Default delay in ms between ADLIB triggers
 #define AUT_HOTKEYQUEUESIZE		64				// Number of queued hotkeys to buffer
-#define AUT_MAXEXECUTERECURSE	384				// Maximum number of times the Execute() function can recurse to itself
-#define AUT_BATCHLINES			1
+#define AUT_STACKHEADROOM		(256*1024)		// Stack that must be left before Execute() recurses again (16MB is reserved at link time)
+#define AUT_BATCHLINES			100				// Default max lines run between message/hotkey/adlib checks
+#define AUT_BATCHTIME			10				// Max ms run between message/hotkey/adlib checks
+#define AUT_CONSOLEFLUSHTIME	100				// Max ms that buffered ConsoleWrite() output is held back
+#define AUT_CONSOLEBUFMAX		(16*1024*1024)	// Largest ConsoleWrite() buffer allowed by Opt("ConsoleBuffer")
 
 
 // AutoIt function result macros (for simple checking for success/failure)
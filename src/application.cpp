@@ -90,8 +90,10 @@ AutoIt_App::AutoIt_App()
 	g_bBreakEnabled			= true;
 	g_bTrayIconDebug		= false;
 	g_bStdOut				= false;
+	g_bInterpretOnly		= false;
 	g_bTrayExitClicked		= false;
 	g_bKillWorkerThreads	= false;
+	g_bScriptEvent			= false;
 
 	g_HotKeyNext		= 0;					// Initial position in hot key buffer
 
@@ -332,9 +334,17 @@ void AutoIt_App::ParseCmdLine(void)
 
 		return;
 	}
-	else if (stricmp("/ErrorStdOut", szTemp) == 0)
+
+	// Strip our own switches from the command line
+	//  /ErrorStdOut	- errors are written to stdout
+	//  /Interpret		- expressions are always interpreted, not compiled (see script_parser_exp.cpp)
+	while (stricmp("/ErrorStdOut", szTemp) == 0 || stricmp("/Interpret", szTemp) == 0)
 	{
-		g_bStdOut = true;
+		if (stricmp("/ErrorStdOut", szTemp) == 0)
+			g_bStdOut = true;
+		else
+			g_bInterpretOnly = true;
+
 		if (nNumParams == 1)
 		{
 			pvTemp->ArraySubscriptClear();		// Reset the subscript
@@ -347,7 +357,7 @@ void AutoIt_App::ParseCmdLine(void)
 			*pvElement = 0;						// $CmdLines[0] = 0
 			return;
 		}
-		--nNumParams;							// Decrement because we strip the /ErrorStdOut from the command line
+		--nNumParams;							// Decrement because we strip the switch from the command line
 		g_oCmdLine.GetNextParam(szTemp);		// skip to the next item
 	}
 
@@ -460,9 +470,17 @@ void AutoIt_App::ParseCmdLine(void)
 
 		return;
 	}
-	else if (stricmp("/ErrorStdOut", szTemp) == 0)
+
+	// Strip our own switches from the command line
+	//  /ErrorStdOut	- errors are written to stdout
+	//  /Interpret		- expressions are always interpreted, not compiled (see script_parser_exp.cpp)
+	while (stricmp("/ErrorStdOut", szTemp) == 0 || stricmp("/Interpret", szTemp) == 0)
 	{
-		g_bStdOut = true;
+		if (stricmp("/ErrorStdOut", szTemp) == 0)
+			g_bStdOut = true;
+		else
+			g_bInterpretOnly = true;
+
 		if (nNumParams == 1)
 		{
 			pvTemp->ArraySubscriptClear();		// Reset the subscript
@@ -475,7 +493,7 @@ void AutoIt_App::ParseCmdLine(void)
 			*pvElement = 0;						// $CmdLines[0] = 0
 			return;
 		}
-		--nNumParams;							// Decrement because we strip the /ErrorStdOut from the command line
+		--nNumParams;							// Decrement because we strip the switch from the command line
 		g_oCmdLine.GetNextParam(szTemp);		// skip to the next item
 	}
 
@@ -588,6 +606,7 @@ LRESULT AutoIt_App::WndProcHandler (HWND hWnd, UINT iMsg, WPARAM wParam, LPARAM
 				// Notify the script that close was requested but DON'T allow the system to continue
 				// with the defaut WM_CLOSE - we will call DestroyWindow() ourselves from the script
 				g_bTrayExitClicked = true;
+				g_bScriptEvent = true;
 				g_bKillWorkerThreads = true;			// Ask worker threads to stop (otherwise the script
 														// may be blocked - e.g InetGet on a big download)
 				//break;
@@ -623,6 +642,7 @@ LRESULT AutoIt_App::WndProcHandler (HWND hWnd, UINT iMsg, WPARAM wParam, LPARAM
 					 g_HotKeyQueue[g_HotKeyNext++] = wParam;     // Store the hotkey ID pressed
 					 if (g_HotKeyNext >= AUT_HOTKEYQUEUESIZE)
 						  g_HotKeyNext = 0;
+					 g_bScriptEvent = true;
 				}
 
 				//MessageBox(NULL, "", "Hotkey pressed", MB_OK);
@@ -727,6 +747,7 @@ bool AutoIt_App::HandleCommand (HWND hWnd, UINT iMsg, WPARAM wParam, LPARAM lPar
 		// be clickable if break was disabled
 		case ID_EXIT:
 			g_bTrayExitClicked = true;
+			g_bScriptEvent = true;
 			//PostMessage(hWnd, WM_CLOSE, 0, 0);	// Will eventually call destroy on the GUI as it is a child window
 			return true;
 
@@ -906,6 +927,7 @@ void AutoIt_App::NotifyIcon (HWND hWnd, UINT iMsg, WPARAM wParam, LPARAM lParam)
 
 			// The act of clicking on the tray icon puts us in the paused state no matter what
 			g_bScriptPaused = true;
+			g_bScriptEvent = true;
 
 			hMenu = LoadMenu(g_hInstance, MAKEINTRESOURCE(IDR_TRAY1));
 			// check and gray out menu items as neccessary
@@ -53,6 +53,7 @@
 #endif
 
 #include "astring_datatype.h"
+#include "string_search.h"
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -665,79 +666,50 @@ int AString::find_last_of(const char *szInput) const
 ///////////////////////////////////////////////////////////////////////////////
 // find_str()
 // Returns first element to match the input string (or returns index of \0 = size() )
+// A negative nOccurance searches from the end and returns -1 when not found.
+// Occurances may overlap.
 ///////////////////////////////////////////////////////////////////////////////
 
 int AString::find_str(const char *szInput, bool bCaseSense, int nOccurance) const
 {
 	int		i, nMatches;
-	int		nInputLen	= (int)strlen(szInput);
+
+	if (nOccurance == 0)
+		return m_length;
+
+	// An empty string matches at every position
+	if (szInput[0] == '\0')
+	{
+		if (nOccurance > 0)
+			return (nOccurance-1 < m_length) ? nOccurance-1 : m_length;
+		else
+			return (m_length+nOccurance+1 >= 0) ? m_length+nOccurance+1 : -1;
+	}
+
+	StringSearch	oSearch(szInput, bCaseSense);
 
 	if (nOccurance > 0)
 	{
-		i = 0;
-		nMatches = 0;
-		while (nMatches < nOccurance)
+		i = -1;
+		for (nMatches = 0; nMatches < nOccurance; ++nMatches)
 		{
-			for(; i<m_length; ++i)
-			{
-				if (bCaseSense)
-				{
-					if (strncmp(m_szText+i, szInput, nInputLen) == 0) // if the characters starting at m_szText[i] matches szInput
-					{
-						++nMatches;
-						break;
-					}
-				}
-				else
-				{
-					if (strnicmp(m_szText+i, szInput, nInputLen) == 0) // if the characters starting at m_szText[i] matches szInput
-					{
-						++nMatches;
-						break;
-					}
-				}
-			}
-			if (i >= m_length) // not found
-				break;
-			else if (nMatches < nOccurance)
-				++i;	// skipped increment
+			i = oSearch.find(m_szText, m_length, i+1);
+			if (i < 0)
+				return m_length;				// not found
 		}
 	}
-	else if (nOccurance < 0)
+	else
 	{
-		i = m_length - nInputLen;
-		nMatches = 0;
-		while (nMatches < -nOccurance)
+		i = m_length;
+		for (nMatches = 0; nMatches < -nOccurance; ++nMatches)
 		{
-			for(; i>=0; --i)
-			{
-				if (bCaseSense)
-				{
-					if (strncmp(m_szText+i, szInput, nInputLen) == 0) // if the characters starting at m_szText[i] matches szInput
-					{
-						++nMatches;
-						break;
-					}
-				}
-				else
-				{
-					if (strnicmp(m_szText+i, szInput, nInputLen) == 0) // if the characters starting at m_szText[i] matches szInput
-					{
-						++nMatches;
-						break;
-					}
-				}
-			}
-			if (i < 0) // not found
-				break;
-			else if (nMatches < -nOccurance)
-				--i;	// skipped decrement
+			i = oSearch.rfind(m_szText, m_length, i-1);
+			if (i < 0)
+				return -1;						// not found
 		}
 	}
-	else
-		return m_length;
 
-	return i;									// i = index of \0
+	return i;
 
 } // find_str()
 
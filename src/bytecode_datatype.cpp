@@ -0,0 +1,147 @@
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// bytecode_datatype.cpp
+//
+// The class for a compiled expression.  Not using STL because of the
+// code bloat.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+// Includes
+#include "StdAfx.h"								// Pre-compiled headers
+
+#ifndef _MSC_VER								// Includes for non-MS compilers
+	#include <stdio.h>
+#endif
+
+#include "bytecode_datatype.h"
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor()
+///////////////////////////////////////////////////////////////////////////////
+
+ByteCode::ByteCode() : m_lpInstrs(NULL), m_nInstrs(0), m_lpConsts(NULL), m_nConsts(0),
+	m_ivStart(0), m_ivEnd(0), m_bCallParam(false), m_bValid(false), m_lpNext(NULL), m_nInstrsAlloc(0), m_nConstsAlloc(0)
+{
+
+} // ByteCode()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor()
+///////////////////////////////////////////////////////////////////////////////
+
+ByteCode::~ByteCode()
+{
+	delete [] m_lpInstrs;
+	delete [] m_lpConsts;
+
+} // ~ByteCode()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// emit()
+// Adds an instruction to the end of the list and returns its index
+///////////////////////////////////////////////////////////////////////////////
+
+int ByteCode::emit(int nOp, int nArg)
+{
+	// Need more space?  Double the allocation each time
+	if (m_nInstrs == m_nInstrsAlloc)
+	{
+		int				nNewAlloc = m_nInstrsAlloc ? m_nInstrsAlloc * 2 : 16;
+		ByteCodeInstr	*lpTemp = new ByteCodeInstr[nNewAlloc];
+
+		for (int i = 0; i < m_nInstrs; ++i)
+			lpTemp[i] = m_lpInstrs[i];
+
+		delete [] m_lpInstrs;
+		m_lpInstrs		= lpTemp;
+		m_nInstrsAlloc	= nNewAlloc;
+	}
+
+	m_lpInstrs[m_nInstrs].nOp	= nOp;
+	m_lpInstrs[m_nInstrs].nArg	= nArg;
+
+	return m_nInstrs++;
+
+} // emit()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// patch()
+// Changes the argument of an existing instruction (used for forward jumps)
+///////////////////////////////////////////////////////////////////////////////
+
+void ByteCode::patch(int nInstr, int nArg)
+{
+	if (nInstr >= 0 && nInstr < m_nInstrs)
+		m_lpInstrs[nInstr].nArg = nArg;
+
+} // patch()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// addconst()
+// Adds a value to the constant pool and returns its index
+///////////////////////////////////////////////////////////////////////////////
+
+int ByteCode::addconst(const Variant &vItem)
+{
+	// Need more space?  Double the allocation each time
+	if (m_nConsts == m_nConstsAlloc)
+	{
+		int		nNewAlloc = m_nConstsAlloc ? m_nConstsAlloc * 2 : 8;
+		Variant	*lpTemp = new Variant[nNewAlloc];
+
+		for (int i = 0; i < m_nConsts; ++i)
+			lpTemp[i] = m_lpConsts[i];
+
+		delete [] m_lpConsts;
+		m_lpConsts		= lpTemp;
+		m_nConstsAlloc	= nNewAlloc;
+	}
+
+	m_lpConsts[m_nConsts] = vItem;
+
+	return m_nConsts++;
+
+} // addconst()
@@ -0,0 +1,117 @@
+#ifndef __BYTECODE_H
+#define __BYTECODE_H
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// bytecode_datatype.h
+//
+// The class for a compiled expression (see Parser_CompileExpression() in
+// script_parser_exp.cpp).  An expression is stored as a flat list of postfix
+// instructions plus a pool of the literal values it uses.  Not using STL
+// because of the code bloat.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+// Includes
+#include "variant_datatype.h"
+
+
+// Bytecode instructions
+enum
+{
+	BC_PUSHCONST,								// Push constant nArg
+	BC_PUSHSTRING,								// Push string constant nArg (expanded if Opt() says so)
+	BC_VARIABLE,								// Evaluate the variable at token nArg
+	BC_FUNCTION,								// Call the built-in function at token nArg
+	BC_USERFUNCTION,							// Call the user function at token nArg
+	BC_MACRO,									// Evaluate the macro at token nArg
+	BC_OPERATOR,								// Apply operator nArg (OPR_ADD, etc) to the value stack
+	BC_JUMPAND,									// If top value is false make it 0 and jump to instruction nArg
+	BC_JUMPOR									// If top value is true make it 1 and jump to instruction nArg
+};
+
+
+// Struct for a single instruction
+typedef struct
+{
+	int			nOp;							// Instruction (BC_*)
+	int			nArg;							// Argument (constant, token position, operator or jump)
+
+} ByteCodeInstr;
+
+
+class ByteCode
+{
+public:
+	// Functions
+	ByteCode();									// Constructor
+	~ByteCode();								// Destructor
+
+	int				emit(int nOp, int nArg);	// Add an instruction, returns its index
+	void			patch(int nInstr, int nArg);// Change the argument of an instruction
+	void			pop(void)					// Remove the last instruction
+						{ if (m_nInstrs) --m_nInstrs; }
+	int				addconst(const Variant &vItem);	// Add a constant, returns its index
+	void			popconst(void)				// Remove the last constant
+						{ if (m_nConsts) m_lpConsts[--m_nConsts] = 0; }
+
+	// Properties
+	int				size(void) const { return m_nInstrs; }	// Number of instructions
+
+	// Variables
+	ByteCodeInstr	*m_lpInstrs;				// Instructions
+	int				m_nInstrs;					// Number of instructions
+	Variant			*m_lpConsts;				// Constant pool
+	int				m_nConsts;					// Number of constants
+
+	unsigned int	m_ivStart;					// Token the expression starts at
+	unsigned int	m_ivEnd;					// Token the expression finishes at
+	bool			m_bCallParam;				// Compiled as a function call parameter (ends at an unmatched ) )
+	bool			m_bValid;					// False if the expression must be interpreted instead
+	ByteCode		*m_lpNext;					// Next compiled expression for the same line (or NULL)
+
+private:
+	// Variables
+	int				m_nInstrsAlloc;				// Allocated size of m_lpInstrs
+	int				m_nConstsAlloc;				// Allocated size of m_lpConsts
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
@@ -103,8 +103,10 @@ bool					g_bTrayIcon;			// True when tray icon is displayed
 bool					g_bTrayIconInitial;		// Initial state of tray icon
 bool					g_bTrayIconDebug;		// True when TrayIcon debugng is allowed
 bool					g_bStdOut;				// True when /ErrorStdOut used on the command line
+bool					g_bInterpretOnly;		// True when /Interpret used on the command line
 bool					g_bTrayExitClicked;		// True when the user clicks "exit"
 bool					g_bKillWorkerThreads;	// True when requesting all thread finish up (script is about to die)
+bool					g_bScriptEvent;			// True when the main window has queued something for the script (hotkey, pause, exit)
 
 WPARAM					g_HotKeyQueue[AUT_HOTKEYQUEUESIZE];	// Queue for hotkeys pressed
 int						g_HotKeyNext;			// Next free hotkey position in queue
@@ -99,8 +99,10 @@ extern bool						g_bTrayIcon;			// True when tray icon is displayed
 extern bool						g_bTrayIconInitial;		// Initial state of tray icon
 extern bool						g_bTrayIconDebug;		// True when TrayIcon debugng is allowed
 extern bool						g_bStdOut;				// True when /ErrorStdOut used on the command line
+extern bool						g_bInterpretOnly;		// True when /Interpret used on the command line
 extern bool						g_bTrayExitClicked;		// True when the user clicks "exit"
 extern bool						g_bKillWorkerThreads;	// True when requesting all thread finish up (script is about to die)
+extern bool						g_bScriptEvent;			// True when the main window has queued something for the script (hotkey, pause, exit)
 
 extern WPARAM					g_HotKeyQueue[AUT_HOTKEYQUEUESIZE];	// Queue for hotkeys pressed
 extern int						g_HotKeyNext;		// Next free hotkey position in queue
@@ -0,0 +1,343 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// line_reader.cpp
+//
+// A buffered line reader for files opened with FileOpen().
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+// Includes
+#include "StdAfx.h"								// Pre-compiled headers
+
+#ifndef _MSC_VER								// Includes for non-MS compilers
+	#include <stdio.h>
+	#include <string.h>
+#endif
+
+#include "line_reader.h"
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor()
+///////////////////////////////////////////////////////////////////////////////
+
+LineReader::LineReader(FILE *fptr) : m_fptr(fptr), m_nBufLen(0), m_nBufPos(0),
+	m_szLine(NULL), m_nLineAlloc(0), m_nCurLine(0)
+{
+	m_szBuf			= new char[LINEREADER_BUFSIZE];
+	m_nBufOffset	= ftell(fptr);
+
+	// The first line starts where we are now
+	m_nLinesAlloc	= 64;
+	m_lpLines		= new long[m_nLinesAlloc];
+	m_lpLines[0]	= m_nBufOffset;
+	m_nLines		= 1;
+
+} // LineReader()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor()
+///////////////////////////////////////////////////////////////////////////////
+
+LineReader::~LineReader()
+{
+	delete [] m_szBuf;
+	delete [] m_szLine;
+	delete [] m_lpLines;
+
+} // ~LineReader()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// fill()
+//
+// Reads the next block of the file into the buffer.  The file position is
+// always just past the end of the buffer.  Returns false at EOF.
+///////////////////////////////////////////////////////////////////////////////
+
+bool LineReader::fill(void)
+{
+	m_nBufOffset	+= (long)m_nBufLen;
+	m_nBufLen		= (unsigned int)fread(m_szBuf, 1, LINEREADER_BUFSIZE, m_fptr);
+	m_nBufPos		= 0;
+
+	return m_nBufLen != 0;
+
+} // fill()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// seek()
+//
+// Moves to a file offset, only going to the file if it is outside the buffer.
+///////////////////////////////////////////////////////////////////////////////
+
+void LineReader::seek(long nOffset)
+{
+	if (nOffset >= m_nBufOffset && nOffset <= m_nBufOffset + (long)m_nBufLen)
+	{
+		m_nBufPos = (unsigned int)(nOffset - m_nBufOffset);
+		return;
+	}
+
+	fseek(m_fptr, nOffset, SEEK_SET);
+	m_nBufOffset	= nOffset;
+	m_nBufLen		= 0;
+	m_nBufPos		= 0;
+
+} // seek()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// append()
+//
+// Adds text to the line being built at nPos, growing the line as needed.
+///////////////////////////////////////////////////////////////////////////////
+
+void LineReader::append(const char *szText, unsigned int nLen, unsigned int &nPos)
+{
+	if (nPos + nLen + 1 > m_nLineAlloc)
+	{
+		unsigned int	nNewAlloc = m_nLineAlloc ? m_nLineAlloc : 256;
+		char			*szNew;
+
+		while (nNewAlloc < nPos + nLen + 1)
+			nNewAlloc *= 2;
+
+		szNew = new char[nNewAlloc];
+		if (nPos)
+			memcpy(szNew, m_szLine, nPos);
+
+		delete [] m_szLine;
+		m_szLine		= szNew;
+		m_nLineAlloc	= nNewAlloc;
+	}
+
+	memcpy(m_szLine + nPos, szText, nLen);
+	nPos += nLen;
+
+} // append()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// scanline()
+//
+// Reads the line at the current position and moves past its terminator.
+// Returns NULL at EOF.
+///////////////////////////////////////////////////////////////////////////////
+
+const char * LineReader::scanline(void)
+{
+	unsigned int	nPos = 0;
+	const char		*szStart, *szEnd, *szCh;
+
+	// Nothing left?
+	if (m_nBufPos == m_nBufLen && fill() == false)
+		return NULL;
+
+	for (;;)
+	{
+		// Find the end of the line in the buffer
+		szStart	= m_szBuf + m_nBufPos;
+		szEnd	= m_szBuf + m_nBufLen;
+
+		for (szCh = szStart; szCh < szEnd; ++szCh)
+		{
+			if (*szCh == '\r' || *szCh == '\n')
+				break;
+		}
+
+		append(szStart, (unsigned int)(szCh - szStart), nPos);
+		m_nBufPos = (unsigned int)(szCh - m_szBuf);
+
+		if (szCh < szEnd)
+		{
+			// Skip the terminator (a CR may be followed by a LF, possibly in the next block)
+			++m_nBufPos;
+			if (*szCh == '\r')
+			{
+				if (m_nBufPos == m_nBufLen)
+					fill();
+				if (m_nBufPos < m_nBufLen && m_szBuf[m_nBufPos] == '\n')
+					++m_nBufPos;
+			}
+			break;
+		}
+
+		// Line continues into the next block (or ends at EOF)
+		if (fill() == false)
+			break;
+	}
+
+	// Empty lines don't go through append() so make sure there is a buffer
+	if (m_szLine == NULL)
+		append("", 0, nPos);
+
+	m_szLine[nPos] = '\0';
+	return m_szLine;
+
+} // scanline()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// readline()
+//
+// Reads the next line.  If we know which line this is and it is the furthest
+// we have been then the start of the following line is added to the index.
+///////////////////////////////////////////////////////////////////////////////
+
+const char * LineReader::readline(void)
+{
+	const char	*szLine = scanline();
+
+	if (szLine == NULL || m_nCurLine < 0)
+		return szLine;
+
+	if ((unsigned int)m_nCurLine + 1 == m_nLines)
+	{
+		if (m_nLines == m_nLinesAlloc)
+		{
+			long	*lpNew = new long[m_nLinesAlloc * 2];
+
+			memcpy(lpNew, m_lpLines, m_nLines * sizeof(long));
+			delete [] m_lpLines;
+			m_lpLines		= lpNew;
+			m_nLinesAlloc	*= 2;
+		}
+
+		m_lpLines[m_nLines++] = tell();
+	}
+
+	++m_nCurLine;
+
+	return szLine;
+
+} // readline()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// readline()
+//
+// Reads line nLine (1 based).  A line we have already passed is a seek, a
+// later one is found by reading on from the last line in the index.
+// Afterwards the next line read will be the one following nLine.
+///////////////////////////////////////////////////////////////////////////////
+
+const char * LineReader::readline(int nLine)
+{
+	unsigned int	nIndex;
+
+	if (nLine < 1)
+		return NULL;
+
+	nIndex = (unsigned int)nLine - 1;
+
+	if (nIndex < m_nLines)
+	{
+		seek(m_lpLines[nIndex]);
+		m_nCurLine = (int)nIndex;
+	}
+	else
+	{
+		seek(m_lpLines[m_nLines-1]);
+		m_nCurLine = (int)m_nLines - 1;
+
+		while ((unsigned int)m_nCurLine < nIndex)
+		{
+			if (readline() == NULL)
+				return NULL;
+		}
+	}
+
+	return readline();
+
+} // readline()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// read()
+//
+// Reads up to nLen raw chars (used by FileRead()).  Afterwards we no longer
+// know which line we are on until a line is read by number again.
+///////////////////////////////////////////////////////////////////////////////
+
+size_t LineReader::read(char *szBuffer, size_t nLen)
+{
+	size_t	nCopied = m_nBufLen - m_nBufPos;
+
+	m_nCurLine = -1;
+
+	// Use what is left in the buffer first
+	if (nCopied > nLen)
+		nCopied = nLen;
+
+	memcpy(szBuffer, m_szBuf + m_nBufPos, nCopied);
+	m_nBufPos += (unsigned int)nCopied;
+
+	if (nCopied == nLen)
+		return nCopied;
+
+	// Read the rest directly, leaving the buffer empty at the new position
+	nCopied			+= fread(szBuffer + nCopied, 1, nLen - nCopied, m_fptr);
+	m_nBufOffset	= ftell(m_fptr);
+	m_nBufLen		= 0;
+	m_nBufPos		= 0;
+
+	return nCopied;
+
+} // read()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// remaining()
+///////////////////////////////////////////////////////////////////////////////
+
+long LineReader::remaining(void)
+{
+	long	nPos = ftell(m_fptr);				// Just past the buffer
+	long	nSize;
+
+	fseek(m_fptr, 0, SEEK_END);
+	nSize = ftell(m_fptr);
+	fseek(m_fptr, nPos, SEEK_SET);
+
+	return nSize - tell();
+
+} // remaining()
@@ -0,0 +1,97 @@
+#ifndef __LINE_READER_H
+#define __LINE_READER_H
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// line_reader.h
+//
+// A buffered line reader for a file opened with FileOpen() in read mode.
+// The file is read in large blocks rather than a char at a time, lines can
+// be any length, and the start of each line is remembered as the file is
+// scanned so FileReadLine() of a line that has already been passed is a
+// single seek rather than a re-read from the start of the file.
+//
+// Lines end with CRLF, LF or a lone CR (the same as Util_fgetsb()).  All
+// reads of the file must go through this object so that it can keep track
+// of where it is.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#define LINEREADER_BUFSIZE	65536				// Size of the read buffer
+
+
+class LineReader
+{
+public:
+	// Functions
+	LineReader(FILE *fptr);						// Constructor
+	~LineReader();								// Destructor
+
+	const char *	readline(void);				// Read the next line (NULL at EOF)
+	const char *	readline(int nLine);		// Read line nLine (1 based, NULL if no such line)
+	size_t			read(char *szBuffer, size_t nLen);	// Read raw chars
+	long			remaining(void);			// Number of chars left to read
+
+private:
+	// Variables
+	FILE			*m_fptr;					// The file (not owned)
+	char			*m_szBuf;					// Read buffer
+	long			m_nBufOffset;				// File offset of m_szBuf[0]
+	unsigned int	m_nBufLen;					// Number of valid chars in the buffer
+	unsigned int	m_nBufPos;					// Current position in the buffer
+
+	char			*m_szLine;					// Last line read
+	unsigned int	m_nLineAlloc;				// Size of m_szLine
+
+	long			*m_lpLines;					// File offset of the start of each line seen so far
+	unsigned int	m_nLines;					// Number of entries in m_lpLines
+	unsigned int	m_nLinesAlloc;				// Size of m_lpLines
+	int				m_nCurLine;					// Line (0 based) at the current position (-1 = unknown)
+
+	// Functions
+	bool			fill(void);
+	void			seek(long nOffset);
+	const char *	scanline(void);
+	void			append(const char *szText, unsigned int nLen, unsigned int &nPos);
+	long			tell(void) const { return m_nBufOffset + (long)m_nBufPos; }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
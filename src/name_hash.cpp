@@ -0,0 +1,315 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// name_hash.cpp
+//
+// A minimal perfect hash over a fixed list of names.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+// Includes
+#include "StdAfx.h"								// Pre-compiled headers
+
+#ifndef _MSC_VER								// Includes for non-MS compilers
+	#include <string.h>
+	#include <windows.h>
+#endif
+
+#include "AutoIt.h"
+#include "name_hash.h"
+
+
+#define NAMEHASH_MAXDISP	0x10000				// Displacements tried per bucket before growing the table
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor()
+///////////////////////////////////////////////////////////////////////////////
+
+NameHash::NameHash() : m_szNames(NULL), m_nLens(NULL), m_nNames(0), m_nDisp(NULL),
+	m_nBucketMask(0), m_nSlots(NULL), m_nSlotShift(32)
+{
+
+} // NameHash()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor()
+///////////////////////////////////////////////////////////////////////////////
+
+NameHash::~NameHash()
+{
+	free();
+
+} // ~NameHash()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// free()
+///////////////////////////////////////////////////////////////////////////////
+
+void NameHash::free(void)
+{
+	delete [] m_szNames;
+	delete [] m_nLens;
+	delete [] m_nDisp;
+	delete [] m_nSlots;
+
+	m_szNames	= NULL;
+	m_nLens		= NULL;
+	m_nDisp		= NULL;
+	m_nSlots	= NULL;
+	m_nNames	= 0;
+
+} // free()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// hash()
+//
+// Computes two independent hashes of a name in one pass, FNV-1a picks the
+// bucket and djb2 picks the slot.  Lower case is folded to upper case.
+///////////////////////////////////////////////////////////////////////////////
+
+void NameHash::hash(const char *szName, int nLen, unsigned int &nHash1, unsigned int &nHash2)
+{
+	unsigned int	h1 = 2166136261U;
+	unsigned int	h2 = 5381;
+	unsigned int	ch;
+
+	while (nLen--)
+	{
+		ch = (unsigned char)*szName++;
+		if (ch >= 'a' && ch <= 'z')
+			ch -= 'a' - 'A';
+
+		h1 = (h1 ^ ch) * 16777619U;
+		h2 = (h2 << 5) + h2 + ch;
+	}
+
+	nHash1 = h1;
+	nHash2 = h2;
+
+} // hash()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// build()
+//
+// Builds the table for the given names, the index returned by find() is the
+// position of the name in szNames.
+///////////////////////////////////////////////////////////////////////////////
+
+void NameHash::build(const char * const *szNames, int nNames)
+{
+	unsigned int	*nHash1, *nHash2;
+	int				i, nSlotBits, nBuckets;
+
+	free();
+
+	m_nNames	= nNames;
+	m_szNames	= new const char *[nNames];
+	m_nLens		= new int[nNames];
+	nHash1		= new unsigned int[nNames];
+	nHash2		= new unsigned int[nNames];
+
+	for (i = 0; i < nNames; ++i)
+	{
+		m_szNames[i]	= szNames[i];
+		m_nLens[i]		= (int)strlen(szNames[i]);
+		hash(szNames[i], m_nLens[i], nHash1[i], nHash2[i]);
+	}
+
+	// About two names per bucket and a table at most half full
+	for (nBuckets = 1; nBuckets * 2 < nNames; nBuckets *= 2)
+		;
+	m_nBucketMask = (unsigned int)nBuckets - 1;
+	m_nDisp = new unsigned int[nBuckets];
+
+	for (nSlotBits = 4; (1 << nSlotBits) < nNames * 2; ++nSlotBits)
+		;
+
+	// If some bucket can't be placed (very unlikely) try a bigger table
+	while (place(nHash1, nHash2, nSlotBits) == false)
+	{
+		++nSlotBits;
+		AUT_ASSERT(nSlotBits < 24);
+	}
+
+	delete [] nHash1;
+	delete [] nHash2;
+
+} // build()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// place()
+//
+// Tries to find a displacement for every bucket so that all the names land in
+// different slots.  The largest buckets are placed first while the table is
+// still empty.
+///////////////////////////////////////////////////////////////////////////////
+
+bool NameHash::place(unsigned int *nHash1, unsigned int *nHash2, int nSlotBits)
+{
+	int				nSlots = 1 << nSlotBits;
+	int				nBuckets = (int)m_nBucketMask + 1;
+	int				*nBucketSize = new int[nBuckets];
+	int				*nItems = new int[m_nNames];
+	unsigned int	*nTry = new unsigned int[m_nNames];
+	int				i, j, k, b, nSize, nMaxSize = 0, nCount;
+	unsigned int	nDisp;
+	bool			bOK = true;
+
+	delete [] m_nSlots;
+	m_nSlots		= new int[nSlots];
+	m_nSlotShift	= 32 - nSlotBits;
+
+	for (i = 0; i < nSlots; ++i)
+		m_nSlots[i] = -1;
+
+	for (b = 0; b < nBuckets; ++b)
+	{
+		nBucketSize[b]	= 0;
+		m_nDisp[b]		= 0;
+	}
+
+	for (i = 0; i < m_nNames; ++i)
+	{
+		nSize = ++nBucketSize[nHash1[i] & m_nBucketMask];
+		if (nSize > nMaxSize)
+			nMaxSize = nSize;
+	}
+
+	for (nSize = nMaxSize; nSize > 0 && bOK; --nSize)
+	{
+		for (b = 0; b < nBuckets && bOK; ++b)
+		{
+			if (nBucketSize[b] != nSize)
+				continue;
+
+			// Get the names in this bucket
+			nCount = 0;
+			for (i = 0; i < m_nNames; ++i)
+			{
+				if ((nHash1[i] & m_nBucketMask) == (unsigned int)b)
+					nItems[nCount++] = i;
+			}
+
+			// Find a displacement that puts them all in empty (and different) slots
+			for (nDisp = 0; nDisp < NAMEHASH_MAXDISP; ++nDisp)
+			{
+				for (j = 0; j < nCount; ++j)
+				{
+					nTry[j] = slot(nHash2[nItems[j]], nDisp);
+					if (m_nSlots[nTry[j]] != -1)
+						break;
+
+					for (k = 0; k < j; ++k)
+					{
+						if (nTry[k] == nTry[j])
+							break;
+					}
+					if (k < j)
+						break;
+				}
+
+				if (j == nCount)
+					break;						// All placed
+			}
+
+			if (nDisp == NAMEHASH_MAXDISP)
+			{
+				bOK = false;
+				break;
+			}
+
+			m_nDisp[b] = nDisp;
+			for (j = 0; j < nCount; ++j)
+				m_nSlots[nTry[j]] = nItems[j];
+		}
+	}
+
+	delete [] nBucketSize;
+	delete [] nItems;
+	delete [] nTry;
+
+	return bOK;
+
+} // place()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// find()
+//
+// Returns the index of the name in the list given to build(), or -1 if the
+// name isn't in the list.  The name is nLen characters and doesn't need to be
+// terminated.
+///////////////////////////////////////////////////////////////////////////////
+
+int NameHash::find(const char *szName, int nLen) const
+{
+	unsigned int	nHash1, nHash2;
+	unsigned int	ch;
+	const char		*szTemp;
+	int				i;
+
+	if (m_nNames == 0)
+		return -1;
+
+	hash(szName, nLen, nHash1, nHash2);
+
+	i = m_nSlots[slot(nHash2, m_nDisp[nHash1 & m_nBucketMask])];
+	if (i == -1 || m_nLens[i] != nLen)
+		return -1;
+
+	// Check that it really is this name (the stored name is upper case)
+	szTemp = m_szNames[i];
+	while (nLen--)
+	{
+		ch = (unsigned char)*szName++;
+		if (ch >= 'a' && ch <= 'z')
+			ch -= 'a' - 'A';
+
+		if (ch != (unsigned char)*szTemp++)
+			return -1;
+	}
+
+	return i;
+
+} // find()
@@ -0,0 +1,87 @@
+#ifndef __NAME_HASH_H
+#define __NAME_HASH_H
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// name_hash.h
+//
+// A minimal perfect hash over a fixed list of names (keywords, built-in
+// functions and macros).  The table is built once at startup using "hash and
+// displace": names are split into buckets by one hash and each bucket is
+// given a displacement that moves all of its names into free slots of a
+// second hash.  A lookup is then a single pass over the name to compute both
+// hashes, one slot and one comparison to reject names that aren't in the list.
+//
+// Lookups are case insensitive and take a pointer and length so that names
+// can be looked up directly from a script line without copying them.  Names
+// in the list must be upper case and only contain A-Z, 0-9 and _.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+class NameHash
+{
+public:
+	// Functions
+	NameHash();									// Constructor
+	~NameHash();								// Destructor
+
+	void		build(const char * const *szNames, int nNames);		// Build the table (names must outlive it)
+	int			find(const char *szName, int nLen) const;			// Index of the name (or -1)
+
+private:
+	// Variables
+	const char		**m_szNames;				// The names (not owned)
+	int				*m_nLens;					// Length of each name
+	int				m_nNames;					// Number of names
+	unsigned int	*m_nDisp;					// Displacement for each bucket
+	unsigned int	m_nBucketMask;				// Number of buckets - 1 (power of 2)
+	int				*m_nSlots;					// Name index in each slot (-1 = empty)
+	int				m_nSlotShift;				// 32 - log2(number of slots)
+
+	// Functions
+	void			free(void);
+	bool			place(unsigned int *nHash1, unsigned int *nHash2, int nSlotBits);
+	static void		hash(const char *szName, int nLen, unsigned int &nHash1, unsigned int &nHash2);
+	unsigned int	slot(unsigned int nHash2, unsigned int nDisp) const
+						{ return ((nHash2 + nDisp) * 0x9E3779B1U) >> m_nSlotShift; }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
@@ -43,3 +43,1258 @@
 // Includes
 #include "StdAfx.h"								// Pre-compiled headers
 
+
+#ifndef _MSC_VER								// Includes for non-MS compilers
+	#include <string.h>
+#endif
+
+#include "regexp.h"
+
+
+// Opcodes
+enum
+{
+	REGEXP_OP_CHAR,								// Match char x
+	REGEXP_OP_CHARI,							// Match char x (case folded)
+	REGEXP_OP_ANY,								// Match any char except \n
+	REGEXP_OP_ANYNL,							// Match any char
+	REGEXP_OP_CLASS,							// Match a char in class x
+	REGEXP_OP_MATCH,							// Successful match
+	REGEXP_OP_JMP,								// Jump to x
+	REGEXP_OP_SPLIT,							// Try x then y
+	REGEXP_OP_SAVE,								// Save position in capture slot x
+	REGEXP_OP_ASSERT							// Zero width assertion x
+};
+
+// Assertions
+enum
+{
+	REGEXP_AS_BOL,								// ^  (start of text)
+	REGEXP_AS_EOL,								// $  (end of text or before a final \n)
+	REGEXP_AS_MBOL,								// ^  (multiline: start of any line)
+	REGEXP_AS_MEOL,								// $  (multiline: end of any line)
+	REGEXP_AS_WORDB,							// \b
+	REGEXP_AS_NWORDB,							// \B
+	REGEXP_AS_TEXTEND							// \z
+};
+
+// (?ims) flags
+#define REGEXP_FLAG_ICASE		1
+#define REGEXP_FLAG_MULTILINE	2
+#define REGEXP_FLAG_DOTALL		4
+
+
+// ASCII helpers (the C library versions depend on the locale)
+#define REGEXP_ISDIGIT(c)	((c) >= '0' && (c) <= '9')
+#define REGEXP_ISUPPER(c)	((c) >= 'A' && (c) <= 'Z')
+#define REGEXP_ISLOWER(c)	((c) >= 'a' && (c) <= 'z')
+#define REGEXP_ISALPHA(c)	(REGEXP_ISUPPER(c) || REGEXP_ISLOWER(c))
+#define REGEXP_ISWORD(c)	(REGEXP_ISALPHA(c) || REGEXP_ISDIGIT(c) || (c) == '_')
+#define REGEXP_FOLD(c)		(REGEXP_ISUPPER(c) ? (c) + ('a' - 'A') : (c))
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor()
+///////////////////////////////////////////////////////////////////////////////
+
+CRegExp::CRegExp()
+{
+	m_szPattern		= NULL;
+	m_Code			= NULL;
+	m_Classes		= NULL;
+	m_pnMatch		= NULL;
+	m_pnThreads[0]	= m_pnThreads[1] = NULL;
+	m_pnCaps[0]		= m_pnCaps[1] = NULL;
+	m_pnOnList		= NULL;
+	m_pnStack		= NULL;
+	m_pnCapWork		= NULL;
+
+	Reset();
+
+} // CRegExp()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor()
+///////////////////////////////////////////////////////////////////////////////
+
+CRegExp::~CRegExp()
+{
+	Reset();
+
+} // ~CRegExp()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Reset()
+//
+// Frees any compiled program and workspace.
+///////////////////////////////////////////////////////////////////////////////
+
+void CRegExp::Reset(void)
+{
+	delete [] m_szPattern;
+	delete [] m_Code;
+	delete [] m_Classes;
+	delete [] m_pnMatch;
+	delete [] m_pnThreads[0];
+	delete [] m_pnThreads[1];
+	delete [] m_pnCaps[0];
+	delete [] m_pnCaps[1];
+	delete [] m_pnOnList;
+	delete [] m_pnStack;
+	delete [] m_pnCapWork;
+
+	m_szPattern		= NULL;
+	m_Code			= NULL;
+	m_nCode			= 0;
+	m_nCodeAlloc	= 0;
+	m_Classes		= NULL;
+	m_nClasses		= 0;
+	m_nClassesAlloc	= 0;
+	m_nNumGroups	= 0;
+	m_nNumSlots		= 0;
+	m_pnMatch		= NULL;
+	m_pnThreads[0]	= m_pnThreads[1] = NULL;
+	m_pnCaps[0]		= m_pnCaps[1] = NULL;
+	m_pnOnList		= NULL;
+	m_pnStack		= NULL;
+	m_pnCapWork		= NULL;
+
+	m_szPos			= NULL;
+	m_nFlags		= 0;
+	m_nErrOffset	= -1;
+	m_nFirstChar	= -1;
+	m_nMaxThreads	= 0;
+
+} // Reset()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Compile()
+//
+// Compiles the pattern into a program.  Returns false if the pattern is
+// invalid (or unsupported), ErrorOffset() is then the position of the error.
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::Compile(const char *szPattern)
+{
+	int		i;
+
+	Reset();
+
+	m_szPattern = new char[strlen(szPattern)+1];
+	strcpy(m_szPattern, szPattern);
+	m_szPos = m_szPattern;
+
+	// Whole match is capture slots 0 and 1
+	Emit(REGEXP_OP_SAVE, 0);
+
+	if (!ParseAlt())
+		return false;
+
+	if (*m_szPos != '\0')						// Only an unmatched ) stops ParseAlt() early
+		return Error();
+
+	Emit(REGEXP_OP_SAVE, 1);
+	Emit(REGEXP_OP_MATCH);
+
+	if (m_nErrOffset >= 0)
+		return false;
+
+	// A literal first char lets Find() skip straight to candidate positions
+	if (m_Code[1].nOp == REGEXP_OP_CHAR)
+		m_nFirstChar = m_Code[1].x;
+
+	// Only consuming instructions (and MATCH) ever become threads
+	for (i=0; i<m_nCode; ++i)
+	{
+		if (m_Code[i].nOp <= REGEXP_OP_MATCH)
+			++m_nMaxThreads;
+	}
+
+	// Allocate the matching workspace
+	m_nNumSlots		= (m_nNumGroups + 1) * 2;
+	m_pnMatch		= new int[m_nNumSlots];
+	m_pnThreads[0]	= new int[m_nMaxThreads];
+	m_pnThreads[1]	= new int[m_nMaxThreads];
+	m_pnCaps[0]		= new int[m_nMaxThreads * m_nNumSlots];
+	m_pnCaps[1]		= new int[m_nMaxThreads * m_nNumSlots];
+	m_pnOnList		= new int[m_nCode];
+	m_pnStack		= new int[(m_nCode * 2 + 2) * 2];
+	m_pnCapWork		= new int[m_nNumSlots];
+
+	for (i=0; i<m_nNumSlots; ++i)
+		m_pnMatch[i] = -1;
+
+	return true;
+
+} // Compile()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Error()
+//
+// Records the current parse position as the error position (if none has
+// been recorded yet).  Always returns false.
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::Error(void)
+{
+	if (m_nErrOffset < 0)
+		m_nErrOffset = (int)(m_szPos - m_szPattern);
+
+	return false;
+
+} // Error()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Emit()
+//
+// Appends an instruction and returns its index (-1 if the program is too big).
+///////////////////////////////////////////////////////////////////////////////
+
+int CRegExp::Emit(int nOp, int x, int y)
+{
+	if (m_nCode >= REGEXP_MAXINSTS)
+	{
+		Error();
+		return -1;
+	}
+
+	if (m_nCode == m_nCodeAlloc)
+	{
+		m_nCodeAlloc = m_nCodeAlloc ? m_nCodeAlloc * 2 : 32;
+
+		RegExpInst	*lpTemp = new RegExpInst[m_nCodeAlloc];
+		if (m_nCode)
+			memcpy(lpTemp, m_Code, m_nCode * sizeof(RegExpInst));
+		delete [] m_Code;
+		m_Code = lpTemp;
+	}
+
+	m_Code[m_nCode].nOp	= nOp;
+	m_Code[m_nCode].x	= x;
+	m_Code[m_nCode].y	= y;
+
+	return m_nCode++;
+
+} // Emit()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Insert()
+//
+// Opens a gap of nCount instructions at nAt.  Jumps in the moved code that
+// point at or after nAt are adjusted; code before nAt is left alone so that
+// a jump to nAt now lands on the inserted instructions.
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::Insert(int nAt, int nCount)
+{
+	int		i;
+	int		nEnd = m_nCode;
+
+	// Grow using Emit() (which also enforces the size limit)
+	for (i=0; i<nCount; ++i)
+	{
+		if (Emit(REGEXP_OP_JMP, -1) < 0)
+			return false;
+	}
+
+	memmove(&m_Code[nAt+nCount], &m_Code[nAt], (nEnd - nAt) * sizeof(RegExpInst));
+
+	for (i=nAt+nCount; i<m_nCode; ++i)
+	{
+		if (m_Code[i].nOp == REGEXP_OP_JMP || m_Code[i].nOp == REGEXP_OP_SPLIT)
+		{
+			if (m_Code[i].x >= nAt)
+				m_Code[i].x += nCount;
+			if (m_Code[i].nOp == REGEXP_OP_SPLIT && m_Code[i].y >= nAt)
+				m_Code[i].y += nCount;
+		}
+	}
+
+	return true;
+
+} // Insert()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// CopyCode()
+//
+// Appends a copy of the nLen instructions starting at nFrom.  Jumps within
+// the fragment (including to its end) are moved to the copy.
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::CopyCode(int nFrom, int nLen)
+{
+	int		i, n;
+	int		nDelta = m_nCode - nFrom;
+
+	for (i=0; i<nLen; ++i)
+	{
+		if ( (n = Emit(m_Code[nFrom+i].nOp, m_Code[nFrom+i].x, m_Code[nFrom+i].y)) < 0)
+			return false;
+
+		if (m_Code[n].nOp == REGEXP_OP_JMP || m_Code[n].nOp == REGEXP_OP_SPLIT)
+		{
+			if (m_Code[n].x >= nFrom && m_Code[n].x <= nFrom + nLen)
+				m_Code[n].x += nDelta;
+			if (m_Code[n].nOp == REGEXP_OP_SPLIT && m_Code[n].y >= nFrom && m_Code[n].y <= nFrom + nLen)
+				m_Code[n].y += nDelta;
+		}
+	}
+
+	return true;
+
+} // CopyCode()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// NewClass()
+//
+// Adds an empty character class and returns its index.
+///////////////////////////////////////////////////////////////////////////////
+
+int CRegExp::NewClass(void)
+{
+	if (m_nClasses == m_nClassesAlloc)
+	{
+		m_nClassesAlloc = m_nClassesAlloc ? m_nClassesAlloc * 2 : 8;
+
+		unsigned char	(*lpTemp)[32] = new unsigned char[m_nClassesAlloc][32];
+		if (m_nClasses)
+			memcpy(lpTemp, m_Classes, m_nClasses * 32);
+		delete [] m_Classes;
+		m_Classes = lpTemp;
+	}
+
+	memset(m_Classes[m_nClasses], 0, 32);
+
+	return m_nClasses++;
+
+} // NewClass()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ClassAdd()
+///////////////////////////////////////////////////////////////////////////////
+
+void CRegExp::ClassAdd(int nClass, int nFrom, int nTo)
+{
+	for (int c=nFrom; c<=nTo; ++c)
+		m_Classes[nClass][c >> 3] |= (unsigned char)(1 << (c & 7));
+
+} // ClassAdd()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ClassAddType()
+//
+// Adds all chars of a type (d=digit, w=word, s=space or one of the POSIX
+// [:name:] classes below) or all chars NOT of that type.
+///////////////////////////////////////////////////////////////////////////////
+
+void CRegExp::ClassAddType(int nClass, int nType, bool bNegate)
+{
+	bool	bIn;
+
+	for (int c=0; c<256; ++c)
+	{
+		switch (nType)
+		{
+			case 'd':	bIn = REGEXP_ISDIGIT(c);	break;
+			case 'w':	bIn = REGEXP_ISWORD(c);		break;
+			case 's':	bIn = (c == ' ' || (c >= '\t' && c <= '\r'));	break;
+			case 'a':	bIn = REGEXP_ISALPHA(c);	break;
+			case 'n':	bIn = REGEXP_ISALPHA(c) || REGEXP_ISDIGIT(c);	break;
+			case 'u':	bIn = REGEXP_ISUPPER(c);	break;
+			case 'l':	bIn = REGEXP_ISLOWER(c);	break;
+			case 'x':	bIn = REGEXP_ISDIGIT(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');	break;
+			case 'b':	bIn = (c == ' ' || c == '\t');	break;
+			case 'c':	bIn = (c < 32 || c == 127);	break;
+			case 'r':	bIn = (c >= 32 && c < 127);	break;
+			case 'g':	bIn = (c > 32 && c < 127);	break;
+			case 'p':	bIn = (c > 32 && c < 127 && !REGEXP_ISALPHA(c) && !REGEXP_ISDIGIT(c));	break;
+			default:	bIn = false;				break;
+		}
+
+		if (bIn != bNegate)
+			ClassAdd(nClass, c, c);
+	}
+
+} // ClassAddType()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// EmitChar()
+///////////////////////////////////////////////////////////////////////////////
+
+void CRegExp::EmitChar(int nChar)
+{
+	if ( (m_nFlags & REGEXP_FLAG_ICASE) && REGEXP_ISALPHA(nChar) )
+		Emit(REGEXP_OP_CHARI, REGEXP_FOLD(nChar));
+	else
+		Emit(REGEXP_OP_CHAR, nChar);
+
+} // EmitChar()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ParseAlt()
+//
+// alt := concat ( '|' alt )?
+//
+// Compiled as:	SPLIT L1, L2
+//			L1:	concat
+//				JMP L3
+//			L2:	alt
+//			L3:
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::ParseAlt(void)
+{
+	int		nStart = m_nCode;
+	int		nJmp, nRight;
+
+	if (!ParseConcat())
+		return false;
+
+	if (*m_szPos != '|')
+		return true;
+
+	++m_szPos;
+
+	if (!Insert(nStart, 1))
+		return false;
+
+	if ( (nJmp = Emit(REGEXP_OP_JMP, -1)) < 0)
+		return false;
+
+	nRight = m_nCode;
+
+	if (!ParseAlt())
+		return false;
+
+	m_Code[nStart].nOp	= REGEXP_OP_SPLIT;
+	m_Code[nStart].x	= nStart + 1;
+	m_Code[nStart].y	= nRight;
+	m_Code[nJmp].x		= m_nCode;
+
+	return true;
+
+} // ParseAlt()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ParseConcat()
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::ParseConcat(void)
+{
+	while (*m_szPos != '\0' && *m_szPos != '|' && *m_szPos != ')')
+	{
+		if (!ParseRepeat())
+			return false;
+	}
+
+	return true;
+
+} // ParseConcat()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ParseRepeat()
+//
+// An atom followed by an optional quantifier.
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::ParseRepeat(void)
+{
+	int		nStart = m_nCode;
+	int		nMin, nMax;
+	bool	bGreedy = true;
+
+	if (!ParseAtom())
+		return false;
+
+	switch (*m_szPos)
+	{
+		case '*':
+			nMin = 0;	nMax = -1;	++m_szPos;
+			break;
+		case '+':
+			nMin = 1;	nMax = -1;	++m_szPos;
+			break;
+		case '?':
+			nMin = 0;	nMax = 1;	++m_szPos;
+			break;
+		case '{':
+			if (ParseCount(nMin, nMax))
+				break;
+			return true;						// Not a count, { is a literal
+		default:
+			return true;
+	}
+
+	if (*m_szPos == '?')
+	{
+		bGreedy = false;
+		++m_szPos;
+	}
+	else if (*m_szPos == '+')
+		return Error();							// Possessive quantifiers are not supported
+
+	return Repeat(nStart, nMin, nMax, bGreedy);
+
+} // ParseRepeat()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ParseCount()
+//
+// Parses {n}, {n,} or {n,m}.  Returns false (with the position unchanged) if
+// the text is not a valid count, in which case the { is a literal.
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::ParseCount(int &nMin, int &nMax)
+{
+	const char	*szPos = m_szPos + 1;
+
+	if (!REGEXP_ISDIGIT(*szPos))
+		return false;
+
+	nMin = 0;
+	while (REGEXP_ISDIGIT(*szPos) && nMin <= REGEXP_MAXREPEAT)
+		nMin = nMin * 10 + (*szPos++ - '0');
+
+	if (*szPos == '}')
+		nMax = nMin;
+	else if (*szPos == ',')
+	{
+		++szPos;
+		if (*szPos == '}')
+			nMax = -1;
+		else
+		{
+			if (!REGEXP_ISDIGIT(*szPos))
+				return false;
+
+			nMax = 0;
+			while (REGEXP_ISDIGIT(*szPos) && nMax <= REGEXP_MAXREPEAT)
+				nMax = nMax * 10 + (*szPos++ - '0');
+		}
+
+		if (*szPos != '}')
+			return false;
+	}
+	else
+		return false;
+
+	// It is a count, so bad values are errors rather than literals
+	if (nMin > REGEXP_MAXREPEAT || nMax > REGEXP_MAXREPEAT || (nMax >= 0 && nMax < nMin))
+		return !Error();
+
+	m_szPos = szPos + 1;
+
+	return true;
+
+} // ParseCount()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Repeat()
+//
+// Applies a quantifier to the code from nStart to the end of the program.
+//
+//	x*		SPLIT L1, L2;  L1: x;  JMP SPLIT;  L2:
+//	x+		L1: x;  SPLIT L1, L2;  L2:
+//	x?		SPLIT L1, L2;  L1: x;  L2:
+//	x{n,m}	x repeated n times then (m-n) copies of x?, all skipping to the end
+//
+// Lazy quantifiers just swap the preference of each SPLIT.
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::Repeat(int nStart, int nMin, int nMax, bool bGreedy)
+{
+	int		nLen = m_nCode - nStart;
+	int		*pnSplits;
+	int		nSplits = 0;
+	int		nLast, nEnd, i, n;
+
+	if (m_nErrOffset >= 0)
+		return false;
+
+	if (nLen == 0)								// Nothing to repeat (e.g. (?i) or (?:))
+		return true;
+
+	if (nMax == 0)								// x{0} matches nothing
+	{
+		m_nCode = nStart;
+		return true;
+	}
+
+	// x*
+	if (nMin == 0 && nMax == -1)
+	{
+		if (!Insert(nStart, 1) || Emit(REGEXP_OP_JMP, nStart) < 0)
+			return false;
+
+		m_Code[nStart].nOp	= REGEXP_OP_SPLIT;
+		m_Code[nStart].x	= bGreedy ? nStart + 1 : m_nCode;
+		m_Code[nStart].y	= bGreedy ? m_nCode : nStart + 1;
+		return true;
+	}
+
+	// The mandatory copies (the original is the first)
+	nLast = nStart;
+	for (i=1; i<nMin; ++i)
+	{
+		nLast = m_nCode;
+		if (!CopyCode(nStart, nLen))
+			return false;
+	}
+
+	// x{n,} is n-1 copies of x then x+
+	if (nMax == -1)
+	{
+		n = m_nCode;
+		return Emit(REGEXP_OP_SPLIT, bGreedy ? nLast : n + 1, bGreedy ? n + 1 : nLast) >= 0;
+	}
+
+	// Optional copies, each skips to the end.  With no mandatory copies the
+	// original becomes the first optional one.
+	pnSplits = new int[nMax - nMin];
+
+	for (i = (nMin == 0 ? 1 : 0); i < nMax - nMin; ++i)
+	{
+		if ( (pnSplits[nSplits++] = Emit(REGEXP_OP_JMP, -1)) < 0 || !CopyCode(nStart, nLen) )
+		{
+			delete [] pnSplits;
+			return false;
+		}
+	}
+
+	if (nMin == 0)
+	{
+		if (!Insert(nStart, 1))
+		{
+			delete [] pnSplits;
+			return false;
+		}
+
+		for (i=0; i<nSplits; ++i)
+			++pnSplits[i];						// Moved by the insert
+
+		pnSplits[nSplits++] = nStart;
+	}
+
+	nEnd = m_nCode;
+	for (i=0; i<nSplits; ++i)
+	{
+		n = pnSplits[i];
+		m_Code[n].nOp	= REGEXP_OP_SPLIT;
+		m_Code[n].x		= bGreedy ? n + 1 : nEnd;
+		m_Code[n].y		= bGreedy ? nEnd : n + 1;
+	}
+
+	delete [] pnSplits;
+
+	return true;
+
+} // Repeat()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ParseAtom()
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::ParseAtom(void)
+{
+	int		nChar, nClass, nMin, nMax;
+
+	switch (*m_szPos)
+	{
+		case '(':
+			return ParseGroup();
+
+		case '[':
+			return ParseClass();
+
+		case '.':
+			++m_szPos;
+			Emit( (m_nFlags & REGEXP_FLAG_DOTALL) ? REGEXP_OP_ANYNL : REGEXP_OP_ANY);
+			break;
+
+		case '^':
+			++m_szPos;
+			Emit(REGEXP_OP_ASSERT, (m_nFlags & REGEXP_FLAG_MULTILINE) ? REGEXP_AS_MBOL : REGEXP_AS_BOL);
+			break;
+
+		case '$':
+			++m_szPos;
+			Emit(REGEXP_OP_ASSERT, (m_nFlags & REGEXP_FLAG_MULTILINE) ? REGEXP_AS_MEOL : REGEXP_AS_EOL);
+			break;
+
+		case '*':
+		case '+':
+		case '?':
+			return Error();						// Nothing to repeat
+
+		case '{':
+			if (ParseCount(nMin, nMax))
+				return Error();					// Nothing to repeat
+			if (m_nErrOffset >= 0)
+				return false;
+			EmitChar(*m_szPos++);
+			break;
+
+		case '\\':
+			++m_szPos;
+			switch (*m_szPos)
+			{
+				case 'b':	++m_szPos;	Emit(REGEXP_OP_ASSERT, REGEXP_AS_WORDB);	break;
+				case 'B':	++m_szPos;	Emit(REGEXP_OP_ASSERT, REGEXP_AS_NWORDB);	break;
+				case 'A':	++m_szPos;	Emit(REGEXP_OP_ASSERT, REGEXP_AS_BOL);		break;
+				case 'Z':	++m_szPos;	Emit(REGEXP_OP_ASSERT, REGEXP_AS_EOL);		break;
+				case 'z':	++m_szPos;	Emit(REGEXP_OP_ASSERT, REGEXP_AS_TEXTEND);	break;
+
+				case 'd':	case 'D':
+				case 'w':	case 'W':
+				case 's':	case 'S':
+					nClass = NewClass();
+					ClassAddType(nClass, REGEXP_FOLD(*m_szPos), REGEXP_ISUPPER(*m_szPos));
+					++m_szPos;
+					Emit(REGEXP_OP_CLASS, nClass);
+					break;
+
+				case 'Q':						// Literal text up to \E
+					++m_szPos;
+					while (*m_szPos != '\0' && !(m_szPos[0] == '\\' && m_szPos[1] == 'E'))
+						EmitChar((unsigned char)*m_szPos++);
+					if (*m_szPos != '\0')
+						m_szPos += 2;
+					break;
+
+				case 'E':						// Stray \E is ignored
+					++m_szPos;
+					break;
+
+				default:
+					if (!ParseEscape(nChar))
+						return false;
+					EmitChar(nChar);
+					break;
+			}
+			break;
+
+		default:
+			EmitChar((unsigned char)*m_szPos++);
+			break;
+	}
+
+	return m_nErrOffset < 0;
+
+} // ParseAtom()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ParseEscape()
+//
+// Parses a single character escape (the position is just after the \).
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::ParseEscape(int &nChar)
+{
+	int		i, c;
+
+	c = (unsigned char)*m_szPos;
+
+	switch (c)
+	{
+		case '\0':	return Error();
+		case 't':	nChar = '\t';	break;
+		case 'n':	nChar = '\n';	break;
+		case 'r':	nChar = '\r';	break;
+		case 'f':	nChar = '\f';	break;
+		case 'v':	nChar = '\v';	break;
+		case 'a':	nChar = '\a';	break;
+		case 'e':	nChar = 27;		break;
+
+		case 'x':
+			nChar = 0;
+			for (i=0; i<2; ++i)
+			{
+				c = (unsigned char)m_szPos[1];
+				if (REGEXP_ISDIGIT(c))
+					nChar = nChar * 16 + (c - '0');
+				else if (c >= 'a' && c <= 'f')
+					nChar = nChar * 16 + (c - 'a' + 10);
+				else if (c >= 'A' && c <= 'F')
+					nChar = nChar * 16 + (c - 'A' + 10);
+				else
+					break;
+				++m_szPos;
+			}
+			break;
+
+		default:
+			// Other letters and digits are unknown escapes or backreferences,
+			// neither of which are supported.  Any symbol stands for itself.
+			if (REGEXP_ISALPHA(c) || REGEXP_ISDIGIT(c))
+				return Error();
+			nChar = c;
+			break;
+	}
+
+	++m_szPos;
+
+	return true;
+
+} // ParseEscape()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ParseGroup()
+//
+// (...), (?:...), (?flags) and (?flags:...)
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::ParseGroup(void)
+{
+	int		nSavedFlags = m_nFlags;
+	int		nGroup = -1;
+	int		nFlag;
+	bool	bOn = true;
+
+	++m_szPos;
+
+	if (*m_szPos == '?')
+	{
+		++m_szPos;
+
+		// Flags
+		for (;;)
+		{
+			switch (*m_szPos)
+			{
+				case 'i':	nFlag = REGEXP_FLAG_ICASE;		break;
+				case 'm':	nFlag = REGEXP_FLAG_MULTILINE;	break;
+				case 's':	nFlag = REGEXP_FLAG_DOTALL;		break;
+				case '-':	nFlag = 0;	bOn = false;		break;
+				default:	nFlag = -1;						break;
+			}
+
+			if (nFlag < 0)
+				break;
+
+			if (bOn)
+				m_nFlags |= nFlag;
+			else
+				m_nFlags &= ~nFlag;
+
+			++m_szPos;
+		}
+
+		if (*m_szPos == ')')					// (?flags) applies to the rest of the enclosing group
+		{
+			++m_szPos;
+			return true;
+		}
+
+		if (*m_szPos != ':')
+			return Error();						// Lookaround etc are not supported
+
+		++m_szPos;
+	}
+	else
+	{
+		if (m_nNumGroups >= REGEXP_MAXGROUPS)
+			return Error();
+
+		nGroup = ++m_nNumGroups;
+		Emit(REGEXP_OP_SAVE, nGroup * 2);
+	}
+
+	if (!ParseAlt())
+		return false;
+
+	if (*m_szPos != ')')
+		return Error();							// Missing )
+
+	++m_szPos;
+
+	if (nGroup > 0)
+		Emit(REGEXP_OP_SAVE, nGroup * 2 + 1);
+
+	m_nFlags = nSavedFlags;
+
+	return m_nErrOffset < 0;
+
+} // ParseGroup()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ParseClass()
+//
+// [...] and [^...]
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::ParseClass(void)
+{
+	static const char	*szPosix[]	= {"alpha", "digit", "alnum", "upper", "lower", "space", "punct",
+									   "xdigit", "word", "blank", "cntrl", "print", "graph", NULL};
+	static const char	szTypes[]	= "adnulspxwbcrg";
+
+	int			nClass = NewClass();
+	bool		bNegate = false;
+	bool		bFirst = true;
+	int			nLo, nHi, i, c;
+	const char	*szEnd;
+
+	++m_szPos;
+	if (*m_szPos == '^')
+	{
+		bNegate = true;
+		++m_szPos;
+	}
+
+	for (;;)
+	{
+		c = (unsigned char)*m_szPos;
+
+		if (c == '\0')
+			return Error();						// Missing ]
+
+		if (c == ']' && !bFirst)
+		{
+			++m_szPos;
+			break;
+		}
+
+		bFirst = false;
+
+		// [:name:]
+		if (c == '[' && m_szPos[1] == ':' && (szEnd = strstr(m_szPos+2, ":]")) != NULL)
+		{
+			for (i=0; szPosix[i] != NULL; ++i)
+			{
+				if ( (int)strlen(szPosix[i]) == szEnd - (m_szPos+2) && !strncmp(szPosix[i], m_szPos+2, szEnd - (m_szPos+2)) )
+					break;
+			}
+
+			if (szPosix[i] == NULL)
+				return Error();
+
+			ClassAddType(nClass, szTypes[i], false);
+			m_szPos = szEnd + 2;
+			continue;
+		}
+
+		if (c == '\\')
+		{
+			++m_szPos;
+			c = (unsigned char)*m_szPos;
+			if (c == 'd' || c == 'D' || c == 'w' || c == 'W' || c == 's' || c == 'S')
+			{
+				ClassAddType(nClass, REGEXP_FOLD(c), REGEXP_ISUPPER(c));
+				++m_szPos;
+				continue;
+			}
+			if (c == 'b')						// \b is backspace in a class
+			{
+				nLo = '\b';
+				++m_szPos;
+			}
+			else if (!ParseEscape(nLo))
+				return false;
+		}
+		else
+		{
+			nLo = c;
+			++m_szPos;
+		}
+
+		// Range?
+		if (m_szPos[0] == '-' && m_szPos[1] != ']' && m_szPos[1] != '\0')
+		{
+			++m_szPos;
+			if (*m_szPos == '\\')
+			{
+				++m_szPos;
+				if (!ParseEscape(nHi))
+					return false;
+			}
+			else
+				nHi = (unsigned char)*m_szPos++;
+
+			if (nHi < nLo)
+				return Error();
+
+			ClassAdd(nClass, nLo, nHi);
+		}
+		else
+			ClassAdd(nClass, nLo, nLo);
+	}
+
+	// Case insensitive classes contain both cases of each letter
+	if (m_nFlags & REGEXP_FLAG_ICASE)
+	{
+		for (c='a'; c<='z'; ++c)
+		{
+			if ( (m_Classes[nClass][c >> 3] & (1 << (c & 7))) || (m_Classes[nClass][(c-32) >> 3] & (1 << ((c-32) & 7))) )
+			{
+				ClassAdd(nClass, c, c);
+				ClassAdd(nClass, c-32, c-32);
+			}
+		}
+	}
+
+	if (bNegate)
+	{
+		for (i=0; i<32; ++i)
+			m_Classes[nClass][i] = (unsigned char)~m_Classes[nClass][i];
+	}
+
+	Emit(REGEXP_OP_CLASS, nClass);
+
+	return m_nErrOffset < 0;
+
+} // ParseClass()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Assert()
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::Assert(int nType, const char *szText, int nTextLen, int nPos) const
+{
+	bool	bBefore, bAfter;
+
+	switch (nType)
+	{
+		case REGEXP_AS_BOL:
+			return nPos == 0;
+
+		case REGEXP_AS_EOL:
+			return nPos == nTextLen || (nPos == nTextLen-1 && szText[nPos] == '\n');
+
+		case REGEXP_AS_MBOL:
+			return nPos == 0 || szText[nPos-1] == '\n';
+
+		case REGEXP_AS_MEOL:
+			return nPos == nTextLen || szText[nPos] == '\n';
+
+		case REGEXP_AS_TEXTEND:
+			return nPos == nTextLen;
+
+		default:								// Word boundaries
+			bBefore	= nPos > 0 && REGEXP_ISWORD((unsigned char)szText[nPos-1]);
+			bAfter	= nPos < nTextLen && REGEXP_ISWORD((unsigned char)szText[nPos]);
+			return (bBefore != bAfter) == (nType == REGEXP_AS_WORDB);
+	}
+
+} // Assert()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AddThread()
+//
+// Adds a thread at nPC to list nList, following jumps, splits, saves and
+// assertions so that only consuming instructions (and MATCH) are stored.
+// The capture slots of the new thread are in m_pnCapWork.  An instruction
+// already on the list for this position (nStamp) is not added again, which
+// is what keeps the list (and the matching time) bounded.
+//
+// An explicit stack is used rather than recursion.  Negative entries restore
+// a capture slot once the branch that changed it has been followed.
+//
+// Returns the new number of threads on the list.
+///////////////////////////////////////////////////////////////////////////////
+
+int CRegExp::AddThread(int nList, int nCount, int nPC, int nPos, int nStamp, const char *szText, int nTextLen)
+{
+	int			nSP = 0;
+	int			nA, nB;
+	RegExpInst	*lpInst;
+
+	m_pnStack[nSP++] = nPC;
+	m_pnStack[nSP++] = 0;
+
+	while (nSP > 0)
+	{
+		nB = m_pnStack[--nSP];
+		nA = m_pnStack[--nSP];
+
+		if (nA < 0)
+		{
+			m_pnCapWork[-nA-1] = nB;			// Restore slot
+			continue;
+		}
+
+		if (m_pnOnList[nA] == nStamp)
+			continue;
+		m_pnOnList[nA] = nStamp;
+
+		lpInst = &m_Code[nA];
+
+		switch (lpInst->nOp)
+		{
+			case REGEXP_OP_JMP:
+				m_pnStack[nSP++] = lpInst->x;
+				m_pnStack[nSP++] = 0;
+				break;
+
+			case REGEXP_OP_SPLIT:				// Push y first so x is followed first
+				m_pnStack[nSP++] = lpInst->y;
+				m_pnStack[nSP++] = 0;
+				m_pnStack[nSP++] = lpInst->x;
+				m_pnStack[nSP++] = 0;
+				break;
+
+			case REGEXP_OP_SAVE:
+				m_pnStack[nSP++] = -lpInst->x - 1;
+				m_pnStack[nSP++] = m_pnCapWork[lpInst->x];
+				m_pnCapWork[lpInst->x] = nPos;
+				m_pnStack[nSP++] = nA + 1;
+				m_pnStack[nSP++] = 0;
+				break;
+
+			case REGEXP_OP_ASSERT:
+				if (Assert(lpInst->x, szText, nTextLen, nPos))
+				{
+					m_pnStack[nSP++] = nA + 1;
+					m_pnStack[nSP++] = 0;
+				}
+				break;
+
+			default:
+				m_pnThreads[nList][nCount] = nA;
+				memcpy(m_pnCaps[nList] + nCount * m_nNumSlots, m_pnCapWork, m_nNumSlots * sizeof(int));
+				++nCount;
+				break;
+		}
+	}
+
+	return nCount;
+
+} // AddThread()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Find()
+//
+// Finds the first (leftmost) match that starts at or after nStart.  Where
+// several matches start at the same place the one preferred by a
+// backtracking matcher is chosen (greedy/lazy and alternation order are
+// honoured).  The match details are then available from GroupStart() and
+// GroupEnd().
+//
+// Each text char is looked at once, with at most one thread per program
+// instruction, so the time taken is linear in the length of the text.
+///////////////////////////////////////////////////////////////////////////////
+
+bool CRegExp::Find(const char *szText, int nTextLen, int nStart)
+{
+	int				nCur = 0, nNext = 1;
+	int				nCount = 0, nNextCount;
+	int				nPos, i, c, nPC;
+	int				*pnCaps;
+	bool			bMatched = false;
+	const char		*szFound;
+	RegExpInst		*lpInst;
+
+	if (m_Code == NULL || nStart < 0 || nStart > nTextLen)
+		return false;
+
+	for (i=0; i<m_nCode; ++i)
+		m_pnOnList[i] = -1;
+
+	for (nPos = nStart; ; ++nPos)
+	{
+		// Start a new (lowest priority) thread here unless a match has
+		// already been found further left
+		if (!bMatched)
+		{
+			if (nCount == 0 && m_nFirstChar >= 0)
+			{
+				szFound = (const char *)memchr(szText + nPos, m_nFirstChar, nTextLen - nPos);
+				if (szFound == NULL)
+					break;
+				nPos = (int)(szFound - szText);
+			}
+
+			for (i=0; i<m_nNumSlots; ++i)
+				m_pnCapWork[i] = -1;
+
+			nCount = AddThread(nCur, nCount, 0, nPos, nPos, szText, nTextLen);
+		}
+
+		if (nCount == 0)
+		{
+			if (bMatched || nPos >= nTextLen)
+				break;
+			continue;							// Nothing can start here, try the next position
+		}
+
+		// Step every thread over this char
+		c = nPos < nTextLen ? (unsigned char)szText[nPos] : -1;
+		nNextCount = 0;
+
+		for (i=0; i<nCount; ++i)
+		{
+			nPC		= m_pnThreads[nCur][i];
+			pnCaps	= m_pnCaps[nCur] + i * m_nNumSlots;
+			lpInst	= &m_Code[nPC];
+
+			switch (lpInst->nOp)
+			{
+				case REGEXP_OP_CHAR:
+					if (c != lpInst->x)
+						continue;
+					break;
+
+				case REGEXP_OP_CHARI:
+					if (c < 0 || REGEXP_FOLD(c) != lpInst->x)
+						continue;
+					break;
+
+				case REGEXP_OP_ANY:
+					if (c < 0 || c == '\n')
+						continue;
+					break;
+
+				case REGEXP_OP_ANYNL:
+					if (c < 0)
+						continue;
+					break;
+
+				case REGEXP_OP_CLASS:
+					if (c < 0 || !(m_Classes[lpInst->x][c >> 3] & (1 << (c & 7))))
+						continue;
+					break;
+
+				default:						// MATCH - lower priority threads are cut off
+					memcpy(m_pnMatch, pnCaps, m_nNumSlots * sizeof(int));
+					bMatched = true;
+					nCount = i;
+					continue;
+			}
+
+			memcpy(m_pnCapWork, pnCaps, m_nNumSlots * sizeof(int));
+			nNextCount = AddThread(nNext, nNextCount, nPC + 1, nPos + 1, nPos + 1, szText, nTextLen);
+		}
+
+		nCur	= nNext;
+		nNext	= 1 - nCur;
+		nCount	= nNextCount;
+
+		if (nPos >= nTextLen)
+			break;
+	}
+
+	return bMatched;
+
+} // Find()
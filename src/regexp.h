@@ -40,8 +40,106 @@
 //
 // RegExp.h: interface for the CRegExp class.
 //
+// A pattern is compiled once into a small instruction program which is then
+// run by a Pike VM: every possible match is advanced in lock step, one text
+// character at a time, so matching is O(text length * program length) no
+// matter what the pattern is.  There is no backtracking and so no way for a
+// pattern to take exponential time.  The price is that backreferences inside
+// a pattern (\1 etc) are not supported.
+//
+// Supported syntax:
+//	.  ^  $  |  ()  (?:)  (?i)  (?m)  (?s)  (?i:...)
+//	*  +  ?  {n}  {n,}  {n,m}  (and the lazy versions *? +? ?? {n,m}?)
+//	[abc]  [^abc]  [a-z]  [[:alpha:]]  \d \D \w \W \s \S  \b \B \A \z \Z
+//	\t \n \r \f \v \a \e \xHH  \Q...\E  and \ followed by any other symbol
+//
 ///////////////////////////////////////////////////////////////////////////////
 
+
+// Limits
+#define REGEXP_MAXINSTS		10000				// Max size of a compiled program
+#define REGEXP_MAXGROUPS	64					// Max capturing groups
+#define REGEXP_MAXREPEAT	1000				// Max n or m in {n,m}
+
+
+// Structure for a single instruction
+typedef struct
+{
+	int				nOp;						// Opcode (REGEXP_OP_*)
+	int				x;							// Char, class index, jump target, save slot or assertion type
+	int				y;							// Second jump target (split)
+
+} RegExpInst;
+
+
+class CRegExp
+{
+public:
+	// Functions
+	CRegExp();									// Constructor
+	~CRegExp();									// Destructor
+
+	bool		Compile(const char *szPattern);	// Compile a pattern (false on error, see ErrorOffset())
+	bool		Find(const char *szText, int nTextLen, int nStart);	// Find the first match at or after nStart
+
+	// Properties
+	const char *	Pattern(void) const { return m_szPattern; }		// The source pattern
+	int			ErrorOffset(void) const { return m_nErrOffset; }	// Where in the pattern Compile() failed
+	int			NumGroups(void) const { return m_nNumGroups; }		// Number of capturing groups
+	int			GroupStart(int n) const { return m_pnMatch[n*2]; }	// Start of group n (0=whole match) or -1
+	int			GroupEnd(int n) const { return m_pnMatch[n*2+1]; }	// End of group n (0=whole match) or -1
+
+private:
+	// Variables
+	char			*m_szPattern;				// Copy of the source pattern
+	RegExpInst		*m_Code;					// The compiled program
+	int				m_nCode;					// Number of instructions used
+	int				m_nCodeAlloc;				// Number of instructions allocated
+	unsigned char	(*m_Classes)[32];			// Character class bitmaps
+	int				m_nClasses;					// Number of classes used
+	int				m_nClassesAlloc;			// Number of classes allocated
+	int				m_nNumGroups;				// Number of capturing groups
+	int				m_nNumSlots;				// Capture slots per thread ((groups+1) * 2)
+	int				*m_pnMatch;					// Capture slots of the last match
+
+	// Compile state
+	const char		*m_szPos;					// Current parse position
+	int				m_nFlags;					// Current (?ims) flags
+	int				m_nErrOffset;				// Error position (or -1)
+	int				m_nFirstChar;				// Literal every match must start with (or -1)
+	int				m_nMaxThreads;				// Consuming instructions (max threads per char)
+
+	// Matching workspace (sized when compiled)
+	int				*m_pnThreads[2];			// Thread program counters for the current/next char
+	int				*m_pnCaps[2];				// Thread capture slots for the current/next char
+	int				*m_pnOnList;				// Position stamp per instruction (dedups threads)
+	int				*m_pnStack;					// Work stack for AddThread()
+	int				*m_pnCapWork;				// Capture slots of the thread being added
+
+	// Functions
+	void		Reset(void);
+	bool		Error(void);
+	int			Emit(int nOp, int x = 0, int y = 0);
+	bool		Insert(int nAt, int nCount);
+	bool		CopyCode(int nFrom, int nLen);
+	int			NewClass(void);
+	bool		ParseAlt(void);
+	bool		ParseConcat(void);
+	bool		ParseRepeat(void);
+	bool		ParseAtom(void);
+	bool		ParseGroup(void);
+	bool		ParseClass(void);
+	bool		ParseEscape(int &nChar);
+	bool		ParseCount(int &nMin, int &nMax);
+	bool		Repeat(int nStart, int nMin, int nMax, bool bGreedy);
+	void		EmitChar(int nChar);
+	void		ClassAdd(int nClass, int nFrom, int nTo);
+	void		ClassAddType(int nClass, int nType, bool bNegate);
+
+	bool		Assert(int nType, const char *szText, int nTextLen, int nPos) const;
+	int			AddThread(int nList, int nCount, int nPC, int nPos, int nStamp, const char *szText, int nTextLen);
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #endif	// __REGEXP_H
@@ -99,12 +99,23 @@ AutoIt_Script::AutoIt_Script()
 	m_bWinQuitProcessed			= false;
 
 	m_nCurrentOperation			= AUT_RUN;		// Current operation is to run the script
+	m_nBatchLines				= AUT_BATCHLINES;
+	m_nBatchLinesLeft			= 0;			// Check messages etc. before the first line
+	m_tBatchStarted				= 0;
 	m_nExecuteRecursionLevel	= 0;			// Reset our recursion tracker for the Execute() function
+	m_pStackLimit				= NULL;			// Set when Execute() first runs
+	m_CallFrames				= NULL;			// No saved call state yet
+	m_nCallFramesAlloc			= 0;
+	m_nCallDepth				= 0;
 
 	m_hWndTip					= NULL;			// ToolTip window
 
 	m_nErrorLine				= 0;			// Set last line read as 0 by default (application.cpp may try reading it)
 	m_nNumParams				= 0;			// Number of UDF parameters initially 0
+	m_BlockJumps				= NULL;			// Block jump table is built in InitScript()
+	m_vScriptTokens				= NULL;			// Script tokens are lexed in InitScript()
+	m_ExprCode					= NULL;			// Expressions are compiled on first use (see InitScript())
+	m_nExprCodeLines			= 0;
 	
 	m_nCoordMouseMode			= AUT_COORDMODE_SCREEN;		// Mouse functions use screen coords by default
 	m_nCoordPixelMode			= AUT_COORDMODE_SCREEN;		// Pixel functions use screen coords by default
@@ -116,6 +127,10 @@ AutoIt_Script::AutoIt_Script()
 	m_bColorModeBGR				= false;		// Use RGB colours by default
 	m_sOnExitFunc				= "OnAutoItExit";
 	m_bFtpBinaryMode			= true;			// Use binary ftp transfers by default
+	m_szConsoleBuf				= NULL;			// ConsoleWrite() is unbuffered by default
+	m_nConsoleBufSize			= 0;
+	m_nConsoleBufUsed			= 0;
+	m_tConsoleBufStarted		= 0;
 
 	m_WindowSearchHWND			= NULL;			// Last window found set to NULL
 	m_bDetectHiddenText			= false;		// Don't detect hidden text by default
@@ -143,10 +158,6 @@ AutoIt_Script::AutoIt_Script()
 	m_wszRunUser = m_wszRunDom = m_wszRunPwd = NULL;	// Strings are empty
 
 
-	// Make sure our lexer cache is set to empty defaults
-	for (i=0; i<AUT_LEXER_CACHESIZE; ++i)
-		m_LexerCache[i].nLineNum = -1;
-	
 	// Initialise file handles to NULL
 	m_nNumFileHandles = 0;						// Initalise file handle count
 	for (i=0; i<AUT_MAXOPENFILES; ++i)
@@ -161,6 +172,10 @@ AutoIt_Script::AutoIt_Script()
 		m_HotKeyDetails[i] = NULL;
 	m_nHotKeyQueuePos	= 0;
 
+	// Regular expression cache is empty
+	for (i=0; i<AUT_MAXREGEXPS; ++i)
+		m_RegExpCache[i] = NULL;
+
 	
 	// Proxy stuff
 	m_nHttpProxyMode = AUT_PROXY_REGISTRY;		// Use whatever IE defaults have been set to
@@ -199,6 +214,7 @@ AU3_FuncInfo funcList[] =
 	{"CHR", &AutoIt_Script::F_Chr, 1, 1},
 	{"CLIPGET", &AutoIt_Script::F_ClipGet, 0, 0},
 	{"CLIPPUT", &AutoIt_Script::F_ClipPut, 1, 1},
+	{"CONSOLEFLUSH", &AutoIt_Script::F_ConsoleFlush, 0, 0},
 	{"CONSOLEWRITE", &AutoIt_Script::F_ConsoleWrite, 1, 1},
 	{"CONTROLCLICK", &AutoIt_Script::F_ControlClick, 3, 5},
 	{"CONTROLCOMMAND", &AutoIt_Script::F_ControlCommand, 4, 5},
@@ -261,8 +277,9 @@ AU3_FuncInfo funcList[] =
 	{"FILEMOVE", &AutoIt_Script::F_FileMove, 2, 3},
 	{"FILEOPEN", &AutoIt_Script::F_FileOpen, 2, 2},
 	{"FILEOPENDIALOG", &AutoIt_Script::F_FileOpenDialog, 3, 5},
-	{"FILEREAD", &AutoIt_Script::F_FileRead, 2, 2},
+	{"FILEREAD", &AutoIt_Script::F_FileRead, 1, 2},
 	{"FILEREADLINE", &AutoIt_Script::F_FileReadLine, 1, 2},
+	{"FILEREADTOARRAY", &AutoIt_Script::F_FileReadToArray, 1, 1},
 	{"FILERECYCLE", &AutoIt_Script::F_FileRecycle, 1, 1},
 	{"FILERECYCLEEMPTY", &AutoIt_Script::F_FileRecycleEmpty, 0, 1},
 	{"FILESAVEDIALOG", &AutoIt_Script::F_FileSaveDialog, 3, 5},
@@ -422,8 +439,8 @@ AU3_FuncInfo funcList[] =
 	{"STRINGLEN", &AutoIt_Script::F_StringLen, 1, 1},
 	{"STRINGLOWER", &AutoIt_Script::F_StringLower, 1, 1},
 	{"STRINGMID", &AutoIt_Script::F_StringMid, 2, 3},
-//	{"STRINGREGEXP", &AutoIt_Script::F_StringRegExp, 2, 3},
-//	{"STRINGREGEXPREPLACE", &AutoIt_Script::F_StringRegExpReplace, 3, 4},
+	{"STRINGREGEXP", &AutoIt_Script::F_StringRegExp, 2, 3},
+	{"STRINGREGEXPREPLACE", &AutoIt_Script::F_StringRegExpReplace, 3, 4},
 	{"STRINGREPLACE", &AutoIt_Script::F_StringReplace, 3, 5},
 	{"STRINGRIGHT", &AutoIt_Script::F_StringRight, 2, 2},
 	{"STRINGSPLIT", &AutoIt_Script::F_StringSplit, 2, 3},
@@ -495,6 +512,18 @@ AU3_FuncInfo funcList[] =
 
 	}
 
+	// Build the perfect hash tables used by the lexer for keywords, functions and macros
+	const char **szNames = new const char *[K_MAX + m_nFuncListSize];
+	for (i=0; i<K_MAX; ++i)
+		szNames[i] = m_szKeywords[i];
+	for (i=0; i<m_nFuncListSize; ++i)
+		szNames[K_MAX + i] = m_FuncList[i].szName;
+
+	m_oKeywordFuncHash.build(szNames, K_MAX + m_nFuncListSize);
+	delete [] szNames;
+
+	Parser_InitMacros();
+
 } // AutoIt_Script()
 
 
@@ -508,6 +537,10 @@ AutoIt_Script::~AutoIt_Script()
 
 	// Free up any thing
 
+	// Write out any buffered console output
+	ConsoleFlush();
+	delete [] m_szConsoleBuf;
+
 	// RunAsSet stuff
 	delete [] m_wszRunUser;						// NULL if not used, which is OK
 	delete [] m_wszRunDom;
@@ -547,6 +580,7 @@ AutoIt_Script::~AutoIt_Script()
 		{
 			if (m_FileHandleDetails[i]->nType == AUT_FILEOPEN)
 			{
+				delete m_FileHandleDetails[i]->lpReader;
 				fclose(m_FileHandleDetails[i]->fptr);	// Close file
 			}
 			else
@@ -559,6 +593,15 @@ AutoIt_Script::~AutoIt_Script()
 		}
 	}
 
+	// Free the saved call state frames
+	for (i=0; i<m_nCallFramesAlloc; ++i)
+		delete m_CallFrames[i];
+	delete [] m_CallFrames;
+
+	// Free any cached regular expressions
+	for (i=0; i<AUT_MAXREGEXPS; ++i)
+		delete m_RegExpCache[i];
+
 	// Close any dll handles that script writer has not closed (naughty!)
 	for (i=0; i<AUT_MAXOPENFILES; ++i)
 	{
@@ -572,6 +615,10 @@ AutoIt_Script::~AutoIt_Script()
 
 	delete [] m_FuncList;							// Delete the entire list
 
+	Parser_FreeExprCode();							// Delete any compiled expressions
+	delete [] m_BlockJumps;							// Delete the block jump table (NULL if not built)
+	delete [] m_vScriptTokens;						// Delete the lexed script tokens (NULL if not built)
+
 }
 
 
@@ -624,7 +671,10 @@ void AutoIt_Script::FatalError(int iErr, int nCol)
 	strcat(szOutput, szText);
 
 	if (g_bStdOut)
+	{
+		ConsoleFlush();							// Keep the error after any earlier ConsoleWrite() output
 		printf("%s (%d) : ==> %s: \n%s \n%s\n",szInclude, nAutScriptLine, szText, szScriptLine, szOutput2 );
+	}
 	else
 		MessageBox(g_hWnd, szOutput, szTitle, MB_ICONSTOP | MB_OK | MB_SYSTEMMODAL | MB_SETFOREGROUND);
 
@@ -672,7 +722,10 @@ void AutoIt_Script::FatalError(int iErr, const char *szText2)
 	strcat(szOutput, szText2);
 
 	if (g_bStdOut)
+	{
+		ConsoleFlush();							// Keep the error after any earlier ConsoleWrite() output
 		printf("%s (%d) : ==> %s: \n%s \n%s\n",szInclude, nAutScriptLine, szText, szScriptLine, szText2);
+	}
 	else
 		MessageBox(g_hWnd, szOutput, szTitle, MB_ICONSTOP | MB_OK | MB_SYSTEMMODAL | MB_SETFOREGROUND);
 
@@ -712,6 +765,10 @@ const char * AutoIt_Script::FormatWinError(DWORD dwCode)
 
 AUT_RESULT AutoIt_Script::InitScript(char *szFile)
 {
+	// Convert every line into tokens (the only time the script is lexed)
+	if ( AUT_FAILED(Lexer_TokenizeScript()) )
+		return AUT_ERR;
+
 	// Check that the block structures are correct
 	if ( AUT_FAILED(Parser_VerifyBlockStructure()) )
 		return AUT_ERR;
@@ -728,6 +785,12 @@ AUT_RESULT AutoIt_Script::InitScript(char *szFile)
 	if ( AUT_FAILED(VerifyUserFuncCalls()) )
 		return AUT_ERR;
 
+	// Number the local variable slots of each user function
+	StoreUserFuncSlots();
+
+	// Prepare the compiled expression cache (expressions are compiled the first time they run)
+	Parser_InitExprCode();
+
 	// Make a note of the script filename (for @ScriptDir, etc)
 	char	szFileTemp[_MAX_PATH+1];
 	char	*szFilePart;
@@ -812,11 +875,20 @@ int	AutoIt_Script::ProcessMessages()
 AUT_RESULT AutoIt_Script::Execute(int nScriptLine)
 {
 	MSG			msg;
-	VectorToken	LineTokens;						// Vector (array) of tokens for a line of script
 	const char	*szScriptLine;
 
-	// Increase the recursion level of this function and check that we've not gone too far
-	if (m_nExecuteRecursionLevel >= AUT_MAXEXECUTERECURSE)
+	// On the first call work out how far down the stack we can safely recurse.  The
+	// whole stack is one reservation so its allocation base is the lowest address.
+	if (m_pStackLimit == NULL)
+	{
+		MEMORY_BASIC_INFORMATION	mbi;
+
+		VirtualQuery(&mbi, &mbi, sizeof(mbi));
+		m_pStackLimit = (char *)mbi.AllocationBase + AUT_STACKHEADROOM;
+	}
+
+	// Increase the recursion level of this function and check that there is enough stack left
+	if ((char *)&msg < m_pStackLimit)
 	{
 		FatalError(IDS_AUT_E_MAXRECURSE);
 		return AUT_ERR;
@@ -841,16 +913,36 @@ AUT_RESULT AutoIt_Script::Execute(int nScriptLine)
 	// Run our Execute() loop
 	while(m_bWinQuitProcessed == false && m_bUserFuncReturned == false)
 	{
-		// Run the windows message loop and handle quit conditions
-		ProcessMessages();
+		// While the script is just running, the message loop and delayed functions are only
+		// checked every m_nBatchLines lines or AUT_BATCHTIME ms (GetTickCount() is cheap) - or
+		// straight away if the main window has queued a hotkey/pause/exit
+		if (m_nCurrentOperation != AUT_RUN || g_bScriptEvent == true || --m_nBatchLinesLeft <= 0 ||
+			GetTickCount() - m_tBatchStarted >= AUT_BATCHTIME)
+		{
+			g_bScriptEvent		= false;
+			m_nBatchLinesLeft	= m_nBatchLines;
+			m_tBatchStarted		= GetTickCount();
 
-		// If script is in a quit state then don't execute any more code
-		if (m_nCurrentOperation == AUT_QUIT)
-			break;								// Exit while loop
+			// Send buffered ConsoleWrite() output if it has been held long enough, or
+			// if the script is about to wait/quit so that nothing sits in the buffer
+			if (m_nConsoleBufUsed && (m_nCurrentOperation != AUT_RUN ||
+				m_tBatchStarted - m_tConsoleBufStarted >= AUT_CONSOLEFLUSHTIME) )
+				ConsoleFlush();
 
-		// If we are waiting for something (winwait, sleep, paused, etc) then loop again
-		if (HandleDelayedFunctions() == true)
-			continue;
+			// Run the windows message loop and handle quit conditions
+			ProcessMessages();
+
+			// If script is in a quit state then don't execute any more code
+			if (m_nCurrentOperation == AUT_QUIT)
+				break;							// Exit while loop
+
+			// If we are waiting for something (winwait, sleep, paused, etc) then loop again
+			if (HandleDelayedFunctions() == true)
+			{
+				m_nBatchLinesLeft = 0;			// Check again before running a line
+				continue;
+			}
+		}
 
 		// Get the next line, or quit if none left
 		m_nErrorLine = nScriptLine;				// Keep track for errors
@@ -861,11 +953,8 @@ AUT_RESULT AutoIt_Script::Execute(int nScriptLine)
 			continue;							// Back to the start of the while loop
 		}
 
-		// Do the lexing (convert the line into tokens) - stored in LineTokens
-		Lexer(nScriptLine-1, szScriptLine, LineTokens);				// No need to check for errors, already lexed in InitScript()
-
-		// Parse and execute the line
-		Parser(LineTokens, nScriptLine);
+		// Parse and execute the line (tokens were lexed in InitScript() so no need to lex or check for errors)
+		Parser(m_vScriptTokens[nScriptLine-1], nScriptLine);
 
 	} // End While
 
@@ -923,6 +1012,9 @@ AUT_RESULT AutoIt_Script::Execute(int nScriptLine)
 		m_nCurrentOperation = AUT_QUIT;
 	}
 
+	// Write out any buffered console output (including that from the OnExit function)
+	ConsoleFlush();
+
 
 	// Destroy our main window (Calls WM_DESTROY on our and any child windows)
 	DestroyWindow(g_hWnd);
@@ -952,10 +1044,10 @@ bool AutoIt_Script::HandleDelayedFunctions(void)
 	if (HandleHotKey() == true)
 		return true;
 
-	// If the script is paused, sleep then loop again
+	// If the script is paused, wait for a message (unpausing comes from the tray or a hotkey)
 	if (g_bScriptPaused == true)
 	{
-		Sleep(AUT_IDLE);					// Quick sleep to reduce CPU load
+		MsgWaitForMultipleObjects(0, NULL, FALSE, INFINITE, QS_ALLINPUT);
 		return true;
 	}
 
@@ -970,18 +1062,18 @@ bool AutoIt_Script::HandleDelayedFunctions(void)
 	// Check for RunWait commands to finish
 	if (m_nCurrentOperation == AUT_RUNWAIT)
 	{
-		DWORD dwexitcode;
-		GetExitCodeProcess(m_piRunProcess, &dwexitcode);
-
-		if (dwexitcode != STILL_ACTIVE)
+		if (WaitForSingleObject(m_piRunProcess, 0) == WAIT_OBJECT_0)
 		{
+			DWORD dwexitcode;
+			GetExitCodeProcess(m_piRunProcess, &dwexitcode);
+
 			CloseHandle(m_piRunProcess);	// Close handle
 			m_vUserRetVal = (int)dwexitcode;// Set exit code
 			m_bUserFuncReturned = true;		// Request exit from Execute()
 			m_nCurrentOperation = AUT_RUN;	// Continue script
 		}
 		else
-            Sleep(AUT_IDLE);				// Quick sleep to reduce CPU load
+			WaitForEvents(INFINITE, m_piRunProcess);	// Until it ends or something else needs doing
 
 		return true;						// Next loop
 	}
@@ -997,6 +1089,34 @@ bool AutoIt_Script::HandleDelayedFunctions(void)
 } // HandleDelayedFunctions()
 
 
+///////////////////////////////////////////////////////////////////////////////
+// WaitForEvents()
+//
+// Used by the delayed functions instead of polling with Sleep().  Blocks until
+// a window message arrives (hotkeys, GUI events and the tray all arrive as
+// messages), hObject (if given) is signalled, the adlib function is due or
+// dwTimeout ms have passed.  Returns the MsgWaitForMultipleObjects() result.
+///////////////////////////////////////////////////////////////////////////////
+
+DWORD AutoIt_Script::WaitForEvents(DWORD dwTimeout, HANDLE hObject)
+{
+	// Don't sleep through the next adlib
+	if (m_bAdlibEnabled == true && m_bAdlibInProgress == false)
+	{
+		DWORD	dwAdlib = Util_TimeLeft(m_tAdlibTimerStarted, m_nAdlibTimeout);
+
+		if (dwAdlib < dwTimeout)
+			dwTimeout = dwAdlib;
+	}
+
+	if (hObject)
+		return MsgWaitForMultipleObjects(1, &hObject, FALSE, dwTimeout, QS_ALLINPUT);
+	else
+		return MsgWaitForMultipleObjects(0, NULL, FALSE, dwTimeout, QS_ALLINPUT);
+
+} // WaitForEvents()
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // FunctionExecute()
 ///////////////////////////////////////////////////////////////////////////////
@@ -1028,7 +1148,6 @@ AUT_RESULT AutoIt_Script::StoreUserFuncs(void)
 {
 	uint			ivPos;						// Position in the vector
 	AString			sFuncName;					// Temp function name
-	VectorToken		LineTokens;					// Vector (array) of tokens for a line of script
 	int				nScriptLine = 1;			// 1 = first line
 	const char		*szScriptLine;
 
@@ -1037,8 +1156,7 @@ AUT_RESULT AutoIt_Script::StoreUserFuncs(void)
 	{
 		m_nErrorLine = nScriptLine - 1;			// Keep track for errors
 
-		if ( AUT_FAILED( Lexer(nScriptLine-1, szScriptLine, LineTokens) ) )
-			return AUT_ERR;						// Bad line
+		VectorToken	&LineTokens = m_vScriptTokens[nScriptLine-1];	// Tokens for this line (lexed in InitScript)
 
 		ivPos = 0;
 
@@ -1080,10 +1198,6 @@ AUT_RESULT AutoIt_Script::StoreUserFuncs(void)
 
 	} // End While()
 
-	// Finalize the list of user functions which sorts the list for speed searching. 
-	// NO USER MORE FUNCTIONS CAN BE ADDED AFTER THIS
-	m_oUserFuncList.createindex();
-
 	return AUT_OK;
 
 } // StoreUserFuncs()
@@ -1099,6 +1213,8 @@ AUT_RESULT AutoIt_Script::StoreUserFuncs(void)
 AUT_RESULT AutoIt_Script::StoreUserFuncs2(VectorToken &LineTokens, uint &ivPos, const AString &sFuncName, int &nScriptLine)
 {
 	UserFuncDetails	tFuncDetails;
+	uint			ivParamsStart = ivPos;		// Where the parameter declarations start
+	int				i;
 
 	// Tokens should be: [ByRef] $variable , ... [ByRef] $variable , ... )
 
@@ -1228,6 +1344,36 @@ AUT_RESULT AutoIt_Script::StoreUserFuncs2(VectorToken &LineTokens, uint &ivPos,
 	if (nNumParamsMin == -1)
 		nNumParamsMin = nNumParams;		// no optional parameters
 	tFuncDetails.nNumParamsMin = nNumParamsMin;
+	tFuncDetails.nNumSlots = 0;					// Filled in by StoreUserFuncSlots()
+	tFuncDetails.pnSlotIDs = NULL;
+
+	// Store the parsed parameters so that calls don't have to walk the declaration (the
+	// syntax was checked above so the tokens can be trusted)
+	tFuncDetails.lpParams = nNumParams ? new UserFuncParam[nNumParams] : NULL;
+
+	ivPos = ivParamsStart;
+	for (i=0; i<nNumParams; ++i)
+	{
+		UserFuncParam	&uParam = tFuncDetails.lpParams[i];
+
+		uParam.bByRef = (LineTokens[ivPos].m_nType == TOK_KEYWORD);
+		if (uParam.bByRef)
+			++ivPos;							// Skip ByRef
+
+		uParam.ivVar = ivPos++;					// $var
+		uParam.ivDefault = 0;
+
+		if (LineTokens[ivPos].m_nType == TOK_EQUAL)
+		{
+			uParam.ivDefault = ++ivPos;			// [+ -] literal
+			if (LineTokens[ivPos].m_nType == TOK_PLUS || LineTokens[ivPos].m_nType == TOK_MINUS)
+				++ivPos;
+			++ivPos;
+		}
+
+		++ivPos;								// Skip , or )
+	}
+
 	m_oUserFuncList.add(tFuncDetails);
 
 	return AUT_OK;
@@ -1244,7 +1390,6 @@ AUT_RESULT AutoIt_Script::StoreUserFuncs2(VectorToken &LineTokens, uint &ivPos,
 
 AUT_RESULT AutoIt_Script::StoreUserFuncsFindEnd(int &nScriptLine)
 {
-	VectorToken	LineTokens;						// Vector (array) of tokens for a line of script
 	uint		ivPos;
 	const char	*szScriptLine;
 
@@ -1254,8 +1399,7 @@ AUT_RESULT AutoIt_Script::StoreUserFuncsFindEnd(int &nScriptLine)
 		++nScriptLine;
 		m_nErrorLine = nScriptLine - 1;			// Keep track for errors
 
-		if ( AUT_FAILED( Lexer(nScriptLine-1, szScriptLine, LineTokens) ) )
-			return AUT_ERR;						// Bad line
+		VectorToken	&LineTokens = m_vScriptTokens[nScriptLine-1];	// Tokens for this line (lexed in InitScript)
 
 		ivPos = 0;
 
@@ -1285,7 +1429,6 @@ AUT_RESULT AutoIt_Script::StoreUserFuncsFindEnd(int &nScriptLine)
 AUT_RESULT AutoIt_Script::VerifyUserFuncCalls(void)
 {
 	uint			ivPos;						// Position in the vector
-	VectorToken		LineTokens;					// Vector (array) of tokens for a line of script
 	int				nScriptLine = 1;			// 1 = first line
 	const char		*szScriptLine;
 	int				nLineNum, nNumParams, nNumParamsMin, nEndLineNum;
@@ -1295,7 +1438,7 @@ AUT_RESULT AutoIt_Script::VerifyUserFuncCalls(void)
 	{
 		m_nErrorLine = nScriptLine - 1;			// Keep track for errors
 		
-		Lexer(nScriptLine-1, szScriptLine, LineTokens);		// No need to test for errors, already done in StoreUserFuncs()
+		VectorToken	&LineTokens = m_vScriptTokens[nScriptLine-1];	// Tokens for this line (lexed in InitScript)
 
 		ivPos = 0;
 
@@ -1320,6 +1463,96 @@ AUT_RESULT AutoIt_Script::VerifyUserFuncCalls(void)
 } // VerifyUserFuncCalls()
 
 
+///////////////////////////////////////////////////////////////////////////////
+// StoreUserFuncSlots()
+//
+// Each distinct $variable used between a Func and its EndFunc is given a
+// slot number in that function's frame.  The slot is stored in the tokens
+// and the slot -> variable ID table in the user function details so that
+// ScopeIncrease() can create a flat frame for each call.
+//
+// Scoping is still decided at run time (Global/Local/Dim), an empty local
+// slot simply falls through to the global of the same ID.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+void AutoIt_Script::StoreUserFuncSlots(void)
+{
+	int				nScriptLine = 1;			// 1 = first line
+	int				nLine, nID, nSlot;
+	uint			ivPos;
+	int				nNumIDs = g_oVarTable.GetNumVarIDs();
+	int				*pnSlotOfID;				// Variable ID -> slot for the current function
+	int				*pnSlotIDs;					// Slot -> variable ID for the current function
+	int				nNumSlots;
+	UserFuncDetails	*lpDetails;
+
+	if (nNumIDs == 0)
+		return;
+
+	pnSlotOfID	= new int[nNumIDs];
+	pnSlotIDs	= new int[nNumIDs];
+
+	for (nID = 0; nID < nNumIDs; ++nID)
+		pnSlotOfID[nID] = -1;
+
+	while ( g_oScriptFile.GetLine(nScriptLine) != NULL )
+	{
+		VectorToken	&FuncTokens = m_vScriptTokens[nScriptLine];
+
+		if ( !(FuncTokens[0].m_nType == TOK_KEYWORD && FuncTokens[0].nValue == K_FUNC) )
+		{
+			++nScriptLine;
+			continue;
+		}
+
+		// Func line was verified by StoreUserFuncs()
+		lpDetails = m_oUserFuncList.find(FuncTokens[1].szValue);
+		nNumSlots = 0;
+
+		for (nLine = lpDetails->nFuncLineNum; nLine <= lpDetails->nEndFuncLineNum; ++nLine)
+		{
+			VectorToken	&LineTokens = m_vScriptTokens[nLine];
+
+			for (ivPos = 0; LineTokens[ivPos].m_nType != TOK_END; ++ivPos)
+			{
+				if (LineTokens[ivPos].m_nType != TOK_VARIABLE)
+					continue;
+
+				nID = LineTokens[ivPos].m_nVarID;
+				nSlot = pnSlotOfID[nID];
+				if (nSlot == -1)
+				{
+					nSlot = nNumSlots++;
+					pnSlotOfID[nID] = nSlot;
+					pnSlotIDs[nSlot] = nID;
+				}
+
+				LineTokens[ivPos].m_nVarSlot = nSlot;
+			}
+		}
+
+		// Store the slot table and reset the ID map for the next function
+		lpDetails->nNumSlots = nNumSlots;
+		if (nNumSlots)
+		{
+			lpDetails->pnSlotIDs = new int[nNumSlots];
+			for (nSlot = 0; nSlot < nNumSlots; ++nSlot)
+			{
+				lpDetails->pnSlotIDs[nSlot] = pnSlotIDs[nSlot];
+				pnSlotOfID[pnSlotIDs[nSlot]] = -1;
+			}
+		}
+
+		nScriptLine = lpDetails->nEndFuncLineNum + 1;
+	}
+
+	delete [] pnSlotOfID;
+	delete [] pnSlotIDs;
+
+} // StoreUserFuncSlots()
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // StorePluginFuncs()
 //
@@ -1363,20 +1596,11 @@ bool AutoIt_Script::HandleAdlib(void)
 
 	// Check the timer - we only run the adlib every so often as it is a strain on the
 	// CPU otherwise
-	DWORD	dwDiff;
-	DWORD	dwCur = timeGetTime();
-
-	if (dwCur < m_tAdlibTimerStarted)
-		dwDiff = (UINT_MAX - m_tAdlibTimerStarted) + dwCur; // timer wraps at 2^32
-	else
-		dwDiff = dwCur - m_tAdlibTimerStarted;
-
-	// Timer elapsed?
-	if (dwDiff < m_nAdlibTimeout)
+	if (Util_TimeLeft(m_tAdlibTimerStarted, m_nAdlibTimeout) != 0)
 		return false;							// Not time yet
 
 	// Reset the timer
-	m_tAdlibTimerStarted = dwCur;
+	m_tAdlibTimerStarted = timeGetTime();
 
 
 	// Get the details of the function (we should have previously checked that it
@@ -1536,49 +1760,71 @@ bool AutoIt_Script::HandleGuiEvent(void)
 // SaveExecute()
 //
 // Saves the current state of the script and then performs a recursive
-// call to Execute() and then restores state. Not all the items saved in state
-// are required for every usage but the function is used from many parts of the
-// code and needs to be safe for all of them.
+// call to Execute() and then restores state.  The state is kept in a frame
+// from m_CallFrames (frames are reused so nothing is allocated per call).
 // The current scope can optionally be raised/lowered too.
+//
+// The win/control/process search values are always set by a search before
+// they are read so they only need saving when the call interrupts the script
+// (adlib/hotkey/gui event) as it may be part way through a wait.  They are
+// swapped rather than copied.  @error and @extended are also only restored
+// for interrupts.
+//
 // This function is used by UserFunction calling, Adlib, Hotkey, Call
 ///////////////////////////////////////////////////////////////////////////////
 
-void AutoIt_Script::SaveExecute(int nScriptLine, bool bRaiseScope, bool bRestoreErrorCode)
+void AutoIt_Script::SaveExecute(int nScriptLine, bool bRaiseScope, bool bInterrupt)
 {
-	// Saved state vars - Win related
-	Variant			vWindowSearchTitle;			// Title/text used for winwait commands
-	vWindowSearchTitle		= m_vWindowSearchTitle;
+	ExecuteFrame	*lpFrame;
+	int				i;
 
-	Variant			vWindowSearchText;			// Title/text used for winwait commands
-	vWindowSearchText		= m_vWindowSearchText;
+	// Get the next frame
+	if (m_nCallDepth == m_nCallFramesAlloc)
+	{
+		int				nAlloc = m_nCallFramesAlloc ? m_nCallFramesAlloc * 2 : 64;
+		ExecuteFrame	**lpTemp = new ExecuteFrame *[nAlloc];
+
+		for (i=0; i<m_nCallFramesAlloc; ++i)
+			lpTemp[i] = m_CallFrames[i];
+		for (; i<nAlloc; ++i)
+			lpTemp[i] = NULL;
 
-	DWORD			nWinWaitTimeout		= m_nWinWaitTimeout;	// Time (ms) left before timeout (0=no timeout)
-	HWND			WindowSearchHWND	= m_WindowSearchHWND;	// Last window searched for
-	DWORD			tWinTimerStarted	= m_tWinTimerStarted;	// Time in millis that timer was started
+		delete [] m_CallFrames;
+		m_CallFrames		= lpTemp;
+		m_nCallFramesAlloc	= nAlloc;
+	}
 
-	// Saved state vars - Control related
-	Variant			vControlSearchValue;						// The ID, classname or text to search for 
-	vControlSearchValue		= m_vControlSearchValue;
-	HWND			ControlSearchHWND = m_ControlSearchHWND;	// Contains HWND of a successful control search
+	if (m_CallFrames[m_nCallDepth] == NULL)
+		m_CallFrames[m_nCallDepth] = new ExecuteFrame;
 
-	// Process related vars
-	AString			sProcessSearchTitle		= m_sProcessSearchTitle;	// Name of process to wait for
-	DWORD			nProcessWaitTimeout		= m_nProcessWaitTimeout;	// Time (ms) left before timeout (0=no timeout)
-	DWORD			tProcessTimerStarted	= m_tProcessTimerStarted;	// Time in millis that timer was started
+	lpFrame = m_CallFrames[m_nCallDepth++];
 
-	// Function call related
-	int				nNumParams = m_nNumParams;	// Number of parameters passed to a UDF
+	// Save state
+	lpFrame->nErrorLine				= m_nErrorLine;
+	lpFrame->nNumParams				= m_nNumParams;
+	lpFrame->WindowSearchHWND		= m_WindowSearchHWND;
+	lpFrame->ControlSearchHWND		= m_ControlSearchHWND;
+	lpFrame->nWinWaitTimeout		= m_nWinWaitTimeout;
+	lpFrame->tWinTimerStarted		= m_tWinTimerStarted;
+	lpFrame->nProcessWaitTimeout	= m_nProcessWaitTimeout;
+	lpFrame->tProcessTimerStarted	= m_tProcessTimerStarted;
+	lpFrame->hRunProcess			= m_piRunProcess;
 
-	// Main vars
-	int				nErrorLine		= m_nErrorLine;			// Line number used to generate error messages
-	int				nFuncErrorCode	= m_nFuncErrorCode;		// Extended error code
-	int				nFuncExtCode	= m_nFuncExtCode;		// Extended code
+	if (bInterrupt)
+	{
+		lpFrame->nFuncErrorCode		= m_nFuncErrorCode;
+		lpFrame->nFuncExtCode		= m_nFuncExtCode;
+		lpFrame->sProcessSearchTitle = m_sProcessSearchTitle;
+		lpFrame->vWindowSearchTitle.Swap(m_vWindowSearchTitle);
+		lpFrame->vWindowSearchText.Swap(m_vWindowSearchText);
+		lpFrame->vControlSearchValue.Swap(m_vControlSearchValue);
+	}
 
 	// We also need to keep track of how many statements (if, while, etc)
 	// we have on the go just in case the user function is naughty (return function in the
 	// middle of a loop) and leaves the statement stacks in an incorrect state - we will
 	// have to correct this after Execute() returns
-	uint	nStackSize		= m_StatementStack.size();
+	lpFrame->nStackSize = m_StatementStack.size();
 
 
 	// Continue execution with the user function (using recursive call of Execute() )
@@ -1594,32 +1840,32 @@ void AutoIt_Script::SaveExecute(int nScriptLine, bool bRaiseScope, bool bRestore
 
 	// Make sure the statement stacks are the same as before the user function was called, 
 	// if not we fix them
-	while (nStackSize < m_StatementStack.size())
+	while (lpFrame->nStackSize < m_StatementStack.size())
 		m_StatementStack.pop();
 
 
 	// Restore "state"
-	m_vWindowSearchTitle	= vWindowSearchTitle;
-	m_vWindowSearchText		= vWindowSearchText;
-	m_nWinWaitTimeout		= nWinWaitTimeout;
-	m_WindowSearchHWND		= WindowSearchHWND;
-	m_tWinTimerStarted		= tWinTimerStarted;
-
-	m_vControlSearchValue	= vControlSearchValue;
-	m_ControlSearchHWND		= ControlSearchHWND;
-
-	m_sProcessSearchTitle	= sProcessSearchTitle;
-	m_nProcessWaitTimeout	= nProcessWaitTimeout;
-	m_tProcessTimerStarted	= tProcessTimerStarted;
-	m_nNumParams			= nNumParams;
-	m_nErrorLine			= nErrorLine;
-
-	// Only restore the @error code in certain situations (adlib/hotkey)
-	if (bRestoreErrorCode)
+	m_nErrorLine			= lpFrame->nErrorLine;
+	m_nNumParams			= lpFrame->nNumParams;
+	m_WindowSearchHWND		= lpFrame->WindowSearchHWND;
+	m_ControlSearchHWND		= lpFrame->ControlSearchHWND;
+	m_nWinWaitTimeout		= lpFrame->nWinWaitTimeout;
+	m_tWinTimerStarted		= lpFrame->tWinTimerStarted;
+	m_nProcessWaitTimeout	= lpFrame->nProcessWaitTimeout;
+	m_tProcessTimerStarted	= lpFrame->tProcessTimerStarted;
+	m_piRunProcess			= lpFrame->hRunProcess;
+
+	if (bInterrupt)
 	{
-		m_nFuncErrorCode	= nFuncErrorCode;
-		m_nFuncExtCode		= nFuncExtCode;
+		m_nFuncErrorCode		= lpFrame->nFuncErrorCode;
+		m_nFuncExtCode			= lpFrame->nFuncExtCode;
+		m_sProcessSearchTitle	= lpFrame->sProcessSearchTitle;
+		m_vWindowSearchTitle.Swap(lpFrame->vWindowSearchTitle);
+		m_vWindowSearchText.Swap(lpFrame->vWindowSearchText);
+		m_vControlSearchValue.Swap(lpFrame->vControlSearchValue);
 	}
 
+	--m_nCallDepth;
+
 } // SaveExecute()
 
@@ -60,11 +60,14 @@
 #include "stack_statement_datatype.h"
 #include "stack_int_datatype.h"
 #include "stack_variant_datatype.h"
+#include "bytecode_datatype.h"
 #include "variabletable.h"
 #include "os_version.h"
 #include "sendkeys.h"
 #include "userfunction_list.h"
 #include "regexp.h"
+#include "name_hash.h"
+#include "line_reader.h"
 
 
 // Possible states of the script
@@ -194,6 +197,7 @@ typedef struct
 	// File Open
 	FILE		*fptr;							// File handle
 	int			nMode;							// Mode the file was opened in (0=read, 1=write)
+	LineReader	*lpReader;						// Buffered reader (read mode only, otherwise NULL)
 
 	// File Find
 	HANDLE		hFind;							// Find handle
@@ -212,6 +216,32 @@ typedef struct
 } HotKeyDetails;
 
 
+// Structure for the state saved over a user function call (see SaveExecute())
+typedef struct
+{
+	// Always saved
+	int			nErrorLine;						// Line number used to generate error messages
+	int			nNumParams;						// Number of parameters passed to a UDF
+	uint		nStackSize;						// Statement stack size before the call
+	HWND		WindowSearchHWND;				// Last window searched for
+	HWND		ControlSearchHWND;				// Last control searched for
+	DWORD		nWinWaitTimeout;				// Wait timeouts and timers
+	DWORD		tWinTimerStarted;
+	DWORD		nProcessWaitTimeout;
+	DWORD		tProcessTimerStarted;
+	HANDLE		hRunProcess;					// Process of a pending runwait
+
+	// Only saved when the call interrupts the script (adlib/hotkey/gui event)
+	int			nFuncErrorCode;					// @error
+	int			nFuncExtCode;					// @extended
+	Variant		vWindowSearchTitle;				// Title/text of a pending winwait
+	Variant		vWindowSearchText;
+	Variant		vControlSearchValue;			// The ID, classname or text to search for
+	AString		sProcessSearchTitle;			// Name of a pending processwait
+
+} ExecuteFrame;
+
+
 // Regular Expressions info
 #define AUT_MAXREGEXPS		8					// Size of regular expression cache
 
@@ -247,16 +277,14 @@ typedef struct _PluginFuncs
 #define AUT_PROXY_PROXY		2
 
 
-// Lexer caching
-// Assuming an average of 7 tokens per line at 256 bytes per line
-// 256 lines of buffer = 64KB.
-#define AUT_LEXER_CACHESIZE	256					// Must be power of 2
-#define AUT_LEXER_CACHEMASK	255					// size - 1
+// Block jump table (one entry per script line, built by Parser_VerifyBlockStructure)
+// nNext:	If/ElseIf -> next ElseIf/Else/EndIf, Select/Case -> next Case/EndSelect
+// nEnd:	If -> EndIf, While -> Wend, Do -> Until, For -> Next, Select -> EndSelect
 typedef struct
 {
-	int			nLineNum;						// Line cached here (or -1)
-	VectorToken	vLine;							// Cached line of tokens
-} LexerCache;
+	int			nNext;							// Next linked line in the block (0=none)
+	int			nEnd;							// Line that closes the block (0=none)
+} BlockJump;
 
 
 // InetGet handles
@@ -309,8 +337,15 @@ private:
 	HWND			m_hWndTip;					// ToolTip window
 
 	int				m_nExecuteRecursionLevel;	// Keeps track of the recursive calls of Execute()
+	char			*m_pStackLimit;				// Execute() won't recurse with the stack below this
+	ExecuteFrame	**m_CallFrames;				// Saved state for each nested SaveExecute() (reused)
+	int				m_nCallFramesAlloc;			// Number of entries in m_CallFrames
+	int				m_nCallDepth;				// Number of frames in use
 	int				m_nErrorLine;				// Line number used to generate error messages
 	int				m_nCurrentOperation;		// The current state of the script (RUN, WAIT, SLEEP, etc)
+	int				m_nBatchLines;				// Max lines run between message/hotkey/adlib checks (BatchLines option)
+	int				m_nBatchLinesLeft;			// Lines left before the next check
+	DWORD			m_tBatchStarted;			// Time in millis of the last check
 	bool			m_bWinQuitProcessed;		// True when windows WM_QUIT message has been processed
 
 	// Options (AutoItSetOption)
@@ -327,6 +362,10 @@ private:
 	bool			m_bColorModeBGR;			// True if using the old BGR (rather than RGB) colour mode
 	AString			m_sOnExitFunc;				// Name of our OnExit function
 	bool			m_bFtpBinaryMode;			// True if binary mode ftp is required
+	char			*m_szConsoleBuf;			// Buffered ConsoleWrite() output (NULL = unbuffered)
+	int				m_nConsoleBufSize;			// Size of m_szConsoleBuf (ConsoleBuffer option)
+	int				m_nConsoleBufUsed;			// Bytes waiting in m_szConsoleBuf
+	DWORD			m_tConsoleBufStarted;		// Time in millis the oldest waiting output was written
 
 	// Proxy Settings
 	int				m_nHttpProxyMode;
@@ -356,6 +395,7 @@ private:
 
 	// Statement stacks
 	StackStatement	m_StatementStack;			// Stack for tracking If/Func/Select/Loop statements
+	BlockJump		*m_BlockJumps;				// Partner lines for each block statement (indexed by line)
 
 
 	// File variables
@@ -369,16 +409,23 @@ private:
 	HotKeyDetails	*m_HotKeyDetails[AUT_MAXHOTKEYS];	// Array for tracking hotkey details
 	int				m_nHotKeyQueuePos;					// Position in the global hotkey queue
 
+	// Regular expressions
+	CRegExp			*m_RegExpCache[AUT_MAXREGEXPS];		// Compiled patterns (most recently used first)
+
 
 	// Lexing and parsing vars
-#ifdef AUT_CONFIG_LEXERCACHE
-	LexerCache		m_LexerCache[AUT_LEXER_CACHESIZE];
-#endif
+	VectorToken		*m_vScriptTokens;			// Pre-lexed tokens for each script line (indexed by line)
+	ByteCode		**m_ExprCode;				// Compiled expressions for each script line (indexed by line)
+	int				m_nExprCodeLines;			// Number of lines in m_ExprCode
 	static char		m_PrecOpRules[OPR_MAXOPR][OPR_MAXOPR];	// Table for precedence rules
+	StackInt		m_ExprOpStack;				// Operator stack shared by all expression evaluations
+	StackVariant	m_ExprValStack;				// Value stack shared by all expression evaluations
 	static char		*m_szKeywords[];			// Valid keywords
 	static char		*m_szMacros[];				// Valid functions
 	AU3_FuncInfo	*m_FuncList;				// List of functions and details for each
 	int				m_nFuncListSize;			// Number of functions
+	NameHash		m_oKeywordFuncHash;			// Perfect hash of keywords (0 to K_MAX-1) then functions
+	NameHash		m_oMacroHash;				// Perfect hash of macro names
 
 	// Window related vars
 	Variant			m_vWindowSearchTitle;		// Title/text used for win searches
@@ -410,6 +457,7 @@ private:
 	DWORD			m_nProcessWaitTimeout;		// Time (ms) left before timeout (0=no timeout)
 	DWORD			m_tProcessTimerStarted;		// Time in millis that timer was started
 	HANDLE			m_piRunProcess;				// Used in RunWait command
+	DWORD			m_tWaitLastPoll;			// Time in millis that a winwait/processwait condition was last checked
 
 	bool			m_bRunAsSet;				// Flag if we want to use RunAs user/password in the Run function
 	DWORD			m_dwRunAsLogonFlags;		// RunAs logon flags
@@ -434,7 +482,7 @@ private:
 
 
 	// Functions
-	void		SaveExecute(int nScriptLine, bool bRaiseScope, bool bRestoreErrorCode);		// Save state and then Execute()
+	void		SaveExecute(int nScriptLine, bool bRaiseScope, bool bInterrupt);		// Save state and then Execute()
 	void		FatalError(int iErr, int nCol = -1);				// Output an error and signal quit (String resource errors)
 	void		FatalError(int iErr, const char *szText2);			// Output an error and signal quit (passed text errors)
 	const char * FormatWinError(DWORD dwCode = 0xffffffff);			// Gets the string output for a Windows error code
@@ -448,10 +496,12 @@ private:
 	AUT_RESULT	StoreUserFuncs2(VectorToken &LineTokens, uint &ivPos, const AString &sFuncName, int &nScriptLine);
 	AUT_RESULT	StoreUserFuncsFindEnd(int &nScriptLine);			// Finds a matching endfunc during the StoreUserFuncs functions
 	AUT_RESULT	VerifyUserFuncCalls(void);							// Ensures user function calls are defined
+	void		StoreUserFuncSlots(void);							// Numbers the local variable slots of user functions
 
 	AUT_RESULT	StorePluginFuncs(void);								// Get all plugin function details
 
 	bool		HandleDelayedFunctions(void);						// Handle delayed commands
+	DWORD		WaitForEvents(DWORD dwTimeout, HANDLE hObject = NULL);	// Block until a message, object, adlib or timeout
 	bool		HandleAdlib(void);
 	bool		HandleHotKey(void);
 	bool		HandleGuiEvent(void);
@@ -459,7 +509,7 @@ private:
 	// Parser functions (script_parser.cpp)
 	AUT_RESULT	Parser_VerifyBlockStructure(void);
 	AUT_RESULT	Parser_VerifyBlockStructure2(int nDo, int nWhile, int nFor, int nSelect, int nIf);
-	void		Parser(VectorToken &vLineToks, int &nScriptLine);
+	void		Parser(VectorToken &vLineToks, int &nScriptLine, uint ivPos = 0);
 	void		Parser_StartWithVariable(VectorToken &vLineToks, uint &ivPos);
 	AUT_RESULT	Parser_GetArrayElement(VectorToken &vLineToks, uint &ivPos, Variant **ppvTemp);
 	void		Parser_StartWithKeyword(VectorToken &vLineToks, uint &ivPos, int &nScriptLine);
@@ -490,6 +540,7 @@ private:
 
 
 	// Lexer functions (script_lexer.cpp)
+	AUT_RESULT	Lexer_TokenizeScript(void);							// Lex every line of the script into m_vScriptTokens
 	AUT_RESULT	Lexer(int nLineNum, const char *szLine, VectorToken &vLineToks);	// Convert a string into tokens
 	AUT_RESULT	Lexer_String(const char *szLine, uint &iPos, char *szTemp);
 	bool		Lexer_Number(const char *szLine, uint &iPos, Token &rtok, char *szTemp);
@@ -500,11 +551,24 @@ private:
 	void		Parser_ExpandEnvString(Variant &vString);
 	void		Parser_ExpandVarString(Variant &vString);
 	AUT_RESULT	Parser_EvaluateVariable(VectorToken &vLineToks, uint &ivPos, Variant &vResult);
+	void		Parser_InitMacros(void);
 	AUT_RESULT	Parser_EvaluateMacro(const char *szName, Variant &vResult);
+	AUT_RESULT	Parser_EvaluateMacro(int nMacro, const char *szName, Variant &vResult);
 	AUT_RESULT	Parser_EvaluateCondition(VectorToken &vLineToks, uint &ivPos, bool &bResult);
-	AUT_RESULT	Parser_EvaluateExpression(VectorToken &vLineToks, uint &ivPos, Variant &vResult);
-	AUT_RESULT	Parser_OprReduce(StackInt &opStack, StackVariant &valStack);
+	AUT_RESULT	Parser_EvaluateExpression(VectorToken &vLineToks, uint &ivPos, Variant &vResult, bool bCallParam = false);
+	AUT_RESULT	Parser_InterpretExpression(VectorToken &vLineToks, uint &ivPos, Variant &vResult, uint nValBase, bool bCallParam);
+	AUT_RESULT	Parser_OprReduce(uint nValBase);
+	void		Parser_OprApply(int nOp, StackVariant &valStack);
 	AUT_RESULT	Parser_SkipBoolean(VectorToken &vLineToks, unsigned int &ivPos);
+	AUT_RESULT	Parser_SkipBrackets(VectorToken &vLineToks, uint &ivPos, int nOpenTok, int nCloseTok);
+	void		Parser_InitExprCode(void);
+	void		Parser_FreeExprCode(void);
+	ByteCode*	Parser_GetExprCode(VectorToken &vLineToks, uint ivPos, bool bCallParam);
+	AUT_RESULT	Parser_CompileExpression(VectorToken &vLineToks, uint ivPos, ByteCode &oCode, bool bCallParam);
+	AUT_RESULT	Parser_CompileReduce(StackInt &opStack, uint &nVals, StackInt &stkJump, StackInt &stkSkip, uint ivTok, ByteCode &oCode);
+	bool		Parser_CompileFold(int nOp, ByteCode &oCode);
+	bool		Parser_GetFoldableConst(const Token &tokVar, Variant &vResult);
+	AUT_RESULT	Parser_ExecuteExprCode(ByteCode &oCode, VectorToken &vLineToks, uint &ivPos, Variant &vResult);
 
 
 	// Window-related functions (script_win.cpp)
@@ -665,6 +729,9 @@ private:
 	AUT_RESULT	F_PixelChecksum (VectorVariant &vParams, Variant &vResult);
 	AUT_RESULT	F_Ping(VectorVariant &vParams, Variant &vResult);
 	AUT_RESULT	F_ConsoleWrite (VectorVariant &vParams, Variant &vResult);
+	AUT_RESULT	F_ConsoleFlush(VectorVariant &vParams, Variant &vResult);
+	void		ConsoleWrite(const char *szText, int nLen);
+	void		ConsoleFlush(void);
 	void		ConvertCoords(int nCoordMode, POINT &pt);
 
 
@@ -803,6 +870,7 @@ private:
 	bool		FileSetTime_recurse (const char *szIn, FILETIME *ft, int nWhichTime, bool bRecurse);
 	AUT_RESULT	F_DirMove(VectorVariant &vParams, Variant &vResult);
 	AUT_RESULT	F_FileRead(VectorVariant &vParams, Variant &vResult);
+	AUT_RESULT	F_FileReadToArray(VectorVariant &vParams, Variant &vResult);
 	AUT_RESULT	F_FileRecycleEmpty(VectorVariant &vParams, Variant &vResult);
 	AUT_RESULT	F_DirGetSize(VectorVariant &vParams, Variant &vResult);
 	bool		GetDirSize(const char *szInputPath, __int64 &nSize, __int64 &nFiles, __int64 &nDirs, bool bExt, bool bRec);
@@ -838,6 +906,7 @@ private:
 	AUT_RESULT	F_StringFormat(VectorVariant &vParams, Variant &vResult);
 	AUT_RESULT	F_StringRegExp(VectorVariant &vParams, Variant &vResult);
 	AUT_RESULT	F_StringRegExpReplace(VectorVariant &vParams, Variant &vResult);
+	CRegExp *	StringRegExpCompile(const char *szPattern, int &nErrOffset);
 
 	// Math / Conversion functions (script_math.cpp)
 	AUT_RESULT	F_BitAND(VectorVariant &vParams, Variant &vResult);
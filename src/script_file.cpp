@@ -400,6 +400,11 @@ AUT_RESULT AutoIt_Script::F_FileOpen(VectorVariant &vParams, Variant &vResult)
 	m_FileHandleDetails[nFreeHandle]->fptr = fptr;				// Store handle
 	m_FileHandleDetails[nFreeHandle]->nMode = nMode;			// Store mode
 
+	if (nMode == 0)
+		m_FileHandleDetails[nFreeHandle]->lpReader = new LineReader(fptr);
+	else
+		m_FileHandleDetails[nFreeHandle]->lpReader = NULL;
+
 	++m_nNumFileHandles;
 	vResult = nFreeHandle;						// Return array position as the file handle (0-MAXOPENFILES)
 
@@ -431,6 +436,7 @@ AUT_RESULT AutoIt_Script::F_FileClose(VectorVariant &vParams, Variant &vResult)
 	{
 		if (m_FileHandleDetails[nHandle]->nType == AUT_FILEOPEN)
 		{
+			delete m_FileHandleDetails[nHandle]->lpReader;
 			fclose(m_FileHandleDetails[nHandle]->fptr);	// Close the file
 		}
 		else
@@ -461,12 +467,10 @@ AUT_RESULT AutoIt_Script::F_FileReadLine(VectorVariant &vParams, Variant &vResul
 	// ok = 0, 1=file not open for reading, -1=eof
 	//
 
-	int		i, nLine;
-	size_t	Len;
-	FILE	*fptr;
-	char	szBuffer[65535];					// Read buffer
-	int		nHandle;
-	bool	bError = false;
+	FILE		*fptr;
+	LineReader	*lpReader;
+	const char	*szLine;
+	int			nHandle;
 
 	// Default return value is ""
 	vResult = "";
@@ -481,6 +485,8 @@ AUT_RESULT AutoIt_Script::F_FileReadLine(VectorVariant &vParams, Variant &vResul
 			SetFuncErrorCode(1);					// Not open for reading
 			return AUT_OK;
 		}
+
+		lpReader = new LineReader(fptr);
 	}
 	else
 	{
@@ -507,62 +513,36 @@ AUT_RESULT AutoIt_Script::F_FileReadLine(VectorVariant &vParams, Variant &vResul
 			return AUT_ERR;
 		}
 
-
-		fptr = m_FileHandleDetails[nHandle]->fptr;	// Get the file handle
-
 		// Is the file open for reading?
 		if (m_FileHandleDetails[nHandle]->nMode != 0)
 		{
 			SetFuncErrorCode(1);					// Not open for reading
 			return AUT_OK;
 		}
+
+		lpReader = m_FileHandleDetails[nHandle]->lpReader;
 	}
 
 
-	// Read next line?  Or read a specific line?
+	// Read next line?  Or read a specific line? (lines already passed are found
+	// in the reader's index without rereading the file)
 	if (vParams.size() == 2)
-	{
-		nLine = vParams[1].nValue();		// Line requested to read
-
-		// Specific line...reeeeeewind
-		fseek(fptr, 0, SEEK_SET);
-
-		for (i=0; i<nLine; ++i)
-		{
-			if ( Util_fgetsb(szBuffer, 65535, fptr) == NULL )
-			{
-				SetFuncErrorCode(-1);				// EOF reached
-				bError = true;
-				//return AUT_OK;
-			}
-		} // end for
-	}
+		szLine = lpReader->readline(vParams[1].nValue());
 	else
-	{
-		// Read next line
-		if (Util_fgetsb(szBuffer, 65535, fptr) == NULL)
-		{
-			SetFuncErrorCode(-1);				// EOF reached
-			bError = true;
-			//return AUT_OK;
-		}
-	}
+		szLine = lpReader->readline();
 
-	if (bError == false)
-	{
-		// No errors
-		// Strip newline if present
-		Len = strlen(szBuffer);
-		if (Len && szBuffer[Len-1] == '\n')
-			szBuffer[Len-1] = '\0';
-
-		vResult = szBuffer;							// Return the line
-	}
+	if (szLine == NULL)
+		SetFuncErrorCode(-1);					// EOF reached
+	else
+		vResult = szLine;						// Return the line
 
 
 	// Errors or not, this is where we close the file if we opened it above
 	if (vParams[0].isString())
+	{
+		delete lpReader;
 		fclose(fptr);							// Close our file
+	}
 
 	return AUT_OK;
 
@@ -571,19 +551,22 @@ AUT_RESULT AutoIt_Script::F_FileReadLine(VectorVariant &vParams, Variant &vResul
 
 ///////////////////////////////////////////////////////////////////////////////
 // FileRead()
-// FileRead(<filehandle | filename>, chars )
-// Returns line in vResult
+// FileRead(<filehandle | filename> [, chars] )
+// Returns chars (or the whole/rest of the file) in vResult
 // @error:
 // ok = 0, 1=file not open for reading, -1=eof
 //
+// A filename is mapped into memory and the result is copied straight out of
+// the view so large files are read with a single copy.
 ///////////////////////////////////////////////////////////////////////////////
 
 AUT_RESULT AutoIt_Script::F_FileRead(VectorVariant &vParams, Variant &vResult)
 {
-	size_t	Len;
-	FILE	*fptr;
-	char	*szBuffer;						// Read buffer
-	int		nHandle;
+	size_t		Len;
+	size_t		nCount;
+	LineReader	*lpReader;					// Reader of the open file handle
+	char		*szBuffer;					// Read buffer
+	int			nHandle;
 
 	// Default return value is ""
 	vResult = "";
@@ -591,72 +574,162 @@ AUT_RESULT AutoIt_Script::F_FileRead(VectorVariant &vParams, Variant &vResult)
 	// Are we being passed a filename or filehandle?
 	if (vParams[0].isString() == true)
 	{
-		// Filename being used - we must open and close this file during this function
-		fptr = fopen(vParams[0].szValue(), "rb");	// Open in read mode (binary)
-		if (fptr == NULL)
+		const char	*lpView;
+		DWORD		dwSize;
+
+		// Filename being used - map the file for the duration of this function
+		if (Util_MapFile(vParams[0].szValue(), lpView, dwSize) == false)
 		{
 			SetFuncErrorCode(1);					// Not open for reading
 			return AUT_OK;
 		}
-	}
-	else
-	{
-		// Existing file handle used
-		nHandle = vParams[0].nValue();
 
-		if (nHandle < 0)
+		if (vParams.size() >= 2)
 		{
-			SetFuncErrorCode(1);
-			return AUT_OK;
+			if (vParams[1].nValue() <= 0)
+				dwSize = 0;
+			else if ((DWORD)vParams[1].nValue() < dwSize)
+				dwSize = (DWORD)vParams[1].nValue();
 		}
 
-		// Does this file handle exist?
-		if (nHandle >= AUT_MAXOPENFILES || m_FileHandleDetails[nHandle] == NULL)
-		{
-			FatalError(IDS_AUT_E_FILEHANDLEINVALID);
-			return AUT_ERR;
-		}
+		if (dwSize == 0)
+			SetFuncErrorCode(-1);					// EOF, or error...
+		else
+			vResult.SetString(lpView, (int)dwSize);
 
-		// Is it a file open handle?
-		if (m_FileHandleDetails[nHandle]->nType != AUT_FILEOPEN)
-		{
-			FatalError(IDS_AUT_E_FILEHANDLEINVALID);
-			return AUT_ERR;
-		}
+		Util_UnmapFile(lpView);
 
+		return AUT_OK;
+	}
 
-		fptr = m_FileHandleDetails[nHandle]->fptr;	// Get the file handle
+	// Existing file handle used
+	nHandle = vParams[0].nValue();
 
-		// Is the file open for reading?
-		if (m_FileHandleDetails[nHandle]->nMode != 0)
-		{
-			SetFuncErrorCode(1);					// Not open for reading
-			return AUT_OK;
-		}
+	if (nHandle < 0)
+	{
+		SetFuncErrorCode(1);
+		return AUT_OK;
+	}
+
+	// Does this file handle exist?
+	if (nHandle >= AUT_MAXOPENFILES || m_FileHandleDetails[nHandle] == NULL)
+	{
+		FatalError(IDS_AUT_E_FILEHANDLEINVALID);
+		return AUT_ERR;
+	}
+
+	// Is it a file open handle?
+	if (m_FileHandleDetails[nHandle]->nType != AUT_FILEOPEN)
+	{
+		FatalError(IDS_AUT_E_FILEHANDLEINVALID);
+		return AUT_ERR;
+	}
+
+	// Is the file open for reading?
+	if (m_FileHandleDetails[nHandle]->nMode != 0)
+	{
+		SetFuncErrorCode(1);					// Not open for reading
+		return AUT_OK;
 	}
 
+	lpReader = m_FileHandleDetails[nHandle]->lpReader;	// Reads must go through the reader
+
+
+	// Number of chars to read, default is the rest of the file
+	if (vParams.size() >= 2)
+		nCount = vParams[1].nValue() > 0 ? (size_t)vParams[1].nValue() : 0;
+	else
+		nCount = (size_t)lpReader->remaining();
 
 	// Create a buffer big enough for number of chars + \0
-	szBuffer = new char[vParams[1].nValue() + 1];
+	szBuffer = new char[nCount + 1];
 
-	Len = fread(szBuffer, 1, vParams[1].nValue(), fptr);
+	Len = lpReader->read(szBuffer, nCount);
 	if (Len == 0)
 		SetFuncErrorCode(-1);					// EOF, or error...
 	else
+		vResult.SetString(szBuffer, (int)Len);
+
+	delete [] szBuffer;							// Free buffer
+
+	return AUT_OK;
+
+} // FileRead()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FileReadToArray()
+// FileReadToArray(<filename>)
+// Returns the lines of the file in an array, element 0 is the number of lines
+// @error:
+// ok = 0, 1=file couldn't be opened, 2=too many lines for an array
+//
+// Lines end with CRLF, LF or a lone CR (the same as FileReadLine()) and are
+// copied straight out of a view of the file.
+///////////////////////////////////////////////////////////////////////////////
+
+AUT_RESULT AutoIt_Script::F_FileReadToArray(VectorVariant &vParams, Variant &vResult)
+{
+	const char		*lpView;
+	const char		*szCh, *szEnd, *szStart;
+	DWORD			dwSize;
+	unsigned int	nLines, i;
+
+	// Default return value is ""
+	vResult = "";
+
+	if (Util_MapFile(vParams[0].szValue(), lpView, dwSize) == false)
 	{
-		szBuffer[Len] = '\0';					// Terminate
-		vResult = szBuffer;
+		SetFuncErrorCode(1);					// Not open for reading
+		return AUT_OK;
 	}
 
-	delete [] szBuffer;							// Free buffer
+	szEnd = lpView + dwSize;
 
-	// Errors or not, this is where we close the file if we opened it above
-	if (vParams[0].isString())
-		fclose(fptr);							// Close our file
+	// Count the lines so that the array can be created in one go
+	nLines = 0;
+	for (szCh = lpView; szCh < szEnd; ++szCh)
+	{
+		if (*szCh == '\n' || (*szCh == '\r' && (szCh+1 == szEnd || szCh[1] != '\n')))
+			++nLines;
+	}
+
+	if (dwSize && szEnd[-1] != '\r' && szEnd[-1] != '\n')
+		++nLines;								// Last line has no terminator
+
+	if (Util_VariantArrayDim(&vResult, nLines+1) == false)
+	{
+		Util_UnmapFile(lpView);
+		vResult = "";
+		SetFuncErrorCode(2);					// Too many lines for an array
+		return AUT_OK;
+	}
+
+	*Util_VariantArrayGetRef(&vResult, 0) = (int)nLines;
+
+	// Store each line
+	i = 1;
+	szStart = lpView;
+	for (szCh = lpView; szCh < szEnd; ++szCh)
+	{
+		if (*szCh == '\r' || *szCh == '\n')
+		{
+			Util_VariantArrayGetRef(&vResult, i++)->SetString(szStart, (int)(szCh - szStart));
+
+			if (*szCh == '\r' && szCh+1 < szEnd && szCh[1] == '\n')
+				++szCh;							// Skip the LF of a CRLF
+			szStart = szCh + 1;
+		}
+	}
+
+	if (szStart < szEnd)
+		Util_VariantArrayGetRef(&vResult, i)->SetString(szStart, (int)(szEnd - szStart));
+
+	Util_UnmapFile(lpView);
 
 	return AUT_OK;
 
-} // FileRead()
+} // FileReadToArray()
 
 
 ///////////////////////////////////////////////////////////////////////////////
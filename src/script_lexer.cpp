@@ -49,6 +49,7 @@
 #ifndef _MSC_VER								// Includes for non-MS compilers
 	#include <windows.h>
 	#include <limits.h>
+	#include <string.h>
 #endif
 
 #include "AutoIt.h"								// Autoit values, macros and config options
@@ -56,6 +57,38 @@
 #include "script.h"
 #include "resources\resource.h"
 #include "utility.h"
+#include "globaldata.h"
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Lexer_TokenizeScript()
+//
+// Converts every line of the loaded script into tokens just once.  The tokens
+// for line n are stored in m_vScriptTokens[n] and are never modified after this,
+// the parser and keyword handlers use them by reference so that a line is never
+// lexed or copied again during execution.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+AUT_RESULT AutoIt_Script::Lexer_TokenizeScript(void)
+{
+	int		nNumLines = g_oScriptFile.GetNumScriptLines();
+	int		nLine;
+
+	delete [] m_vScriptTokens;
+	m_vScriptTokens = new VectorToken[nNumLines + 1];	// 1 = first line, entry 0 is unused
+
+	for (nLine = 1; nLine <= nNumLines; ++nLine)
+	{
+		m_nErrorLine = nLine;					// Keep track for errors
+
+		if ( AUT_FAILED( Lexer(nLine, g_oScriptFile.GetLine(nLine), m_vScriptTokens[nLine]) ) )
+			return AUT_ERR;						// Bad line
+	}
+
+	return AUT_OK;
+
+} // Lexer_TokenizeScript()
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -71,20 +104,6 @@
 
 AUT_RESULT AutoIt_Script::Lexer(int nLineNum, const char *szLine, VectorToken &vLineToks)
 {
-
-#ifdef AUT_CONFIG_LEXERCACHE
-	int	nCacheIdx = nLineNum & AUT_LEXER_CACHEMASK;
-
-	// Do we have a cached copy of this line?
-	if (m_LexerCache[nCacheIdx].nLineNum == nLineNum)
-	{
-		// Yes, copy the tokens
-		vLineToks = m_LexerCache[nCacheIdx].vLine;
-
-		return AUT_OK;
-	}
-#endif
-
 	uint			iPos = 0;					// Position in the string
 	uint			iPosTemp;
 	char			ch;
@@ -157,6 +176,7 @@ AUT_RESULT AutoIt_Script::Lexer(int nLineNum, const char *szLine, VectorToken &v
 
 				tok.settype(TOK_VARIABLE);
 				tok = szTemp;
+				tok.m_nVarID = g_oVarTable.RegisterVar(szTemp);	// Resolve the name to an ID once
 				vLineToks.push_back(tok);
 				break;
 
@@ -181,6 +201,7 @@ AUT_RESULT AutoIt_Script::Lexer(int nLineNum, const char *szLine, VectorToken &v
 
 				tok.settype(TOK_MACRO);
 				tok = szTemp;
+				tok.m_nVarID = m_oMacroHash.find(szTemp, iPosTemp);	// Resolve the macro once (-1 = not built-in)
 				vLineToks.push_back(tok);
 				break;
 
@@ -264,9 +285,15 @@ AUT_RESULT AutoIt_Script::Lexer(int nLineNum, const char *szLine, VectorToken &v
 				break;
 
 			case '&':
-				tok.settype(TOK_CONCAT);
-				vLineToks.push_back(tok);
 				++iPos;
+				if (szLine[iPos] == '=')
+				{
+					tok.settype(TOK_CONCATEQUAL);
+					++iPos;
+				}
+				else
+					tok.settype(TOK_CONCAT);
+				vLineToks.push_back(tok);
 				break;
 
 			case '[':
@@ -338,13 +365,6 @@ AUT_RESULT AutoIt_Script::Lexer(int nLineNum, const char *szLine, VectorToken &v
 	tok.m_nCol = iPos;
 	vLineToks.push_back(tok);
 
-#ifdef AUT_CONFIG_LEXERCACHE
-	// Cache this lexed line for future use
-	m_LexerCache[nCacheIdx].nLineNum = nLineNum;
-	m_LexerCache[nCacheIdx].vLine = vLineToks;
-
-#endif
-
 	return AUT_OK;
 
 } // Lexer()
@@ -470,11 +490,15 @@ bool AutoIt_Script::Lexer_Number(const char *szLine, uint &iPos, Token &rtok, ch
 		if (bFloat)
 		{
 			rtok.settype(TOK_DOUBLE);
-			rtok.fValue = atof(szTemp);
+			if (Variant::ParseDouble(szTemp, rtok.fValue) == false)
+				rtok.fValue = atof(szTemp);		// Exponent or lots of digits
 		}
 		else
 		{
-			__int64 n64Temp = _atoi64(szTemp);
+			__int64 n64Temp;
+			if (Variant::ParseInt64(szTemp, n64Temp, 18) == false)
+				n64Temp = _atoi64(szTemp);
+
 			if (n64Temp > INT_MAX || n64Temp < INT_MIN)
 			{
 				rtok.settype(TOK_INT64);
@@ -483,7 +507,7 @@ bool AutoIt_Script::Lexer_Number(const char *szLine, uint &iPos, Token &rtok, ch
 			else
 			{
 				rtok.settype(TOK_INT32);
-				rtok.nValue  = atoi(szTemp);	// Store as int32
+				rtok.nValue  = (int)n64Temp;	// Store as int32
 			}
 		}
 	}
@@ -500,65 +524,40 @@ bool AutoIt_Script::Lexer_Number(const char *szLine, uint &iPos, Token &rtok, ch
 void AutoIt_Script::Lexer_KeywordOrFunc(const char *szLine, uint &iPos, Token &rtok, char *szTemp)
 {
 	int		i;
-	uint	iPosTemp = 0;
+	uint	iStart = iPos;
 
 	char ch = szLine[iPos];
 	while ( (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') ||
 			(ch >= '0' && ch <= '9') || ch == '_')
 	{
-		szTemp[iPosTemp++] = ch;
 		++iPos;
 		ch = szLine[iPos];
 	}
 
-	szTemp[iPosTemp] = '\0';					// Terminate
-	CharUpper(szTemp);							// Convert to upper case to speed up comparisons (strcmp rather than stricmp)
-
-	// Is it a valid keyword?
-	i = 0;
-	while (i < K_MAX)
-	{
-		if (!strcmp(m_szKeywords[i], szTemp) )
-		{
-			// It's a keyword
-			rtok.settype(TOK_KEYWORD);
-			rtok.nValue = i;						// Order of enum in script.h must match order of list
-			return;
-		}
-
-		++i;
-	}
-
-
-	// The built-in function list is in alphabetical order so we can do a binary search :)
-	int nFirst = 0;
-	int nLast = m_nFuncListSize - 1;
-	int nRes;
+	// Keywords and built-in functions are in one perfect hash table (keywords first), the
+	// name is looked up directly from the line without copying or converting case
+	i = m_oKeywordFuncHash.find(&szLine[iStart], iPos - iStart);
 
-	while (nFirst <= nLast)
+	if (i == -1)
 	{
-		i = (nFirst + nLast) / 2;			// Truncated to an integer!
-
-		nRes = strcmp(szTemp, m_FuncList[i].szName);
+		// Invalid built in function, must be user function
+		memcpy(szTemp, &szLine[iStart], iPos - iStart);
+		szTemp[iPos - iStart] = '\0';			// Terminate
+		CharUpper(szTemp);						// User functions are stored as upper case
 
-		if ( nRes < 0 )
-			nLast = i - 1;
-		else if ( nRes > 0 )
-			nFirst = i + 1;
-		else
-			break;								// nRes == 0
+		rtok.settype(TOK_USERFUNCTION);
+		rtok = szTemp;
 	}
-
-	if ( nFirst <= nLast )
+	else if (i < K_MAX)
 	{
-		rtok.settype(TOK_FUNCTION);
-		rtok.nValue = i;					// Save function index
+		// It's a keyword
+		rtok.settype(TOK_KEYWORD);
+		rtok.nValue = i;						// Order of enum in script.h must match order of list
 	}
 	else
 	{
-		// Invalid built in function, must be user function
-		rtok.settype(TOK_USERFUNCTION);
-		rtok = szTemp;
+		rtok.settype(TOK_FUNCTION);
+		rtok.nValue = i - K_MAX;				// Save function index
 	}
 
 } // Lexer_KeywordOrFunc()
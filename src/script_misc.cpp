@@ -56,8 +56,11 @@
 	#include <ctype.h>
 	#include <wininet.h>
 	#include <process.h>
+	#include <new.h>
 #endif
 
+#include <new>									// std::nothrow
+
 // MinGW is missing some internet headers from wininet.h so declare them here
 #ifndef INTERNET_STATE_CONNECTED
     typedef struct {
@@ -1652,7 +1655,14 @@ AUT_RESULT AutoIt_Script::F_AutoItSetOption(VectorVariant &vParams, Variant &vRe
 	const char *szOption = vParams[0].szValue();
 	int			nValue = vParams[1].nValue();
 
-	if ( !stricmp(szOption, "CaretCoordMode") )				// CaretCoordMode
+	if ( !stricmp(szOption, "BatchLines") )					// BatchLines
+	{
+		vResult = m_nBatchLines;			// Store current value
+
+		if (nValue >= 1)
+			m_nBatchLines = nValue;
+	}
+	else if ( !stricmp(szOption, "CaretCoordMode") )		// CaretCoordMode
 	{
 		vResult = (int)m_nCoordCaretMode;	// Store current value
 		m_nCoordCaretMode = nValue;
@@ -1677,6 +1687,32 @@ AUT_RESULT AutoIt_Script::F_AutoItSetOption(VectorVariant &vParams, Variant &vRe
 			#endif
 		}
 	}
+	else if ( !stricmp(szOption, "ConsoleBuffer") )			// ConsoleBuffer
+	{
+		vResult = m_nConsoleBufSize;		// Store current value
+
+		if (nValue >= 0)
+		{
+			// Write out anything in the old buffer before replacing it (0 = unbuffered)
+			ConsoleFlush();
+			delete [] m_szConsoleBuf;
+			m_szConsoleBuf = NULL;
+
+			if (nValue > AUT_CONSOLEBUFMAX)
+				nValue = AUT_CONSOLEBUFMAX;
+
+			// The new handler ends the program if new fails so switch it off - if there
+			// isn't enough memory we just stay unbuffered
+			if (nValue > 0)
+			{
+				_PNH	pfnOldHandler = _set_new_handler(NULL);
+				m_szConsoleBuf = new (std::nothrow) char[nValue];
+				_set_new_handler(pfnOldHandler);
+			}
+
+			m_nConsoleBufSize = (m_szConsoleBuf != NULL) ? nValue : 0;
+		}
+	}
 	else if ( !stricmp(szOption, "FtpBinaryMode") )			// GUICoordMode
 	{
 		vResult = (int)m_bFtpBinaryMode;	// Store current value
@@ -2079,6 +2115,8 @@ AUT_RESULT AutoIt_Script::F_MemGetStats(VectorVariant &vParams, Variant &vResult
 
 AUT_RESULT AutoIt_Script::F_MsgBox(VectorVariant &vParams, Variant &vResult)
 {
+	ConsoleFlush();								// Don't hold console output while the box is up
+
 	if (vParams.size() == 4)
 		vResult = Util_MessageBoxEx(NULL, vParams[2].szValue(), vParams[1].szValue(), (UINT)vParams[0].nValue() | MB_SETFOREGROUND, vParams[3].nValue() * 1000);
 	else
@@ -2279,14 +2317,87 @@ AUT_RESULT AutoIt_Script::F_IsDeclared(VectorVariant &vParams, Variant &vResult)
 
 AUT_RESULT AutoIt_Script::F_ConsoleWrite(VectorVariant &vParams, Variant &vResult)
 {
-	printf("%s", vParams[0].szValue());
-	fflush(stdout);
+	ConsoleWrite(vParams[0].szValue(), vParams[0].szLength());
 
 	return AUT_OK;
 
 }	// F_ConsoleWrite()
 
 
+//////////////////////////////////////////////////////////////////////////
+// F_ConsoleFlush()
+//
+// Writes out any ConsoleWrite() output held in the buffer (see the
+// ConsoleBuffer option)
+//////////////////////////////////////////////////////////////////////////
+
+AUT_RESULT AutoIt_Script::F_ConsoleFlush(VectorVariant &vParams, Variant &vResult)
+{
+	ConsoleFlush();
+
+	return AUT_OK;
+
+}	// F_ConsoleFlush()
+
+
+//////////////////////////////////////////////////////////////////////////
+// ConsoleWrite()
+//
+// Writes nLen bytes to stdout.  If the ConsoleBuffer option is set the
+// text is held until the buffer fills, AUT_CONSOLEFLUSHTIME passes, the
+// script waits or exits, or ConsoleFlush() is called - so streaming lots
+// of small writes to a pipe doesn't cost a system call each.
+//////////////////////////////////////////////////////////////////////////
+
+void AutoIt_Script::ConsoleWrite(const char *szText, int nLen)
+{
+	// Unbuffered (the default) - write it straight out
+	if (m_szConsoleBuf == NULL)
+	{
+		fwrite(szText, 1, nLen, stdout);
+		fflush(stdout);
+		return;
+	}
+
+	if (m_nConsoleBufUsed + nLen > m_nConsoleBufSize)
+	{
+		ConsoleFlush();
+
+		// Too big to buffer - write directly
+		if (nLen >= m_nConsoleBufSize)
+		{
+			fwrite(szText, 1, nLen, stdout);
+			fflush(stdout);
+			return;
+		}
+	}
+
+	if (m_nConsoleBufUsed == 0)
+		m_tConsoleBufStarted = GetTickCount();
+
+	memcpy(&m_szConsoleBuf[m_nConsoleBufUsed], szText, nLen);
+	m_nConsoleBufUsed += nLen;
+
+}	// ConsoleWrite()
+
+
+//////////////////////////////////////////////////////////////////////////
+// ConsoleFlush()
+//////////////////////////////////////////////////////////////////////////
+
+void AutoIt_Script::ConsoleFlush(void)
+{
+	if (m_nConsoleBufUsed)
+	{
+		fwrite(m_szConsoleBuf, 1, m_nConsoleBufUsed, stdout);
+		m_nConsoleBufUsed = 0;
+	}
+
+	fflush(stdout);
+
+}	// ConsoleFlush()
+
+
 //////////////////////////////////////////////////////////////////////////
 // ConvertCoords()
 //
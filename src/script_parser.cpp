@@ -59,11 +59,13 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 // Parser()
+//
+// Parses the tokens from position ivPos to the END token (ivPos is only non-zero
+// for the statement part of a single line IF)
 ///////////////////////////////////////////////////////////////////////////////
 
-void AutoIt_Script::Parser(VectorToken &vLineToks, int &nScriptLine)
+void AutoIt_Script::Parser(VectorToken &vLineToks, int &nScriptLine, uint ivPos)
 {
-	uint	ivPos;						// Position in the vector
 	Variant	vTemp;						// Temp variant for operations
 
 	// A line can either start with an assignment or a keyword or a function
@@ -71,8 +73,6 @@ void AutoIt_Script::Parser(VectorToken &vLineToks, int &nScriptLine)
 	// If/while/endif/etc.
 	// function(...)
 
-	ivPos = 0;
-
 	switch ( vLineToks[ivPos].m_nType )
 	{
 		case TOK_VARIABLE:
@@ -169,19 +169,12 @@ AUT_RESULT AutoIt_Script::Parser_FunctionCall(VectorToken &vLineToks, uint &ivPo
 
 AUT_RESULT AutoIt_Script::Parser_GetFunctionCallParams(VectorVariant &vParams, VectorToken &vLineToks, uint &ivPos, int &nNumParams)
 {
-	VectorToken		vFuncToks;					// Vector of tokens for THIS FUNCTION CALL
 	Variant			vTemp;
-	uint			ivFuncPos;
-	Token			tok;
-	int				nColTemp;
+	uint			ivEnd;
 
 	// Tokens should be:
 	// function ( expression , expression , ... )
 
-	// Store the char number of the function name in case we need to generate
-	// an error
-	nColTemp = vLineToks[ivPos].m_nCol;
-
 	++ivPos;									// Skip function name
 
 	if ( vLineToks[ivPos].m_nType != TOK_LEFTPAREN )
@@ -191,76 +184,66 @@ AUT_RESULT AutoIt_Script::Parser_GetFunctionCallParams(VectorVariant &vParams, V
 	}
 	++ivPos;										// Skip (
 
-	// Loop until we hit ) or END storing tokens as we go
-	// Watch out for nested function calls
+	// Find the closing ) - watch out for nested function calls
 	int nFuncCount = 0;
 	bool bFinished = false;
+	ivEnd = ivPos;
 	while ( bFinished == false )
 	{
-		switch (vLineToks[ivPos].m_nType)
+		switch (vLineToks[ivEnd].m_nType)
 		{
 			case TOK_LEFTPAREN:
 				++nFuncCount;
-				vFuncToks.push_back(vLineToks[ivPos]);
-				++ivPos;
+				++ivEnd;
 				break;
 
 			case TOK_RIGHTPAREN:
 				if (nFuncCount == 0)
-				{
 					bFinished = true;
-					++ivPos;					// Skip final )
-				}
 				else
 				{
 					nFuncCount--;
-					vFuncToks.push_back(vLineToks[ivPos]);
-					++ivPos;
+					++ivEnd;
 				}
 				break;
 
 			case TOK_END:
-				FatalError(IDS_AUT_E_GENFUNCTION, vLineToks[ivPos-1].m_nCol);
+				FatalError(IDS_AUT_E_GENFUNCTION, vLineToks[ivEnd-1].m_nCol);
 				return AUT_ERR;
 
 			default:
-				vFuncToks.push_back(vLineToks[ivPos]);
-				++ivPos;
+				++ivEnd;
 				break;
 		}
 	}
 
 
-	tok.settype(TOK_END);						// Add an END token
-	tok.m_nCol = nColTemp;						// Just in case someone uses this value for the error message
-	vFuncToks.push_back(tok);
-
-
-	// Loop around until we hit END, count and store the evaluated expressions as we go
+	// Loop around until we hit the closing ), count and store the evaluated expressions as we go.
+	// The expressions are evaluated where they are in the line (as call parameters they finish at
+	// the unmatched closing ) ) so the tokens don't need copying and the compiled expressions are used
 	nNumParams = 0;
-	ivFuncPos = 0;
-	while ( vFuncToks[ivFuncPos].m_nType != TOK_END  )
+	while ( ivPos != ivEnd )
 	{
 		// Parse an "expression" (or parameter)
-		if ( AUT_FAILED( Parser_EvaluateExpression(vFuncToks, ivFuncPos, vTemp) ) )
+		if ( AUT_FAILED( Parser_EvaluateExpression(vLineToks, ivPos, vTemp, true) ) )
 			return AUT_ERR;
 
 		// Increase the number of expressions parsed and store the result in our
 		// parameter vector
 		++nNumParams;
-		vParams.push_back(vTemp);
+		vParams.pushmove(vTemp);
 
-		// Did the parse function cause us to goto the end of our tokens?
-		if ( vFuncToks[ivFuncPos].m_nType == TOK_END )
+		// Did the parse function cause us to goto the end of our parameters?
+		if ( ivPos == ivEnd )
 			break;
 
 		// If the next token is a comma it means that there are more parameters to read
-		if ( vFuncToks[ivFuncPos].m_nType == TOK_COMMA )
-			++ivFuncPos;
+		if ( vLineToks[ivPos].m_nType == TOK_COMMA )
+			++ivPos;
 
 	} // End While
 
-
+	ivPos = ivEnd + 1;							// Skip final )
 
 	// vParams now contains all the parameters needed to call our function - yay
 
@@ -309,7 +292,8 @@ AUT_RESULT AutoIt_Script::Parser_UserFunctionCall(VectorToken &vLineToks, uint &
 	int nColTemp = vLineToks[ivPos].m_nCol;
 
 	// Check that this user function exists, and get the details of it
-	if (Parser_FindUserFunction(vLineToks[ivPos].szValue, nLineNum, nNumParamsMax, nNumParamsMin, nEndLineNum) == false)
+	UserFuncDetails *lpFuncDetails = m_oUserFuncList.find(vLineToks[ivPos].szValue);
+	if (lpFuncDetails == NULL)
 	{
 		// Wasn't a recognised user function - try and and run it as a plugin function
 //		if (Parser_PluginFunctionCall(vLineToks, ivPos, vResult) == false)
@@ -321,19 +305,19 @@ AUT_RESULT AutoIt_Script::Parser_UserFunctionCall(VectorToken &vLineToks, uint &
 //			return AUT_OK;
 	}
 
+	nNumParamsMax	= lpFuncDetails->nNumParams;
+	nNumParamsMin	= lpFuncDetails->nNumParamsMin;
+	nLineNum		= lpFuncDetails->nFuncLineNum;
+	nEndLineNum		= lpFuncDetails->nEndFuncLineNum;
+
 	VectorVariant	vParams;					// Vector array of the parameters for this function
-	VectorToken		vFuncToks;					// Vector of tokens for THIS FUNCTION CALL
-	VectorToken		vFuncDecToks;				// Vector of tokens for the function declaration
 	int				i;
 	Variant			vTemp;
 	Variant			*pvTemp;
 	bool			bConst = false;
-	uint			ivFuncPos, ivFuncDecPos;
-	uint			ivParamPos;
-	Token			tok;
-	AString			sLine;						// Temp line buffer
-	const char		*szTempScriptLine;
+	uint			ivDefault;
 	GenStatement	tFuncDetails;
+	UserFuncParam	*lpParam;
 
 	// Make a statement stack entry for this function (we will push it on stack when params verified)
 	tFuncDetails.nType		= L_FUNC;
@@ -351,154 +335,88 @@ AUT_RESULT AutoIt_Script::Parser_UserFunctionCall(VectorToken &vLineToks, uint &
 	}
 	++ivPos;										// Skip (
 
+	// Make a list of the values or references that we will pass using the parameter details
+	// stored by StoreUserFuncs().  The arguments are evaluated where they are in the line (an
+	// expression finishes at a comma or the unmatched closing ) ).  We must make a list and not
+	// assign them now as parameters may contain other function calls which would change the
+	// scope!  Ack.
+	int nNumParams = 0;
 
-	// Loop until we hit ) or END storing tokens as we go
-	// Watch out for nested function calls
-	int nFuncCount = 0;
-	bool bFinished = false;
-	while ( bFinished == false )
+	while (vLineToks[ivPos].m_nType != TOK_RIGHTPAREN)
 	{
-		switch (vLineToks[ivPos].m_nType)
+		// Too many parameters?
+		if (nNumParams == nNumParamsMax)
 		{
-			case TOK_LEFTPAREN:
-				++nFuncCount;
-				vFuncToks.push_back(vLineToks[ivPos]);
-				++ivPos;
-				break;
-
-			case TOK_RIGHTPAREN:
-				if (nFuncCount == 0)
-				{
-					bFinished = true;
-					++ivPos;					// Skip final )
-				}
-				else
-				{
-					nFuncCount--;
-					vFuncToks.push_back(vLineToks[ivPos]);
-					++ivPos;
-				}
-				break;
-
-			case TOK_END:
-				FatalError(IDS_AUT_E_GENFUNCTION, nColTemp);
-				return AUT_ERR;
-
-			default:
-				vFuncToks.push_back(vLineToks[ivPos]);
-				++ivPos;
-				break;
+			FatalError(IDS_AUT_E_FUNCTIONNUMPARAMS, vLineToks[ivPos].m_nCol);
+			return AUT_ERR;
 		}
-	}
-
-	tok.settype(TOK_END);						// Add an END token to our buffer
-	vFuncToks.push_back(tok);
 
-	//
-	// vFuncToks now just contains the tokens for the parameters of a function call.
-	//
-
-	ivFuncPos = 0;				// First token
-
-	// Ok, now we re-read the function declaration (to check for ByRefs) and make a list
-	// of the values or references that we will pass.  We must make a list and not assign them
-	// now as parameters may contain other function calls which would change the scope!  Ack.
-	// Also to note, the function declaration was syntax checked when the script was loaded, this
-	// helps.
-
-	// Read in our function declaration
-	szTempScriptLine = g_oScriptFile.GetLine(nLineNum);
-	Lexer(nLineNum, szTempScriptLine, vFuncDecToks);
-	ivFuncDecPos = 0;
-	ivFuncDecPos += 3;							// Skip "Func", funcname and "("
-
-
-	int nNumParams = 0;
-
-	for (i=0; i<nNumParamsMax; ++i)
-	{
-		// If we hit an END token we have run out of parameters
-		if (vFuncToks[ivFuncPos].m_nType == TOK_END)
-			break;
-
-		++nNumParams;		// increment current number
+		lpParam = &lpFuncDetails->lpParams[nNumParams++];
 
 		// Is the declaration for this parameter a value or reference?
-		if (vFuncDecToks[ivFuncDecPos].m_nType == TOK_KEYWORD && vFuncDecToks[ivFuncDecPos].nValue == K_BYREF)
+		if (lpParam->bByRef)
 		{
 			// Reference, get a pointer to the named variable
-			if (vFuncToks[ivFuncPos].m_nType != TOK_VARIABLE)
+			if (vLineToks[ivPos].m_nType != TOK_VARIABLE)
 			{
-				FatalError(IDS_AUT_E_FUNCTIONEXPECTEDVARIABLE, vFuncToks[ivFuncPos].m_nCol);
+				FatalError(IDS_AUT_E_FUNCTIONEXPECTEDVARIABLE, vLineToks[ivPos].m_nCol);
 				return AUT_ERR;
 			}
 
-			if (g_oVarTable.GetRef(vFuncToks[ivFuncPos].szValue, &pvTemp, bConst) == false)
+			if (g_oVarTable.GetRef(vLineToks[ivPos], &pvTemp, bConst) == false)
 			{
-				FatalError(IDS_AUT_E_VARNOTFOUND, vFuncToks[ivFuncPos].m_nCol);
+				FatalError(IDS_AUT_E_VARNOTFOUND, vLineToks[ivPos].m_nCol);
 				return AUT_ERR;
 			}
 			else if (bConst)
 			{
 				// Can't use a constant for a ByRef!
-				FatalError(IDS_AUT_E_ASSIGNTOCONST, vFuncToks[ivFuncPos].m_nCol);
+				FatalError(IDS_AUT_E_ASSIGNTOCONST, vLineToks[ivPos].m_nCol);
 				return AUT_ERR;
 			}
 
-			++ivFuncPos;						// Skip $var name
+			++ivPos;							// Skip $var name
 
 			// If this variable is an array AND the next token is [ then try to get the reference
 			// of the actual ELEMENT rather than the whole array
-			if (pvTemp->type() == VAR_ARRAY && vFuncToks[ivFuncPos].m_nType == TOK_LEFTSUBSCRIPT)
+			if (pvTemp->type() == VAR_ARRAY && vLineToks[ivPos].m_nType == TOK_LEFTSUBSCRIPT)
 			{
-				if ( AUT_FAILED(Parser_GetArrayElement(vFuncToks, ivFuncPos, &pvTemp)) )
+				if ( AUT_FAILED(Parser_GetArrayElement(vLineToks, ivPos, &pvTemp)) )
 					return AUT_ERR;
 			}
 
 			vTemp = pvTemp;						// vTemp is now a variant that refers to another
 
-			ivFuncDecPos += 2;					// Skip ByRef and $var in declaration
-
-			// Make sure that the next token in the user call is a comma or END
-			if ( vFuncToks[ivFuncPos].m_nType != TOK_COMMA && vFuncToks[ivFuncPos].m_nType != TOK_END)
+			// Make sure that the next token in the user call is a comma or )
+			if ( vLineToks[ivPos].m_nType != TOK_COMMA && vLineToks[ivPos].m_nType != TOK_RIGHTPAREN)
 			{
-				FatalError(IDS_AUT_E_FUNCTIONEXPECTEDVARIABLE, vFuncToks[ivFuncPos].m_nCol);
+				FatalError(IDS_AUT_E_FUNCTIONEXPECTEDVARIABLE, vLineToks[ivPos].m_nCol);
 				return AUT_ERR;
 			}
-
 		}
 		else
 		{
 			// Value
 			// Parse an "expression" (or parameter)
-			if ( AUT_FAILED( Parser_EvaluateExpression(vFuncToks, ivFuncPos, vTemp) ) )
+			if ( AUT_FAILED( Parser_EvaluateExpression(vLineToks, ivPos, vTemp, true) ) )
 				return AUT_ERR;
-
-			++ivFuncDecPos;						// Skip $var in declaration
-
-			// If this contains a default parameter then skip "= literal" as well
-			if (vFuncDecToks[ivFuncDecPos].m_nType == TOK_EQUAL)
-				ivFuncDecPos +=2;
 		}
 
 		// Add the value (or reference...) onto our list of params to pass
-		vParams.push_back(vTemp);
+		vParams.pushmove(vTemp);
 
-		++ivFuncDecPos;							// Skip (potential) comma in function declaration
-
-		// If the next token is a comma (user call) it means that there are more parameters to read
-		if ( vFuncToks[ivFuncPos].m_nType == TOK_COMMA )
-			++ivFuncPos;
-
-	} // End For
+		// If the next token is a comma it means that there are more parameters to read
+		if ( vLineToks[ivPos].m_nType == TOK_COMMA )
+			++ivPos;
+		else if ( vLineToks[ivPos].m_nType != TOK_RIGHTPAREN )
+		{
+			FatalError(IDS_AUT_E_GENFUNCTION, nColTemp);
+			return AUT_ERR;
+		}
 
+	} // End While
 
-	// If the next token in the function call is not END, then too many parameters have been passed.
-	if ( vFuncToks[ivFuncPos].m_nType != TOK_END  )
-	{
-		FatalError(IDS_AUT_E_FUNCTIONNUMPARAMS, vFuncToks[ivFuncPos].m_nCol);
-		return AUT_ERR;
-	}
+	++ivPos;									// Skip final )
 
 	// Also check that too few parameters have not been passed
 	if (nNumParams < nNumParamsMin)
@@ -508,86 +426,44 @@ AUT_RESULT AutoIt_Script::Parser_UserFunctionCall(VectorToken &vLineToks, uint &
 		return AUT_ERR;
 	}
 
-	//Util_WinPrintf("", "%d %d", nNumParams, nNumParamsMax);
-
 
 	// Ok, we have parsed the function call and have a list of the parameters (values and/or reference)
-	// that we need to pass, now increase the scope and reread the function declaration and assign
-	// values or references as required
+	// that we need to pass, now increase the scope and assign values or references as required
 	// nNumParams = the number of parameters passed
 	// nNumParamsMax = the maximum number of parameters that the function can take
-	// One thing to note, when the script started the StoreUserFuncs() function checked that the Func
-	// declaration was correct, so if there are optional params (nNumParams < nNumParamsMax) then we can
-	// assume they are properly formatted as $var = literal.
-	ivFuncDecPos = 0;							// Back to the start of the declaration
-	ivFuncDecPos += 3;							// Skip "Func", funcname and "("
-	ivParamPos = 0;								// Back to the start of our parameter list
+	// Optional params (nNumParams < nNumParamsMax) get their default value which is evaluated from
+	// the Func line (it is a literal or macro so the scope doesn't matter)
+	VectorToken	&vFuncDecToks = m_vScriptTokens[nLineNum];
 
-	g_oVarTable.ScopeIncrease();				// Increase scope
+	g_oVarTable.ScopeIncrease(lpFuncDetails->nNumSlots, lpFuncDetails->pnSlotIDs);	// Increase scope (flat frame of local slots)
 
 	// Create new variables with the values we worked out above
-	for (i=1; i<=nNumParamsMax; ++i)
+	for (i=0; i<nNumParamsMax; ++i)
 	{
-		// Is the declaration for this parameter a value or reference?
-		if (vFuncDecToks[ivFuncDecPos].m_nType == TOK_KEYWORD && vFuncDecToks[ivFuncDecPos].nValue == K_BYREF)
+		lpParam = &lpFuncDetails->lpParams[i];
+
+		if (lpParam->bByRef)
 		{
 			// Reference, create a reference
-			++ivFuncDecPos;	// Skip ByRef keyword
-
-			if (g_oVarTable.CreateRef(vFuncDecToks[ivFuncDecPos].szValue, vParams[ivParamPos].pValue() ) == false)
+			if (g_oVarTable.CreateRef(vFuncDecToks[lpParam->ivVar], vParams[i].pValue() ) == false)
 			{
-				FatalError(IDS_AUT_E_VARNOTFOUND, vFuncDecToks[ivFuncDecPos].m_nCol);
+				FatalError(IDS_AUT_E_VARNOTFOUND, vFuncDecToks[lpParam->ivVar].m_nCol);
 				return AUT_ERR;
 			}
-			ivFuncDecPos += 2;					// Skip $varname and comma
 		}
-		else
+		else if (i >= nNumParams)
 		{
-			// Passed value, or use default value
-			if (i > nNumParams)
-			{
-				// We need to use a default value, we CAN assume that tokens are - "$var = [+ -] literal"
-				VectorToken	vTempExp;
-				uint		ivTempExpPos = 0;
-
-				// Optional sign?
-				if (vFuncDecToks[ivFuncDecPos+2].m_nType == TOK_MINUS || vFuncDecToks[ivFuncDecPos+2].m_nType == TOK_PLUS)
-				{
-					vTempExp.push_back( vFuncDecToks[ivFuncDecPos+2] );	// Sign
-					vTempExp.push_back( vFuncDecToks[ivFuncDecPos+3] );	// Literal
-				}
-				else
-					vTempExp.push_back( vFuncDecToks[ivFuncDecPos+2] );	// Literal
-
-				// Add END token
-				tok.settype(TOK_END);						// Add an END token to our buffer
-				vTempExp.push_back(tok);
+			// Use the default value
+			ivDefault = lpParam->ivDefault;
+			Parser_EvaluateExpression(vFuncDecToks, ivDefault, vTemp, true);
 
-				// Evaluate this simple expression
-				Parser_EvaluateExpression(vTempExp, ivTempExpPos, vTemp);
-
-				g_oVarTable.Assign(vFuncDecToks[ivFuncDecPos].szValue, vTemp, false, VARTABLE_FORCELOCAL);
-			}
-			else
-			{
-				// Value
-				g_oVarTable.Assign(vFuncDecToks[ivFuncDecPos].szValue, vParams[ivParamPos], false, VARTABLE_FORCELOCAL);
-			}
-
-			// We need to skip either 2 places ($var ,) or if the declaration contained a default then we
-			// skip 4/5 places ($var = [+ -] literal ,)
-			if (vFuncDecToks[ivFuncDecPos+1].m_nType == TOK_EQUAL)
-			{
-				if (vFuncDecToks[ivFuncDecPos+2].m_nType == TOK_MINUS || vFuncDecToks[ivFuncDecPos+2].m_nType == TOK_PLUS)
-					ivFuncDecPos += 5;			// Skip ($var = +/- literal ,)
-				else
-					ivFuncDecPos += 4;			// Skip ($var = literal ,)
-			}
-			else
-				ivFuncDecPos += 2;				// Skip ($var ,)
+			g_oVarTable.Assign(vFuncDecToks[lpParam->ivVar], vTemp, false, VARTABLE_FORCELOCAL);
+		}
+		else
+		{
+			// Value
+			g_oVarTable.Assign(vFuncDecToks[lpParam->ivVar], vParams[i], false, VARTABLE_FORCELOCAL);
 		}
-
-		++ivParamPos;							// Next param
 
 	} // End For
 
@@ -601,7 +477,7 @@ AUT_RESULT AutoIt_Script::Parser_UserFunctionCall(VectorToken &vLineToks, uint &
 	SetFuncErrorCode(0);						// As with built in functions, reset the @error values
 	SetFuncExtCode(0);
 	SaveExecute(nLineNum+1, false, false);		// Save state and run the user function (line after the Func declaration)
-	vResult = m_vUserRetVal;					// Get the return value
+	vResult.Swap(m_vUserRetVal);				// Get the return value (without copying it)
 
 	// Pop the function
 	m_StatementStack.pop();
@@ -676,14 +552,15 @@ void AutoIt_Script::Parser_StartWithVariable(VectorToken &vLineToks, uint &ivPos
 	Variant *pvTemp;
 	bool	bConst = false;
 	bool	bNeedToCreate = false;
+	bool	bAppend;
 
 
-	// Get the name of the result variable
-	AString sVarName = vLineToks[ivPos].szValue;
+	// Get the result variable token
+	const Token &tokVar = vLineToks[ivPos];
 
 	// Get a reference to the variable, if it doesn't exist, then create it.  If the
 	// variable is a constant then give an error
-	g_oVarTable.GetRef(sVarName, &pvTemp, bConst);
+	g_oVarTable.GetRef(tokVar, &pvTemp, bConst);
 	if (pvTemp == NULL)
 	{
 		// Variable does not exist yet
@@ -702,6 +579,11 @@ void AutoIt_Script::Parser_StartWithVariable(VectorToken &vLineToks, uint &ivPos
 			FatalError(IDS_AUT_E_ARRAYUSEDNODIM, vLineToks[ivPos].m_nCol);
 			return;
 		}
+		else if (vLineToks[ivPos+1].m_nType == TOK_CONCATEQUAL)
+		{
+			FatalError(IDS_AUT_E_VARNOTFOUND, vLineToks[ivPos].m_nCol);	// Nothing to append to
+			return;
+		}
 		else
 		{
 			// Non array - we need to create the variable
@@ -732,8 +614,9 @@ void AutoIt_Script::Parser_StartWithVariable(VectorToken &vLineToks, uint &ivPos
 
 	}
 
-	// Next token must be equals, followed by an expression
-	if ( vLineToks[ivPos].m_nType != TOK_EQUAL )
+	// Next token must be equals (or &= to append), followed by an expression
+	bAppend = (vLineToks[ivPos].m_nType == TOK_CONCATEQUAL);
+	if ( vLineToks[ivPos].m_nType != TOK_EQUAL && !bAppend )
 	{
 		FatalError(IDS_AUT_E_EXPECTEDASSIGNMENT, vLineToks[ivPos].m_nCol);
 		return;
@@ -755,12 +638,17 @@ void AutoIt_Script::Parser_StartWithVariable(VectorToken &vLineToks, uint &ivPos
 	if (bNeedToCreate)
 	{
 		Variant vTempCreate;
-		g_oVarTable.Assign(sVarName, vTempCreate);
-		g_oVarTable.GetRef(sVarName, &pvTemp, bConst);
+		g_oVarTable.Assign(tokVar, vTempCreate);
+		g_oVarTable.GetRef(tokVar, &pvTemp, bConst);
 	}
 
-	// Change the value in the variable table to this resulting value
-	*pvTemp = vTemp;
+	// Change the value in the variable table to this resulting value (vTemp
+	// is finished with so move it rather than copy).  For &= append in place
+	// so that building a large string doesn't copy it every time.
+	if (bAppend)
+		pvTemp->Concat(vTemp);
+	else
+		pvTemp->Swap(vTemp);
 
 } // Parser_StartWithVariable()
 
@@ -878,14 +766,10 @@ void AutoIt_Script::Parser_StartWithKeyword(VectorToken &vLineToks, uint &ivPos,
 void AutoIt_Script::Parser_Keyword_IF(VectorToken &vLineToks, uint &ivPos, int &nScriptLine)
 {
 	bool			bCondition;
-	VectorToken	vIFToks;
 	uint			ivTempPos;					// Position in the vector
 	GenStatement	tIFDetails;
-	int				nIfCount;					// Keep track of number of nested IF statements
-	bool			bElseFound = false;
-	bool			bEndIfFound = false;
-	const char		*szTempScriptLine;
-	int				nLineToExecute = 0;
+	int				nLinkLine;					// Current ELSEIF/ELSE line in the chain
+	int				nLineToExecute;
 
 	// Zero our IF statement
 	tIFDetails.nType	= L_IF;					// Not actually used for IF, but whatever
@@ -909,17 +793,10 @@ void AutoIt_Script::Parser_Keyword_IF(VectorToken &vLineToks, uint &ivPos, int &
 	if (vLineToks[ivPos].m_nType != TOK_END)
 	{
 		// There is something else on the line, we assume it is a single line IF statement.
-		// So we generate a new set of tokens from here to the end and recursively call
-		// the parser again...eeek.  Only if the condition was true of course!
+		// So we recursively call the parser on the rest of the line...eeek.  Only if the
+		// condition was true of course!
 		if (bCondition)
-		{
-			while (vLineToks[ivPos].m_nType != TOK_END)
-				vIFToks.push_back(vLineToks[ivPos++]);
-
-			vIFToks.push_back(vLineToks[ivPos]);	// And the end token as well :)
-
-			Parser(vIFToks, nScriptLine);			// Run the parser on this as a "new line"
-		}
+			Parser(vLineToks, nScriptLine, ivPos);	// Run the parser from here as a "new line"
 
 		return;
 	}
@@ -928,140 +805,61 @@ void AutoIt_Script::Parser_Keyword_IF(VectorToken &vLineToks, uint &ivPos, int &
 	// Block IF statment if we are here
 
 
-	// Store the line number of the IF statement
-	tIFDetails.nIf = nScriptLine - 1;
+	// Store the line numbers of the IF and its EndIf (from the jump table built on load)
+	tIFDetails.nIf		= nScriptLine - 1;
+	tIFDetails.nEndIf	= m_BlockJumps[tIFDetails.nIf].nEnd;
 
 	// If the main condition was true set the current line to be the one to execute (current line is line after IF)
+	// Otherwise by default continue on the EndIf line itself so that the IFstack unwinds itself properly
+	// after the PUSH at the end of this function
 	if (bCondition)
 		nLineToExecute = nScriptLine;
-
-
-	// Look for an ELSE and/or ENDIF statement (skipping nested IFs)
-	nIfCount = 0;
-
-	while ( (szTempScriptLine = g_oScriptFile.GetLine(nScriptLine++)) != NULL
-			&& bEndIfFound == false)
+	else
 	{
-		Lexer(nScriptLine-1, szTempScriptLine, vIFToks);
+		nLineToExecute = tIFDetails.nEndIf;
 
-		ivTempPos = 0;
+		// Walk the ELSEIF/ELSE chain for this IF (nested IFs are already skipped by the table)
+		nLinkLine = m_BlockJumps[tIFDetails.nIf].nNext;
 
-		if (vIFToks[ivTempPos].m_nType == TOK_KEYWORD)
+		while (nLinkLine != tIFDetails.nEndIf)
 		{
-			switch (vIFToks[ivTempPos].nValue)
-			{
-				case K_IF:
-					// Nested IF
-					// We can also have a groups of single line ifs on the same line, so check for a THEN
-					// keywords - if it is followed by END then class as a nested IF, otherwise keep searching
-					// and if we get to the end then it is NOT a nested if, it is just a single line IF
-					while(++ivTempPos < (uint)vIFToks.size())
-					{
-						if (vIFToks[ivTempPos].m_nType == TOK_KEYWORD && vIFToks[ivTempPos].nValue == K_THEN)
-						{
-							// If the next token is END then this is nested
-							if (vIFToks[ivTempPos+1].m_nType == TOK_END)
-							{
-								++nIfCount;		// Increased nested IF count
-								break;			// Exit the while loop
-							}
-						}
-					}
-					break;
-
-				case K_ELSE:
-					// Ignore if this is a nested IF
-					if (nIfCount != 0 )
-						break;
-
-					// Check the we haven't already had an ELSE for this IF
-					if (bElseFound == true)
-					{
-						FatalError(IDS_AUT_E_TOOMANYELSE);
-						return;
-					}
-
-					bElseFound = true;			// We have found the single else for this IF
-
-					// Next token must be TOK_END
-					++ivTempPos;
-					if (vIFToks[ivTempPos].m_nType != TOK_END)
-					{
-						m_nErrorLine = nScriptLine - 1;	// So the error message is correct
-						FatalError(IDS_AUT_E_EXTRAONLINE, vIFToks[ivTempPos].m_nCol);
-						return;
-					}
-
-					// If the main IF condition was true, we don't do anything else
-					if (bCondition)
-						break;
-
-					// Set the line to execute as the current one (line after the ELSE)
-					nLineToExecute = nScriptLine;
-
-					break;
-
-				case K_ELSEIF:
-					// Ignore if this is a nested IF
-					if (nIfCount != 0)
-						break;
-
-					// Check the we haven't already had an ELSE for this IF
-					if (bElseFound == true)
-					{
-						FatalError(IDS_AUT_E_TOOMANYELSE);
-						return;
-					}
-
-					// If the main IF condition was true, we don't do anything else
-					 if (bCondition)
-						 break;
+			m_nErrorLine = nLinkLine;			// So any error message is correct from the evalcondition below
 
-					++ivTempPos;									// Skip keyword and evaluate condition
+			VectorToken	&vIFToks = m_vScriptTokens[nLinkLine];
 
-					m_nErrorLine = nScriptLine - 1;	// So any error message is correct from the evalcondition below
+			ivTempPos = 0;
 
-					if ( AUT_FAILED( Parser_EvaluateCondition(vIFToks, ivTempPos, bCondition) ) )
-						return;
-
-					// For a valid statement, next token after expression must be "then" keyword
-					if ( !(vIFToks[ivTempPos].m_nType == TOK_KEYWORD && vIFToks[ivTempPos].nValue == K_THEN) )
-					{
-						m_nErrorLine = nScriptLine - 1;	// So the error message is correct
-						FatalError(IDS_AUT_E_MISSINGTHEN, vIFToks[ivTempPos].m_nCol);
-						return;
-					}
+			// ELSE - always taken (the only thing that can follow it is the EndIf)
+			if (vIFToks[ivTempPos].nValue == K_ELSE)
+			{
+				nLineToExecute = nLinkLine + 1;	// Line after the ELSE
+				break;
+			}
 
-					// If condition was true, set current line to execute (line after the elseif)
-					if (bCondition)
-						nLineToExecute = nScriptLine;
+			// ELSEIF
+			++ivTempPos;						// Skip keyword and evaluate condition
 
-					break;
+			if ( AUT_FAILED( Parser_EvaluateCondition(vIFToks, ivTempPos, bCondition) ) )
+				return;
 
-				case K_ENDIF:
-					if (nIfCount == 0)
-					{
-						bEndIfFound = true;		// Stop the main While loop
-						tIFDetails.nEndIf = nScriptLine - 1;
-
-						// If the condition is false and no Else processed then set current line to execute as the EndIf
-						// Must set it to the EndIf (and not the line after) so that the IFstack unwinds itself properly
-						// after the PUSH at the end of this function.
-						// If the condition was true, or an Else was found then the next line to execute will have been handled already
-						if (bCondition == false && bElseFound == false)
-							nLineToExecute = nScriptLine - 1;	// The EndIf line
-					}
-					else
-						nIfCount--;
+			// For a valid statement, next token after expression must be "then" keyword
+			if ( !(vIFToks[ivTempPos].m_nType == TOK_KEYWORD && vIFToks[ivTempPos].nValue == K_THEN) )
+			{
+				FatalError(IDS_AUT_E_MISSINGTHEN, vIFToks[ivTempPos].m_nCol);
+				return;
+			}
 
-					break;
+			// If condition was true, set current line to execute (line after the elseif)
+			if (bCondition)
+			{
+				nLineToExecute = nLinkLine + 1;
+				break;
 			}
+
+			nLinkLine = m_BlockJumps[nLinkLine].nNext;
 		}
 	}
 
-	// Did we process a valid If statement (bEndIfFound must be true)
-	// Update: no longer need to check if we found an EndIf as all blocks are checked at load time
-
 	nScriptLine = nLineToExecute;
 
 	// Push details of this IF statement on the stack for later use
@@ -1128,12 +926,7 @@ void AutoIt_Script::Parser_Keyword_ENDIF(VectorToken &vLineToks, uint &ivPos)
 void AutoIt_Script::Parser_Keyword_WHILE(VectorToken &vLineToks, uint &ivPos, int &nScriptLine)
 {
 	bool			bCondition;
-	VectorToken		vWhileToks;
-	uint			ivTempPos;					// Position in the vector
 	GenStatement	tWHILEDetails;
-	int				nWhileCount;				// Keep track of number of nested WHILE statements
-	bool			bWendFound = false;
-	const char		*szTempScriptLine;
 
 
 	// Zero our WHILE statement
@@ -1151,43 +944,9 @@ void AutoIt_Script::Parser_Keyword_WHILE(VectorToken &vLineToks, uint &ivPos, in
 		return;
 	}
 
-	// Store the line number of the WHILE statement
-	tWHILEDetails.nLoopStart = nScriptLine - 1;
-
-	// Look for an WEND statement (skipping nested WHILESs)
-	nWhileCount = 0;
-
-	while ( (szTempScriptLine = g_oScriptFile.GetLine(nScriptLine++)) != NULL
-			&& bWendFound == false)
-	{
-		Lexer(nScriptLine-1, szTempScriptLine, vWhileToks);
-
-		ivTempPos = 0;
-
-		if (vWhileToks[ivTempPos].m_nType == TOK_KEYWORD)
-		{
-			switch (vWhileToks[ivTempPos].nValue)
-			{
-				case K_WHILE:
-					// Nested WHILE
-					++nWhileCount;
-					break;
-
-				case K_WEND:
-					if (nWhileCount == 0)
-					{
-						bWendFound = true;
-						tWHILEDetails.nLoopEnd = nScriptLine - 1;
-					}
-					else
-						nWhileCount--;
-					break;
-			}
-		}
-	}
-
-	// Did we process a valid While statement (bWendFound must be true)
-	// Update - (No longer need this check, blocks verified on load)
+	// Store the line number of the WHILE statement and its matching WEND
+	tWHILEDetails.nLoopStart	= nScriptLine - 1;
+	tWHILEDetails.nLoopEnd		= m_BlockJumps[tWHILEDetails.nLoopStart].nEnd;
 
 	// Set the next line to execute depending on the evaluation of the condition
 	if (bCondition)
@@ -1371,12 +1130,7 @@ void AutoIt_Script::Parser_Keyword_CONTINUELOOP(VectorToken &vLineToks, uint &iv
 
 void AutoIt_Script::Parser_Keyword_DO(VectorToken &vLineToks, uint &ivPos, int &nScriptLine)
 {
-	VectorToken		vDoToks;
-	uint			ivTempPos;					// Position in the vector
 	GenStatement	tDODetails;
-	int				nDoCount;					// Keep track of number of nested DO statements
-	bool			bUntilFound = false;
-	const char		*szTempScriptLine;
 
 
 	// Zero our DO statement
@@ -1391,43 +1145,9 @@ void AutoIt_Script::Parser_Keyword_DO(VectorToken &vLineToks, uint &ivPos, int &
 		return;
 	}
 
-	// Store the line number of the DO statement
-	tDODetails.nLoopStart = nScriptLine - 1;
-
-	// Look for an UNTIL statement (skipping nested DOs)
-	nDoCount = 0;
-
-	while ( (szTempScriptLine = g_oScriptFile.GetLine(nScriptLine++)) != NULL
-			&& bUntilFound == false)
-	{
-		Lexer(nScriptLine-1, szTempScriptLine, vDoToks);
-
-		ivTempPos = 0;
-
-		if (vDoToks[ivTempPos].m_nType == TOK_KEYWORD)
-		{
-			switch (vDoToks[ivTempPos].nValue)
-			{
-				case K_DO:
-					// Nested DO
-					++nDoCount;
-					break;
-
-				case K_UNTIL:
-					if (nDoCount == 0)
-					{
-						bUntilFound = true;
-						tDODetails.nLoopEnd = nScriptLine - 1;	// Store line of UNTIL statement
-					}
-					else
-						nDoCount--;
-					break;
-			}
-		}
-	}
-
-	// Did we process a valid UNTIL statement (bUntilFound must be true)
-	// (No longer need this check, blocks verified on load)
+	// Store the line number of the DO statement and its matching UNTIL
+	tDODetails.nLoopStart	= nScriptLine - 1;
+	tDODetails.nLoopEnd		= m_BlockJumps[tDODetails.nLoopStart].nEnd;
 
 	// Push details of this DO statement on the stack for later use
 	m_StatementStack.push(tDODetails);
@@ -1486,13 +1206,7 @@ void AutoIt_Script::Parser_Keyword_UNTIL(VectorToken &vLineToks, uint &ivPos, in
 
 void AutoIt_Script::Parser_Keyword_FOR(VectorToken &vLineToks, uint &ivPos, int &nScriptLine)
 {
-	VectorToken		vForToks;
-	uint			ivTempPos;					// Position in the vector
 	GenStatement	tFORDetails;
-	int				nForCount;					// Keep track of number of nested FOR statements
-	bool			bNextFound = false;
-	const char		*szTempScriptLine;
-	AString			sVarName;
 	Variant			*pvTemp;
 	bool			bConst = false;
 	Variant			vTemp;
@@ -1510,18 +1224,18 @@ void AutoIt_Script::Parser_Keyword_FOR(VectorToken &vLineToks, uint &ivPos, int
 		return;
 	}
 
-	sVarName = vLineToks[ivPos].szValue;
+	const Token &tokVar = vLineToks[ivPos];
 	++ivPos;									// Skip variable name
 
 	// Get a reference to the variable (must be a local), if it doesn't exist, then create it as a local.
 	// If the variable is a constant then don't allow it either. Note: Even in Opt("MustDeclareVars") mode
 	// we allow the automatic creation here.
-	g_oVarTable.GetRef(sVarName, &pvTemp, bConst, VARTABLE_FORCELOCAL);
+	g_oVarTable.GetRef(tokVar, &pvTemp, bConst, VARTABLE_FORCELOCAL);
 	if (pvTemp == NULL)
 	{
 		vTemp = 0;
-		g_oVarTable.Assign(sVarName, vTemp, false, VARTABLE_FORCELOCAL);
-		g_oVarTable.GetRef(sVarName, &pvTemp, bConst, VARTABLE_FORCELOCAL);
+		g_oVarTable.Assign(tokVar, vTemp, false, VARTABLE_FORCELOCAL);
+		g_oVarTable.GetRef(tokVar, &pvTemp, bConst, VARTABLE_FORCELOCAL);
 	}
 	else if (bConst)
 	{
@@ -1592,40 +1306,8 @@ void AutoIt_Script::Parser_Keyword_FOR(VectorToken &vLineToks, uint &ivPos, int
 //	}
 
 
-	// Look for an NEXT statement (skipping nested FORs)
-	nForCount = 0;
-
-	while ( (szTempScriptLine = g_oScriptFile.GetLine(nScriptLine++)) != NULL
-			&& bNextFound == false)
-	{
-		Lexer(nScriptLine-1, szTempScriptLine, vForToks);
-
-		ivTempPos = 0;
-
-		if (vForToks[ivTempPos].m_nType == TOK_KEYWORD)
-		{
-			switch (vForToks[ivTempPos].nValue)
-			{
-				case K_FOR:
-					// Nested FOR
-					++nForCount;
-					break;
-
-				case K_NEXT:
-					if (nForCount == 0)
-					{
-						bNextFound = true;
-						tFORDetails.nLoopEnd = nScriptLine - 1;	// Store line # for NEXT statement
-					}
-					else
-						nForCount--;
-					break;
-			}
-		}
-	}
-
-	// Did we process a valid FOR statement (bNextFound must be true)
-	// (No longer need this check, blocks verified on load)
+	// Get the line of the matching NEXT statement (from the jump table built on load)
+	tFORDetails.nLoopEnd = m_BlockJumps[tFORDetails.nLoopStart].nEnd;
 
 	// Even though NEXT evaluates the loop, we must check here as well as it may already be
 	// time to finish the loop (for i = 0 to 0 etc)
@@ -1634,7 +1316,6 @@ void AutoIt_Script::Parser_Keyword_FOR(VectorToken &vLineToks, uint &ivPos, int
 	//		Value			Loop executes if
 	//		Positive or 0	$counter <= end
 	//		Negative		$counter >= end
-	// Note: We must reset nScriptLine as it was mangled above
 	vTemp = 0.0;
 	if ( (tFORDetails.vForStep > vTemp) || (tFORDetails.vForStep == vTemp) )
 	{
@@ -1667,8 +1348,6 @@ void AutoIt_Script::Parser_Keyword_FOR(VectorToken &vLineToks, uint &ivPos, int
 void AutoIt_Script::Parser_Keyword_NEXT(VectorToken &vLineToks, uint &ivPos, int &nScriptLine)
 {
 	GenStatement	tFORDetails;
-	VectorToken		vForToks;
-	const char		*szTempScriptLine;
 	Variant			*pvTemp;
 	bool			bConst = false;
 	Variant			vTemp;
@@ -1692,13 +1371,11 @@ void AutoIt_Script::Parser_Keyword_NEXT(VectorToken &vLineToks, uint &ivPos, int
 	m_StatementStack.pop();					// Remove it from stack (we will push back on if required)
 
 
-	// Now we have to read in the for line in order to get the variable name - we know that
-	// the for structure is perfect so we can go right to the token we need and assume that
-	// it is a valid and assigned variable
-	szTempScriptLine = g_oScriptFile.GetLine(tFORDetails.nLoopStart);
-	Lexer(tFORDetails.nLoopStart, szTempScriptLine, vForToks);
-	AString sVarName = vForToks[1].szValue;	// FOR = 0, Var = 1,
-	g_oVarTable.GetRef(sVarName, &pvTemp, bConst);
+	// Now we have to look at the tokens of the for line in order to get the variable name - we
+	// know that the for structure is perfect so we can go right to the token we need and assume
+	// that it is a valid and assigned variable
+	const Token &tokVar = m_vScriptTokens[tFORDetails.nLoopStart][1];	// FOR = 0, Var = 1,
+	g_oVarTable.GetRef(tokVar, &pvTemp, bConst);
 
 
 	(*pvTemp) += tFORDetails.vForStep;	// Increment with the STEP value
@@ -1742,15 +1419,9 @@ void AutoIt_Script::Parser_Keyword_NEXT(VectorToken &vLineToks, uint &ivPos, int
 
 void AutoIt_Script::Parser_Keyword_SELECT(VectorToken &vLineToks, uint &ivPos, int &nScriptLine)
 {
-	VectorToken	vSELECTToks;
 	uint			ivTempPos;					// Position in the vector
 	GenStatement	tSELECTDetails;
-	int				nSelectCount;				// Keep track of number of nested SELECT statements
-	bool			bCaseFound = false;
-	bool			bCaseExecuted = false;
-	bool			bEndSelectFound = false;
-	int				nCaseToExecute = 1;
-	const char		*szTempScriptLine;
+	int				nCaseLine;					// Current CASE line in the chain
 	bool			bCondition;
 
 
@@ -1766,97 +1437,54 @@ void AutoIt_Script::Parser_Keyword_SELECT(VectorToken &vLineToks, uint &ivPos, i
 		return;
 	}
 
-	// Store the line number of the SELECT statement
-	tSELECTDetails.nSelect = nScriptLine - 1;
+	// Store the line number of the SELECT statement and its EndSelect (from the jump table built
+	// on load - which has also checked that there is at least one CASE statement)
+	tSELECTDetails.nSelect		= nScriptLine - 1;
+	tSELECTDetails.nEndSelect	= m_BlockJumps[tSELECTDetails.nSelect].nEnd;
 
-	// Look for an CASE and/or ENDSELECT statement (skipping nested SELECTs)
-	nSelectCount = 0;
+	m_StatementStack.push(tSELECTDetails);			// Push this select statement onto the stack
+
+	// Walk the CASE chain for this SELECT (nested SELECTs are already skipped by the table)
+	nCaseLine = m_BlockJumps[tSELECTDetails.nSelect].nNext;
 
-	while ( (szTempScriptLine = g_oScriptFile.GetLine(nScriptLine++)) != NULL
-	   && bEndSelectFound == false)
+	while (nCaseLine != tSELECTDetails.nEndSelect)
 	{
-		m_nErrorLine = nScriptLine-1;			// So any errors in case statements look correct
+		m_nErrorLine = nCaseLine;				// So any errors in case statements look correct
 
-		Lexer(nScriptLine-1, szTempScriptLine, vSELECTToks);
+		VectorToken	&vSELECTToks = m_vScriptTokens[nCaseLine];
 
-		ivTempPos = 0;
+		ivTempPos = 1;							// Skip CASE keyword
 
-		if (vSELECTToks[ivTempPos].m_nType == TOK_KEYWORD)
+		// Is this the default case?
+		if (vSELECTToks[ivTempPos].m_nType == TOK_KEYWORD && vSELECTToks[ivTempPos].nValue == K_ELSE)
 		{
-			switch (vSELECTToks[ivTempPos].nValue)
-			{
-				case K_SELECT:
-					// Nested SELECT
-					++nSelectCount;
-					break;
-
-				case K_CASE:
-					// Ignore if this is a nested SELECT, or a CASE statement has already been selected
-					// for execution
-					if (nSelectCount == 0 && bCaseExecuted == false)
-					{
-						bCaseFound = true;
-
-						// Evaluate the condition
-						++ivTempPos;			// Skip CASE keyword
-
-						// Is this the default case?
-						if (vSELECTToks[ivTempPos].m_nType == TOK_KEYWORD && vSELECTToks[ivTempPos].nValue == K_ELSE)
-						{
-							bCondition = true;	// Default case always matches
-							++ivTempPos;		// Skip Default
-						}
-						else
-						{
-							if ( AUT_FAILED( Parser_EvaluateCondition(vSELECTToks, ivTempPos, bCondition) ) )
-								return;
-						}
-
-						// Next token must be END (otherwise there is other crap on the line)
-						if (vSELECTToks[ivTempPos].m_nType != TOK_END)
-						{
-							FatalError(IDS_AUT_E_EXTRAONLINE, vSELECTToks[ivTempPos].m_nCol);
-							return;
-						}
-
-						if (bCondition)
-						{
-							bCaseExecuted = true;
-							// Continue execution on line after this Case statement
-							nCaseToExecute = nScriptLine;
-						}
-					}
-					break;
-
-				case K_ENDSELECT:
-					if (nSelectCount == 0)
-					{
-						bEndSelectFound = true;
-						tSELECTDetails.nEndSelect = nScriptLine - 1;
-					}
-					else
-						nSelectCount--;
-					break;
-			}
+			bCondition = true;					// Default case always matches
+			++ivTempPos;						// Skip Default
+		}
+		else
+		{
+			if ( AUT_FAILED( Parser_EvaluateCondition(vSELECTToks, ivTempPos, bCondition) ) )
+				return;
 		}
-	}
 
-	// Did we process a valid EndSelect statement and were there 1+ case statements?
-	if (bEndSelectFound == false || bCaseFound == false)
-	{
-		m_nErrorLine = tSELECTDetails.nSelect;		// Make the error look correct
-		FatalError(IDS_AUT_E_MISSINGENDSELECTORCASE);
-		return;
-	}
+		// Next token must be END (otherwise there is other crap on the line)
+		if (vSELECTToks[ivTempPos].m_nType != TOK_END)
+		{
+			FatalError(IDS_AUT_E_EXTRAONLINE, vSELECTToks[ivTempPos].m_nCol);
+			return;
+		}
 
+		if (bCondition)
+		{
+			nScriptLine = nCaseLine + 1;		// Continue execution on line after selected case statement
+			return;
+		}
 
-	m_StatementStack.push(tSELECTDetails);			// Push this select statement onto the stack
+		nCaseLine = m_BlockJumps[nCaseLine].nNext;
+	}
 
-	// Are we going to execute any of the case statements?
-	if (bCaseExecuted)
-		nScriptLine = nCaseToExecute;				// Continue execution on line after selected case statement
-	else
-		nScriptLine = tSELECTDetails.nEndSelect;	// Continue on the EndSelect keyword
+	// No case statements matched, continue on the EndSelect keyword
+	nScriptLine = tSELECTDetails.nEndSelect;
 
 } // Parser_Keyword_SELECT()
 
@@ -1920,7 +1548,6 @@ void AutoIt_Script::Parser_Keyword_ENDSELECT(VectorToken &vLineToks, uint &ivPos
 void AutoIt_Script::Parser_Keyword_DIM(VectorToken &vLineToks, uint &ivPos, int nReqScope)
 {
 	Variant			vTemp;
-	Variant			vOld;	// stores the array during resizing
 	Variant			*pvTemp;
 	bool			bConst = false;
 	int				nNumSubscripts;
@@ -1949,8 +1576,8 @@ void AutoIt_Script::Parser_Keyword_DIM(VectorToken &vLineToks, uint &ivPos, int
 		}
 
 		// Get a reference to the variable in the requested scope, if it doesn't exist, then create it.
-		AString sVarName = vLineToks[ivPos].szValue;
-		g_oVarTable.GetRef(sVarName, &pvTemp, bConst, nReqScope);
+		const Token &tokVar = vLineToks[ivPos];
+		g_oVarTable.GetRef(tokVar, &pvTemp, bConst, nReqScope);
 		if (pvTemp == NULL)
 		{
 			if (bReDim)
@@ -1961,8 +1588,8 @@ void AutoIt_Script::Parser_Keyword_DIM(VectorToken &vLineToks, uint &ivPos, int
 			}
 
 			vTemp = "";								// Let the uninitialised value be "" (equates to 0.0 for numbers)
-			g_oVarTable.Assign(sVarName, vTemp, false, nReqScope);
-			g_oVarTable.GetRef(sVarName, &pvTemp, bConst, nReqScope);
+			g_oVarTable.Assign(tokVar, vTemp, false, nReqScope);
+			g_oVarTable.GetRef(tokVar, &pvTemp, bConst, nReqScope);
 		}
 		else if (bConst)
 		{
@@ -1986,10 +1613,6 @@ void AutoIt_Script::Parser_Keyword_DIM(VectorToken &vLineToks, uint &ivPos, int
 		if (vLineToks[ivPos].m_nType == TOK_LEFTSUBSCRIPT)
 		{
 			// Read the subscripts
-			// Store the old value while the it is resized.
-			if (bReDim)
-				vOld = *pvTemp;
-
 			nNumSubscripts = 0;
 			nColTemp = vLineToks[ivPos].m_nCol;		// Store for error output
 			while (vLineToks[ivPos].m_nType == TOK_LEFTSUBSCRIPT)
@@ -2044,17 +1667,13 @@ void AutoIt_Script::Parser_Keyword_DIM(VectorToken &vLineToks, uint &ivPos, int
 				}
 			}
 
-			// Ok, valid subscripts, dimension the variant into an array
-			if ( pvTemp->ArrayDim() == false )
+			// Ok, valid subscripts, dimension the variant into an array (ReDim keeps the old values)
+			if ( (bReDim ? pvTemp->ArrayReDim() : pvTemp->ArrayDim()) == false )
 			{
 				FatalError(IDS_AUT_E_ARRAYALLOC, nColTemp);
 				return;
 			}
 
-			// copy old array values into new array
-			if (bReDim && vOld.ArrayGetBound(0)>0)
-				pvTemp->ArrayCopy(vOld);
-
 		} // TOK_LEFTSUBSCRIPT
 		else if (vLineToks[ivPos].m_nType == TOK_EQUAL)
 		{
@@ -2112,14 +1731,14 @@ void AutoIt_Script::Parser_Keyword_CONST(VectorToken &vLineToks, uint &ivPos, in
 		}
 
 		// Get a reference to the variable in the requested scope, if it doesn't exist, then create it.
-		AString sVarName = vLineToks[ivPos].szValue;
-		g_oVarTable.GetRef(sVarName, &pvTemp, bConst, nReqScope);
+		const Token &tokVar = vLineToks[ivPos];
+		g_oVarTable.GetRef(tokVar, &pvTemp, bConst, nReqScope);
 		if (pvTemp == NULL)
 		{
 			// Doesn't already exist
 			vTemp = "";								// Let the uninitialised value be "" (equates to 0.0 for numbers)
-			g_oVarTable.Assign(sVarName, vTemp, true, nReqScope);
-			g_oVarTable.GetRef(sVarName, &pvTemp, bConst, nReqScope);
+			g_oVarTable.Assign(tokVar, vTemp, true, nReqScope);
+			g_oVarTable.GetRef(tokVar, &pvTemp, bConst, nReqScope);
 		}
 		else
 		{
@@ -2241,13 +1860,16 @@ void AutoIt_Script::Parser_Keyword_EXIT(VectorToken &vLineToks, uint &ivPos)
 // Wend
 // Until 1 = 1
 //
+// While checking it builds the block jump table (m_BlockJumps) so that the
+// keyword handlers can jump straight to the matching ELSEIF/ELSE/ENDIF,
+// WEND, UNTIL, NEXT, CASE and ENDSELECT lines without scanning for them.
+//
 ///////////////////////////////////////////////////////////////////////////////
 
 AUT_RESULT AutoIt_Script::Parser_VerifyBlockStructure(void)
 {
 	uint			ivPos;
 	uint			ivLast;						// Last non-end position
-	VectorToken	LineTokens;					// Vector (array) of tokens for a line of script
 	int				nScriptLine = 1;			// 1 = first line
 	const char		*szScriptLine;
 	bool			bThen;
@@ -2269,18 +1891,36 @@ AUT_RESULT AutoIt_Script::Parser_VerifyBlockStructure(void)
 	int				nSeqTst;
 
 	int				nKey;
+	int				nLine;						// Current line number
+
+	// Line numbers of the open blocks, used to build the jump table.  The "Last" stacks
+	// hold the most recent IF/ELSEIF/ELSE or SELECT/CASE line of the innermost block
+	StackInt		stkIfLine, stkIfLast, stkIfElse;
+	StackInt		stkSelectLine, stkSelectLast;
+	StackInt		stkWhileLine;
+	StackInt		stkForLine;
+	StackInt		stkDoLine;
+
+
+	// Create a blank jump table (line numbers are 1 based)
+	delete [] m_BlockJumps;
+	m_BlockJumps = new BlockJump[g_oScriptFile.GetNumScriptLines() + 1];
+	for (nLine = 0; nLine <= g_oScriptFile.GetNumScriptLines(); ++nLine)
+	{
+		m_BlockJumps[nLine].nNext	= 0;
+		m_BlockJumps[nLine].nEnd	= 0;
+	}
 
 
 	// Read in each line of the script
 	while ( (szScriptLine = g_oScriptFile.GetLine(nScriptLine)) != NULL )
 	{
 		m_nErrorLine = nScriptLine;				// Keep track for errors
+		nLine = nScriptLine;
 		++nScriptLine;							// Next line
 
-		// Convert the line
-
-		if ( AUT_FAILED( Lexer(nScriptLine-1, szScriptLine, LineTokens) ) )
-			return AUT_ERR;						// Bad line
+		// Get the tokens for the line (lexed in InitScript)
+		VectorToken	&LineTokens = m_vScriptTokens[nLine];
 
 		ivPos = 0;
 		ivLast = 0;								// Last non-end token
@@ -2301,21 +1941,26 @@ AUT_RESULT AutoIt_Script::Parser_VerifyBlockStructure(void)
 			case K_DO:
 				++nDo;
 				stkDo.push(nSeq++);
+				stkDoLine.push(nLine);
 				break;
 
 			case K_WHILE:
 				++nWhile;
 				stkWhile.push(nSeq++);
+				stkWhileLine.push(nLine);
 				break;
 
 			case K_FOR:
 				++nFor;
 				stkFor.push(nSeq++);
+				stkForLine.push(nLine);
 				break;
 
 			case K_SELECT:
 				++nSelect;
 				stkSelect.push(nSeq++);
+				stkSelectLine.push(nLine);
+				stkSelectLast.push(nLine);
 				break;
 
 			case K_IF:							// Only take notice of multiline IFs
@@ -2342,6 +1987,9 @@ AUT_RESULT AutoIt_Script::Parser_VerifyBlockStructure(void)
 				{
 					++nIf;
 					stkIf.push(nSeq++);
+					stkIfLine.push(nLine);
+					stkIfLast.push(nLine);
+					stkIfElse.push(0);
 				}
 
 				// There are more tokens left so check that this line does not contain any other
@@ -2390,6 +2038,9 @@ AUT_RESULT AutoIt_Script::Parser_VerifyBlockStructure(void)
 					FatalError(IDS_AUT_E_UNTILNOMATCHINGDO);
 					return AUT_ERR;
 				}
+
+				m_BlockJumps[stkDoLine.top()].nEnd = nLine;
+				stkDoLine.pop();
 				break;
 
 			case K_WEND:
@@ -2408,6 +2059,9 @@ AUT_RESULT AutoIt_Script::Parser_VerifyBlockStructure(void)
 					FatalError(IDS_AUT_E_WENDNOMATCHINGWHILE);
 					return AUT_ERR;
 				}
+
+				m_BlockJumps[stkWhileLine.top()].nEnd = nLine;
+				stkWhileLine.pop();
 				break;
 
 			case K_NEXT:
@@ -2426,6 +2080,9 @@ AUT_RESULT AutoIt_Script::Parser_VerifyBlockStructure(void)
 					FatalError(IDS_AUT_E_NEXTNOMATCHINGFOR);
 					return AUT_ERR;
 				}
+
+				m_BlockJumps[stkForLine.top()].nEnd = nLine;
+				stkForLine.pop();
 				break;
 
 			case K_ENDSELECT:
@@ -2444,6 +2101,19 @@ AUT_RESULT AutoIt_Script::Parser_VerifyBlockStructure(void)
 					FatalError(IDS_AUT_E_ENDSELECTNOMATCHINGSELECT);
 					return AUT_ERR;
 				}
+
+				// Must have had at least one CASE statement
+				if (stkSelectLast.top() == stkSelectLine.top())
+				{
+					m_nErrorLine = stkSelectLine.top();	// Make the error look correct
+					FatalError(IDS_AUT_E_MISSINGENDSELECTORCASE);
+					return AUT_ERR;
+				}
+
+				m_BlockJumps[stkSelectLast.top()].nNext = nLine;
+				m_BlockJumps[stkSelectLine.top()].nEnd = nLine;
+				stkSelectLast.pop();
+				stkSelectLine.pop();
 				break;
 
 			case K_CASE:
@@ -2461,6 +2131,10 @@ AUT_RESULT AutoIt_Script::Parser_VerifyBlockStructure(void)
 					return AUT_ERR;
 				}
 
+				// Link the previous SELECT/CASE line to this one
+				m_BlockJumps[stkSelectLast.top()].nNext = nLine;
+				stkSelectLast.top() = nLine;
+
 				break;
 
 			case K_ENDIF:
@@ -2479,6 +2153,12 @@ AUT_RESULT AutoIt_Script::Parser_VerifyBlockStructure(void)
 					FatalError(IDS_AUT_E_ENDIFNOMATCHINGIF);
 					return AUT_ERR;
 				}
+
+				m_BlockJumps[stkIfLast.top()].nNext = nLine;
+				m_BlockJumps[stkIfLine.top()].nEnd = nLine;
+				stkIfLast.pop();
+				stkIfLine.pop();
+				stkIfElse.pop();
 				break;
 
 			case K_ELSE:
@@ -2488,6 +2168,29 @@ AUT_RESULT AutoIt_Script::Parser_VerifyBlockStructure(void)
 					FatalError(IDS_AUT_E_ELSENOMATCHINGIF);
 					return AUT_ERR;
 				}
+
+				// Nothing may follow the ELSE for this IF
+				if (stkIfElse.top() != 0)
+				{
+					FatalError(IDS_AUT_E_TOOMANYELSE);
+					return AUT_ERR;
+				}
+
+				if (LineTokens[0].nValue == K_ELSE)
+				{
+					// Next token must be TOK_END
+					if (LineTokens[1].m_nType != TOK_END)
+					{
+						FatalError(IDS_AUT_E_EXTRAONLINE, LineTokens[1].m_nCol);
+						return AUT_ERR;
+					}
+
+					stkIfElse.top() = 1;
+				}
+
+				// Link the previous IF/ELSEIF line to this one
+				m_BlockJumps[stkIfLast.top()].nNext = nLine;
+				stkIfLast.top() = nLine;
 				break;
 
 			case K_CONTINUELOOP:
@@ -338,7 +338,7 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateVariable(VectorToken &vLineToks, unsign
 	Variant		vTemp;
 
 	// Get a reference to the variant
-	g_oVarTable.GetRef(vLineToks[ivPos].szValue, &pvTemp, bConst);
+	g_oVarTable.GetRef(vLineToks[ivPos], &pvTemp, bConst);
 	if (pvTemp == NULL)
 	{
 		FatalError(IDS_AUT_E_VARNOTFOUND, vLineToks[ivPos].m_nCol);
@@ -467,16 +467,43 @@ AUT_RESULT AutoIt_Script::Parser_GetArrayElement(VectorToken &vLineToks, uint &i
 } // Parser_GetArrayElement()
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Parser_InitMacros()
+//
+// Builds the hash table that the lexer uses to resolve @macro names.
+///////////////////////////////////////////////////////////////////////////////
+
+void AutoIt_Script::Parser_InitMacros(void)
+{
+	m_oMacroHash.build(m_szMacros, M_MAX);
+
+} // Parser_InitMacros()
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Parser_EvaluateMacro()
+//
+// Evaluates a macro by name (used when expanding macros in strings).
 ///////////////////////////////////////////////////////////////////////////////
 
 AUT_RESULT AutoIt_Script::Parser_EvaluateMacro(const char *szName, Variant &vResult)
 {
-	AString		sMacro = szName;
+	return Parser_EvaluateMacro(m_oMacroHash.find(szName, (int)strlen(szName)), szName, vResult);
+
+} // Parser_EvaluateMacro()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parser_EvaluateMacro()
+//
+// Evaluates the built-in macro nMacro (already resolved by the lexer).  If
+// nMacro is -1 then szName is looked up as a special global variable.
+///////////////////////////////////////////////////////////////////////////////
+
+AUT_RESULT AutoIt_Script::Parser_EvaluateMacro(int nMacro, const char *szName, Variant &vResult)
+{
 	char		szValue[_MAX_PATH+1] = "";
 	char		szValue2[_MAX_PATH+1] ="";
-	int			i = 0;
 	struct		tm *newtime;
     time_t		long_time;
 	DWORD		dwTemp;
@@ -486,17 +513,7 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateMacro(const char *szName, Variant &vRes
 	HDC			hdc;
 	HWND		hWnd;
 
-	time(&long_time);							// Get time as long integer
-	newtime = localtime(&long_time);			// Convert to local time
-
-	sMacro.toupper();							// Convert to uppercase for quicker comparisons (strcmp rather than stricmp)
-	const char *szMacro = sMacro.c_str();		// Get a const pointer for speed
-
-
-	while ( (i < M_MAX) && (strcmp(m_szMacros[i], szMacro)) )
-		i++;
-
-	if (i == M_MAX)
+	if (nMacro == -1)
 	{
 		// No Macro match - check the variable table for a global variable of the same
 		// Name (WITH the @ prefix...) - used for special vars like @ExitMethod, @ExitCode
@@ -504,7 +521,8 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateMacro(const char *szName, Variant &vRes
 		Variant *pvTemp;
 		bool	bConst = false;
 
-		sNewMacro += sMacro;
+		sNewMacro += szName;
+		sNewMacro.toupper();
 
 		g_oVarTable.GetRef(sNewMacro, &pvTemp, bConst);
 		if (pvTemp == NULL)
@@ -516,9 +534,12 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateMacro(const char *szName, Variant &vRes
 		}
 	}
 
+	time(&long_time);							// Get time as long integer
+	newtime = localtime(&long_time);			// Convert to local time
+
 
 	// Return the relevant macro value
-	switch (i)
+	switch (nMacro)
 	{
 		case M_CR:
 			vResult = "\r";
@@ -950,18 +971,54 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateCondition(VectorToken &vLineToks, unsig
 
 ///////////////////////////////////////////////////////////////////////////////
 // Parser_EvaluateExpression()
+//
+// bCallParam is true for a function call parameter (or a Func default value),
+// where the unmatched ) closing the list ends the expression.  Anywhere else
+// an unmatched ) is an unbalanced brackets error.
 ///////////////////////////////////////////////////////////////////////////////
 
-AUT_RESULT AutoIt_Script::Parser_EvaluateExpression(VectorToken &vLineToks, unsigned int &ivPos, Variant &vResult)
+AUT_RESULT AutoIt_Script::Parser_EvaluateExpression(VectorToken &vLineToks, unsigned int &ivPos, Variant &vResult, bool bCallParam)
 {
-	StackInt		opStack;					// Operator parsing stack
-	StackVariant	valStack;					// Value (variant) parsing stack
+	// The operator and value stacks are shared by all expressions (nested expressions from function
+	// calls are evaluated above ours) so note where ours start and restore them however we finish
+	unsigned int	nOpBase		= m_ExprOpStack.size();
+	unsigned int	nValBase	= m_ExprValStack.size();
+	AUT_RESULT		nRes;
+
+	// If these tokens belong to the script then use the compiled version of the expression (unless it
+	// could not be compiled in which case we interpret it)
+	ByteCode		*lpCode = Parser_GetExprCode(vLineToks, ivPos, bCallParam);
+	if (lpCode != NULL)
+		nRes = Parser_ExecuteExprCode(*lpCode, vLineToks, ivPos, vResult);
+	else
+		nRes = Parser_InterpretExpression(vLineToks, ivPos, vResult, nValBase, bCallParam);
+
+	m_ExprOpStack.truncate(nOpBase);
+	m_ExprValStack.truncate(nValBase);
+
+	return nRes;
+
+} // Parser_EvaluateExpression()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parser_InterpretExpression()
+//
+// Evaluates an expression directly from the tokens using the shared operator
+// and value stacks.  Values below nValBase belong to enclosing expressions.
+///////////////////////////////////////////////////////////////////////////////
+
+AUT_RESULT AutoIt_Script::Parser_InterpretExpression(VectorToken &vLineToks, uint &ivPos, Variant &vResult, uint nValBase, bool bCallParam)
+{
+	StackInt		&opStack = m_ExprOpStack;	// Operator parsing stack
+	StackVariant	&valStack = m_ExprValStack;	// Value (variant) parsing stack
 
 	int				opTemp;
 	Variant			vTemp;
 
 	int				opPrev = OPR_NULL;
 	bool			bLastOpWasReduce;
+	int				nParenDepth = 0;			// Number of ( we are inside
 
 	int				nColTemp;
 
@@ -1046,11 +1103,20 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateExpression(VectorToken &vLineToks, unsi
 				break;
 			case TOK_LEFTPAREN:
 				opTemp = OPR_LPR;
+				++nParenDepth;
 				ivPos++;
 				break;
 			case TOK_RIGHTPAREN:
-				opTemp = OPR_RPR;
-				ivPos++;
+				// An unmatched ) ends a function call parameter (otherwise it is reduced below and
+				// reported as unbalanced)
+				if (nParenDepth == 0 && bCallParam)
+					opTemp = OPR_END;
+				else
+				{
+					opTemp = OPR_RPR;
+					--nParenDepth;
+					ivPos++;
+				}
 				break;
 
 			case TOK_STRING:
@@ -1128,11 +1194,12 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateExpression(VectorToken &vLineToks, unsi
 				break;
 
 			case TOK_MACRO:
-				if ( AUT_FAILED(Parser_EvaluateMacro(vLineToks[ivPos++].szValue, vTemp)) )
+				if ( AUT_FAILED(Parser_EvaluateMacro(vLineToks[ivPos].m_nVarID, vLineToks[ivPos].szValue, vTemp)) )
 				{
-					FatalError(IDS_AUT_E_MACROUNKNOWN, vLineToks[ivPos-1].m_nCol);
+					FatalError(IDS_AUT_E_MACROUNKNOWN, vLineToks[ivPos].m_nCol);
 					return AUT_ERR;
 				}
+				++ivPos;
 
 				opTemp = OPR_VAL;
 				break;
@@ -1153,7 +1220,7 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateExpression(VectorToken &vLineToks, unsi
 		if (opTemp == OPR_VAL)
 		{
 			// Shift token to value stack then continue
-			valStack.push(vTemp);
+			valStack.pushmove(vTemp);
 			continue;
 		}
 
@@ -1171,7 +1238,7 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateExpression(VectorToken &vLineToks, unsi
 			{
 				case R:						// Reduce
 					// Standard Reduce
-					if ( AUT_FAILED( Parser_OprReduce(opStack, valStack) ) )
+					if ( AUT_FAILED( Parser_OprReduce(nValBase) ) )
 					{
 						// Print message and quit
 						FatalError(IDS_AUT_E_EXPRESSION, nColTemp);
@@ -1192,7 +1259,7 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateExpression(VectorToken &vLineToks, unsi
 						else
 						{
 							// Standard Reduce
-							if ( AUT_FAILED( Parser_OprReduce(opStack, valStack) ) )
+							if ( AUT_FAILED( Parser_OprReduce(nValBase) ) )
 							{
 								// Print message and quit
 								FatalError(IDS_AUT_E_EXPRESSION, nColTemp);
@@ -1208,7 +1275,7 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateExpression(VectorToken &vLineToks, unsi
 					break;
 
 				case A:						// Accept (finish)
-					if (valStack.size() != 1)
+					if (valStack.size() != nValBase + 1)
 					{
 						// Syntax error, print message and quit
 						FatalError(IDS_AUT_E_EXPRESSION, nColTemp);
@@ -1216,7 +1283,7 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateExpression(VectorToken &vLineToks, unsi
 					}
 					else
 					{
-						vResult = valStack.top();
+						vResult.Swap(valStack.top());
 						valStack.pop();
 						return AUT_OK;
 					}
@@ -1241,13 +1308,12 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateExpression(VectorToken &vLineToks, unsi
 		// Make a note of the boolean result (either 1 or 0 based on current top of value stack)
 		// and then decide if we need to skip up until the END or next boolean operation -
 		// whichever comes first
-		if (valStack.size() && (opPrev == OPR_LOGAND || opPrev == OPR_LOGOR) )
+		if (valStack.size() > nValBase && (opPrev == OPR_LOGAND || opPrev == OPR_LOGOR) )
 		{
-			vTemp = valStack.top();		// Get the current top value
+			bool	bTrue = valStack.top().isTrue();	// Get the current top value
 
 			// Skip the rest of the comparision if true + OR, or false + AND
-			//if ( (vTemp.nValue() && opPrev == OPR_LOGOR) || (!vTemp.nValue() && opPrev == OPR_LOGAND) )
-			if ( (vTemp.isTrue() && opPrev == OPR_LOGOR) || (!vTemp.isTrue() && opPrev == OPR_LOGAND) )
+			if ( (bTrue && opPrev == OPR_LOGOR) || (!bTrue && opPrev == OPR_LOGAND) )
 			{
 				if ( AUT_FAILED( Parser_SkipBoolean(vLineToks, ivPos) ) )
 				{
@@ -1256,12 +1322,10 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateExpression(VectorToken &vLineToks, unsi
 				}
 
 				// "Fix" our value on the value stack to be 1 or 0 (as the Reduce algorithm would have)
-				valStack.pop();
 				if (opPrev == OPR_LOGOR)
-					vTemp = 1;					// Must be 1 if we skipped for an OR operator!
+					valStack.top() = 1;			// Must be 1 if we skipped for an OR operator!
 				else
-					vTemp = 0;					// or 0 for an AND
-				valStack.push(vTemp);			// Put the result back on the value stack
+					valStack.top() = 0;			// or 0 for an AND
 
 				// Remove the And/Or from the operator stack and proceed as if nothing happened
 				opStack.pop();
@@ -1272,181 +1336,156 @@ AUT_RESULT AutoIt_Script::Parser_EvaluateExpression(VectorToken &vLineToks, unsi
 
 	return AUT_OK;
 
-} // Parser_EvaluateExpression()
+} // Parser_InterpretExpression()
 
 
 ///////////////////////////////////////////////////////////////////////////////
 // Parser_OprReduce()
 ///////////////////////////////////////////////////////////////////////////////
 
-AUT_RESULT AutoIt_Script::Parser_OprReduce(StackInt &opStack, StackVariant &valStack)
+AUT_RESULT AutoIt_Script::Parser_OprReduce(uint nValBase)
 {
-	Variant	vOp1, vOp2;
+	int				nOp = m_ExprOpStack.top();
+	unsigned int	nVals = m_ExprValStack.size() - nValBase;
 
 	// Check that minimum number of values are on the stack for the operator to
 	// be used
-	if ( (opStack.top() == OPR_NOT || opStack.top() == OPR_UMI || opStack.top() == OPR_UPL) && valStack.size() < 1 )
+	if ( (nOp == OPR_NOT || nOp == OPR_UMI || nOp == OPR_UPL) && nVals < 1 )
 		return AUT_ERR;
-	if ( (opStack.top() != OPR_NOT && opStack.top() != OPR_UMI && opStack.top() != OPR_UPL ) && valStack.size() < 2 )
+	if ( (nOp != OPR_NOT && nOp != OPR_UMI && nOp != OPR_UPL ) && nVals < 2 )
 		return AUT_ERR;
 
-
 	// Now perform the required operator function
-	switch ( opStack.top() )
+	Parser_OprApply(nOp, m_ExprValStack);
+
+	// Remove top operator from stack
+	m_ExprOpStack.pop();
+
+	return AUT_OK;
+
+} // Parser_OprReduce()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parser_OprApply()
+//
+// Performs an operator on the top value(s) of the value stack and leaves the
+// result in their place.  The operands are worked on where they are on the
+// stack rather than being copied off it.  The caller must have checked that
+// there are enough values.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+void AutoIt_Script::Parser_OprApply(int nOp, StackVariant &valStack)
+{
+	Variant	vTemp;
+
+	// Unary operators work on the top value
+	switch ( nOp )
 	{
-		case OPR_GTR:							// Comparision
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
+		case OPR_NOT:							// Unary NOT
+			!valStack.top();
+			return;
+
+		case OPR_UPL:							// Unary plus
+			return;
+
+		case OPR_UMI:							// Unary minus
+			vTemp = -1;
+			valStack.top() *= vTemp;			// Multiply by -1
+			return;
+	}
 
+	// Binary operators, the result replaces vOp1 and vOp2 is popped
+	Variant	&vOp2 = valStack.top();
+	Variant	&vOp1 = valStack.top(1);
+
+	switch ( nOp )
+	{
+		case OPR_GTR:							// Comparision
 			if (vOp1 > vOp2)
 				vOp1 = 1;
 			else
 				vOp1 = 0;
-
-			valStack.push(vOp1);
 			break;
 
 		case OPR_LESS:							// Comparision
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
-
 			if (vOp1 < vOp2 )
 				vOp1 = 1;
 			else
 				vOp1 = 0;
-
-			valStack.push(vOp1);
 			break;
 
 		case OPR_GTREQUAL:						// Comparision
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
-
 			if ( (vOp1 > vOp2) || (vOp1 == vOp2) )
 				vOp1 = 1;
 			else
 				vOp1 = 0;
-
-			valStack.push(vOp1);
 			break;
 
 		case OPR_LESSEQUAL:						// Comparision
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
-
 			if ( (vOp1 < vOp2) || (vOp1 == vOp2) )
 				vOp1 = 1;
 			else
 				vOp1 = 0;
-
-			valStack.push(vOp1);
 			break;
 
 		case OPR_NOTEQUAL:						// Comparision
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
-
 			if (vOp1 == vOp2 )
 				vOp1 = 0;
 			else
 				vOp1 = 1;
-
-			valStack.push(vOp1);
 			break;
 
 		case OPR_EQUAL:							// Comparision (=) not case sensitive
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
-
 			if (vOp1 == vOp2)
 				vOp1 = 1;
 			else
 				vOp1 = 0;
-
-			valStack.push(vOp1);
 			break;
 
 		case OPR_STRINGEQUAL:					// String comparision (==) (force string and case sense)
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
-
 			if ( vOp1.StringCompare(vOp2) )
 				vOp1 = 1;
 			else
 				vOp1 = 0;
-
-			valStack.push(vOp1);
 			break;
 
 		case OPR_CONCAT:						// Concatenation
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
 			vOp1.Concat(vOp2);
-			valStack.push(vOp1);
 			break;
 
 		case OPR_LOGAND:						// Logical AND
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
 			if (vOp1 && vOp2)
 				vOp1 = 1;
 			else
 				vOp1 = 0;
-			valStack.push(vOp1);
 			break;
 
 		case OPR_LOGOR:							// Logical OR
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
 			if (vOp1 || vOp2)
 				vOp1 = 1;
 			else
 				vOp1 = 0;
-			valStack.push(vOp1);
-			break;
-
-		case OPR_NOT:							// Unary NOT
-			vOp1 = valStack.top();	valStack.pop();
-			vOp1 = !vOp1;			valStack.push(vOp1);
 			break;
 
 		case OPR_ADD:							// Addition +
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
-			vOp1 += vOp2;			valStack.push(vOp1);
-			break;
-
-		case OPR_UPL:							// Unary plus
+			vOp1 += vOp2;
 			break;
 
 		case OPR_SUB:							// Subraction -
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
-			vOp1 -= vOp2;			valStack.push(vOp1);
-			break;
-
-		case OPR_UMI:							// Unary minus
-			vOp1 = valStack.top();	valStack.pop();
-			vOp2 = -1;
-			vOp1 *= vOp2;			valStack.push(vOp1);	// Multiply by -1
+			vOp1 -= vOp2;
 			break;
 
 		case OPR_MUL:							// Multiplication *
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
-			vOp1 *= vOp2;			valStack.push(vOp1);
+			vOp1 *= vOp2;
 			break;
 
 		case OPR_DIV:							// Division /
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
-			vOp1 /= vOp2;			valStack.push(vOp1);
+			vOp1 /= vOp2;
 			break;
 
 		case OPR_POW:							// ^
-			vOp2 = valStack.top();	valStack.pop();
-			vOp1 = valStack.top();	valStack.pop();
-
 			if ( vOp2.fValue() == 0.0 )
 				vOp1 = 1.0;
 			else if ( vOp1.fValue() == 0.0 && vOp2.fValue() < 0.0)
@@ -1466,8 +1505,8 @@ AUT_RESULT AutoIt_Script::Parser_OprReduce(StackInt &opStack, StackVariant &valS
 #endif
 				if (vOp2.nValue() & 1) // odd number
 				{
-					vOp2 = -1.0;
-					vOp1 *= vOp2;
+					vTemp = -1.0;
+					vOp1 *= vTemp;
 				}
 			}
 			else
@@ -1477,17 +1516,12 @@ AUT_RESULT AutoIt_Script::Parser_OprReduce(StackInt &opStack, StackVariant &valS
 #else
 				vOp1 = pow(vOp1.fValue(), vOp2.fValue());
 #endif
-
-			valStack.push(vOp1);
 			break;
 	}
 
-	// Remove top operator from stack
-	opStack.pop();
+	valStack.pop();								// Pop vOp2
 
-	return AUT_OK;
-
-} // Parser_OprReduce()
+} // Parser_OprApply()
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1551,3 +1585,653 @@ AUT_RESULT AutoIt_Script::Parser_SkipBoolean(VectorToken &vLineToks, unsigned in
 
 } // Parser_SkipBoolean()
 
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parser_SkipBrackets()
+//
+// Moves from an opening ( or [ token to the token after its matching closing
+// token.  Only the given pair of tokens is counted.  Returns AUT_ERR if END is
+// reached first.
+///////////////////////////////////////////////////////////////////////////////
+
+AUT_RESULT AutoIt_Script::Parser_SkipBrackets(VectorToken &vLineToks, uint &ivPos, int nOpenTok, int nCloseTok)
+{
+	int nCount = 0;
+	int	tok;
+
+	for (;;)
+	{
+		tok = vLineToks[ivPos].m_nType;
+
+		if (tok == TOK_END)
+			return AUT_ERR;
+
+		ivPos++;								// Next token
+
+		if (tok == nOpenTok)
+			nCount++;
+		else if (tok == nCloseTok)
+		{
+			nCount--;
+			if (nCount <= 0)
+				return AUT_OK;
+		}
+	}
+
+} // Parser_SkipBrackets()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parser_InitExprCode()
+//
+// Prepares the compiled expression cache, one list per script line (same
+// layout as m_vScriptTokens).  Expressions are compiled the first time they are
+// evaluated so lines that never run cost nothing.
+///////////////////////////////////////////////////////////////////////////////
+
+void AutoIt_Script::Parser_InitExprCode(void)
+{
+	Parser_FreeExprCode();
+
+	// /Interpret on the command line means always use Parser_EvaluateExpression()
+	if (g_bInterpretOnly == true)
+		return;
+
+	m_nExprCodeLines = g_oScriptFile.GetNumScriptLines() + 1;
+	m_ExprCode = new ByteCode*[m_nExprCodeLines];
+
+	for (int i = 0; i < m_nExprCodeLines; ++i)
+		m_ExprCode[i] = NULL;
+
+} // Parser_InitExprCode()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parser_FreeExprCode()
+///////////////////////////////////////////////////////////////////////////////
+
+void AutoIt_Script::Parser_FreeExprCode(void)
+{
+	ByteCode	*lpCode, *lpNext;
+
+	if (m_ExprCode == NULL)
+		return;
+
+	for (int i = 0; i < m_nExprCodeLines; ++i)
+	{
+		lpCode = m_ExprCode[i];
+		while (lpCode != NULL)
+		{
+			lpNext = lpCode->m_lpNext;
+			delete lpCode;
+			lpCode = lpNext;
+		}
+	}
+
+	delete [] m_ExprCode;
+	m_ExprCode			= NULL;
+	m_nExprCodeLines	= 0;
+
+} // Parser_FreeExprCode()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parser_GetExprCode()
+//
+// Returns the compiled version of the expression starting at ivPos, compiling
+// it on first use.  Returns NULL if the expression must be interpreted - the
+// tokens are not the script's own (e.g. a copied user function parameter list)
+// or the compiler gave up on it.
+///////////////////////////////////////////////////////////////////////////////
+
+ByteCode* AutoIt_Script::Parser_GetExprCode(VectorToken &vLineToks, uint ivPos, bool bCallParam)
+{
+	ByteCode	*lpCode;
+	int			nLine;
+
+	if (m_ExprCode == NULL || &vLineToks < m_vScriptTokens || &vLineToks >= m_vScriptTokens + m_nExprCodeLines)
+		return NULL;
+
+	nLine = (int)(&vLineToks - m_vScriptTokens);
+
+	// Already compiled?
+	for (lpCode = m_ExprCode[nLine]; lpCode != NULL; lpCode = lpCode->m_lpNext)
+	{
+		if (lpCode->m_ivStart == ivPos && lpCode->m_bCallParam == bCallParam)
+			return lpCode->m_bValid ? lpCode : NULL;
+	}
+
+	// First time, compile it.  If it won't compile then remember that so we go straight to the
+	// interpreter next time (which will report any error properly)
+	lpCode = new ByteCode;
+	lpCode->m_ivStart	= ivPos;
+	lpCode->m_bCallParam	= bCallParam;
+	lpCode->m_bValid	= AUT_SUCCEEDED(Parser_CompileExpression(vLineToks, ivPos, *lpCode, bCallParam));
+	lpCode->m_lpNext	= m_ExprCode[nLine];
+	m_ExprCode[nLine]	= lpCode;
+
+	return lpCode->m_bValid ? lpCode : NULL;
+
+} // Parser_GetExprCode()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parser_CompileExpression()
+//
+// Converts the expression starting at ivPos into postfix bytecode.  This runs
+// exactly the same operator precedence algorithm as Parser_EvaluateExpression()
+// but emits an instruction for each value and each reduced operator instead of
+// doing the work.  Variables, macros and function calls are not resolved here,
+// the instruction just records the token position to evaluate from.
+//
+// AND/OR short-circuits become a jump to the instruction after the AND/OR
+// operator.  This is only valid if Parser_SkipBoolean() would stop on the same
+// token that reduces the AND/OR, so that is checked in Parser_CompileReduce().
+//
+// Operators whose operands are all constants are worked out here (see
+// Parser_CompileFold()), string literals that can't be changed by the
+// ExpandEnvStrings/ExpandVarStrings options are plain constants and Consts
+// used outside functions are treated as literals.
+//
+// An unmatched ) only ends the expression if bCallParam is set, as in the
+// interpreter.
+//
+// Returns AUT_ERR for anything that would cause an error in the interpreter -
+// the caller then falls back to Parser_EvaluateExpression() which reports it.
+///////////////////////////////////////////////////////////////////////////////
+
+AUT_RESULT AutoIt_Script::Parser_CompileExpression(VectorToken &vLineToks, uint ivPos, ByteCode &oCode, bool bCallParam)
+{
+	StackInt		opStack;					// Operator parsing stack
+	StackInt		stkJump;					// Jump instruction for each AND/OR on the operator stack
+	StackInt		stkSkip;					// Token that each AND/OR would skip to
+	uint			nVals = 0;					// Number of values the value stack would contain
+	Variant			vTemp;
+
+	int				opTemp;
+	int				opPrev = OPR_NULL;
+	bool			bLastOpWasReduce;
+	int				nParenDepth = 0;
+	uint			ivTok;						// Position of the current input token
+	uint			ivSkip;
+
+	opStack.push(OPR_END);
+
+	for (;;)
+	{
+		ivTok = ivPos;
+
+		switch ( vLineToks[ivPos].m_nType )
+		{
+			case TOK_LESS:
+				opTemp = OPR_LESS;
+				ivPos++;
+				break;
+			case TOK_GREATER:
+				opTemp = OPR_GTR;
+				ivPos++;
+				break;
+			case TOK_LESSEQUAL:
+				opTemp = OPR_LESSEQUAL;
+				ivPos++;
+				break;
+			case TOK_GREATEREQUAL:
+				opTemp = OPR_GTREQUAL;
+				ivPos++;
+				break;
+			case TOK_NOTEQUAL:
+				opTemp = OPR_NOTEQUAL;
+				ivPos++;
+				break;
+			case TOK_EQUAL:
+				opTemp = OPR_EQUAL;
+				ivPos++;
+				break;
+			case TOK_STRINGEQUAL:
+				opTemp = OPR_STRINGEQUAL;
+				ivPos++;
+				break;
+			case TOK_CONCAT:
+				opTemp = OPR_CONCAT;
+				ivPos++;
+				break;
+
+			case TOK_PLUS:
+				if ( opPrev != OPR_VAL && opPrev != OPR_RPR)
+					opTemp = OPR_UPL;
+				else
+					opTemp = OPR_ADD;
+				ivPos++;
+				break;
+
+			case TOK_MINUS:
+				if ( opPrev != OPR_VAL && opPrev != OPR_RPR)
+					opTemp = OPR_UMI;
+				else
+					opTemp = OPR_SUB;
+				ivPos++;
+				break;
+
+			case TOK_MULT:
+				opTemp = OPR_MUL;
+				ivPos++;
+				break;
+			case TOK_DIV:
+				opTemp = OPR_DIV;
+				ivPos++;
+				break;
+			case TOK_POW:
+				opTemp = OPR_POW;
+				ivPos++;
+				break;
+			case TOK_LEFTPAREN:
+				opTemp = OPR_LPR;
+				++nParenDepth;
+				ivPos++;
+				break;
+			case TOK_RIGHTPAREN:
+				if (nParenDepth == 0 && bCallParam)
+					opTemp = OPR_END;
+				else
+				{
+					opTemp = OPR_RPR;
+					--nParenDepth;
+					ivPos++;
+				}
+				break;
+
+			case TOK_STRING:
+				// Strings are expanded at run time as Opt("ExpandEnvStrings") etc. can change, but
+				// a string without any % $ or @ is the same either way so it is a plain constant
+				vTemp = vLineToks[ivPos].szValue;
+				if (strpbrk(vLineToks[ivPos].szValue, "%$@") == NULL)
+					oCode.emit(BC_PUSHCONST, oCode.addconst(vTemp));
+				else
+					oCode.emit(BC_PUSHSTRING, oCode.addconst(vTemp));
+				opTemp = OPR_VAL;
+				ivPos++;
+				break;
+
+			case TOK_INT32:
+				vTemp = vLineToks[ivPos].nValue;
+				oCode.emit(BC_PUSHCONST, oCode.addconst(vTemp));
+				opTemp = OPR_VAL;
+				ivPos++;
+				break;
+			case TOK_INT64:
+				vTemp = vLineToks[ivPos].n64Value;
+				oCode.emit(BC_PUSHCONST, oCode.addconst(vTemp));
+				opTemp = OPR_VAL;
+				ivPos++;
+				break;
+			case TOK_DOUBLE:
+				vTemp = vLineToks[ivPos].fValue;
+				oCode.emit(BC_PUSHCONST, oCode.addconst(vTemp));
+				opTemp = OPR_VAL;
+				ivPos++;
+				break;
+
+			case TOK_KEYWORD:
+				switch (vLineToks[ivPos].nValue)
+				{
+					case K_AND:
+						opTemp = OPR_LOGAND;
+						ivPos++;
+						break;
+					case K_OR:
+						opTemp = OPR_LOGOR;
+						ivPos++;
+						break;
+					case K_NOT:
+						opTemp = OPR_NOT;
+						ivPos++;
+						break;
+					default:
+						opTemp = OPR_END;
+						break;
+				}
+				break;
+
+			case TOK_FUNCTION:
+			case TOK_USERFUNCTION:
+				if (vLineToks[ivPos].m_nType == TOK_FUNCTION)
+					oCode.emit(BC_FUNCTION, ivPos);
+				else
+					oCode.emit(BC_USERFUNCTION, ivPos);
+
+				// Skip the name and the ( ) of the call
+				ivPos++;
+				if (vLineToks[ivPos].m_nType != TOK_LEFTPAREN)
+					return AUT_ERR;
+				if ( AUT_FAILED(Parser_SkipBrackets(vLineToks, ivPos, TOK_LEFTPAREN, TOK_RIGHTPAREN)) )
+					return AUT_ERR;
+
+				opTemp = OPR_VAL;
+				break;
+
+			case TOK_VARIABLE:
+				// A global constant can be used as a literal
+				if (vLineToks[ivPos+1].m_nType != TOK_LEFTSUBSCRIPT && Parser_GetFoldableConst(vLineToks[ivPos], vTemp))
+					oCode.emit(BC_PUSHCONST, oCode.addconst(vTemp));
+				else
+					oCode.emit(BC_VARIABLE, ivPos);
+
+				// Skip the name and any [subscripts]
+				ivPos++;
+				while (vLineToks[ivPos].m_nType == TOK_LEFTSUBSCRIPT)
+				{
+					if ( AUT_FAILED(Parser_SkipBrackets(vLineToks, ivPos, TOK_LEFTSUBSCRIPT, TOK_RIGHTSUBSCRIPT)) )
+						return AUT_ERR;
+				}
+
+				opTemp = OPR_VAL;
+				break;
+
+			case TOK_MACRO:
+				oCode.emit(BC_MACRO, ivPos);
+				opTemp = OPR_VAL;
+				ivPos++;
+				break;
+
+			default:
+				opTemp = OPR_END;
+				break;
+		}
+
+		opPrev = opTemp;
+
+		if (opTemp == OPR_VAL)
+		{
+			++nVals;
+			continue;
+		}
+
+		bLastOpWasReduce = true;
+		while (bLastOpWasReduce == true)
+		{
+			bLastOpWasReduce = false;
+
+			switch ( m_PrecOpRules[opStack.top()][opTemp] )
+			{
+				case R:
+					if ( AUT_FAILED(Parser_CompileReduce(opStack, nVals, stkJump, stkSkip, ivTok, oCode)) )
+						return AUT_ERR;
+					bLastOpWasReduce = true;
+					break;
+
+				case RP:
+					while (opStack.top() != OPR_LPR)
+					{
+						if (opStack.top() == OPR_END)
+							return AUT_ERR;
+						if ( AUT_FAILED(Parser_CompileReduce(opStack, nVals, stkJump, stkSkip, ivTok, oCode)) )
+							return AUT_ERR;
+					}
+					opStack.pop();
+					break;
+
+				case S:
+					opStack.push(opTemp);
+					break;
+
+				case A:
+					if (nVals != 1)
+						return AUT_ERR;
+
+					oCode.m_ivEnd = ivPos;
+					return AUT_OK;
+
+				default:						// E1, E2, E3
+					return AUT_ERR;
+			}
+		}
+
+		// AND/OR was just shifted, add the short-circuit jump (target is filled in when the AND/OR
+		// itself is reduced)
+		if (opPrev == OPR_LOGAND || opPrev == OPR_LOGOR)
+		{
+			if (nVals == 0)
+				return AUT_ERR;
+
+			ivSkip = ivPos;
+			if ( AUT_FAILED(Parser_SkipBoolean(vLineToks, ivSkip)) )
+				return AUT_ERR;
+
+			stkJump.push(oCode.emit(opPrev == OPR_LOGAND ? BC_JUMPAND : BC_JUMPOR, 0));
+			stkSkip.push((int)ivSkip);
+		}
+	}
+
+} // Parser_CompileExpression()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parser_CompileReduce()
+//
+// The compiler version of Parser_OprReduce().  ivTok is the input token that
+// caused the reduction.
+///////////////////////////////////////////////////////////////////////////////
+
+AUT_RESULT AutoIt_Script::Parser_CompileReduce(StackInt &opStack, uint &nVals, StackInt &stkJump, StackInt &stkSkip, uint ivTok, ByteCode &oCode)
+{
+	int		nOp = opStack.top();
+
+	// Same checks as Parser_OprReduce()
+	if (nOp == OPR_NOT || nOp == OPR_UMI || nOp == OPR_UPL)
+	{
+		if (nVals < 1)
+			return AUT_ERR;
+	}
+	else
+	{
+		if (nVals < 2)
+			return AUT_ERR;
+		--nVals;
+	}
+
+	if (nOp != OPR_UPL)							// Unary plus does nothing
+	{
+		if (Parser_CompileFold(nOp, oCode) == false)
+			oCode.emit(BC_OPERATOR, nOp);
+	}
+
+	// Reducing an AND/OR, so point its short-circuit jump to here.  The skipped tokens must end
+	// exactly where this reduction happened or the two ways through would not match
+	if (nOp == OPR_LOGAND || nOp == OPR_LOGOR)
+	{
+		if ((uint)stkSkip.top() != ivTok)
+			return AUT_ERR;
+
+		oCode.patch(stkJump.top(), oCode.size());
+		stkJump.pop();
+		stkSkip.pop();
+	}
+
+	opStack.pop();
+
+	return AUT_OK;
+
+} // Parser_CompileReduce()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parser_CompileFold()
+//
+// If the operands of nOp are constants that have just been pushed then work
+// out the result now and replace them with it.  Returns false if the operator
+// must be applied at run time.
+//
+// The jump of an AND/OR always targets the instruction after the AND/OR
+// operator so it can never point between two constants being folded here.
+// AND/OR themselves are not folded as that would leave their jump behind.
+///////////////////////////////////////////////////////////////////////////////
+
+bool AutoIt_Script::Parser_CompileFold(int nOp, ByteCode &oCode)
+{
+	StackVariant	valStack;
+	int				nInstr = oCode.m_nInstrs - 1;
+
+	if (nOp == OPR_LOGAND || nOp == OPR_LOGOR)
+		return false;
+
+	if (nInstr < 0 || oCode.m_lpInstrs[nInstr].nOp != BC_PUSHCONST)
+		return false;
+
+	if (nOp == OPR_NOT || nOp == OPR_UMI)
+	{
+		// Unary, apply to the last constant and replace it
+		valStack.push(oCode.m_lpConsts[oCode.m_lpInstrs[nInstr].nArg]);
+		Parser_OprApply(nOp, valStack);
+		oCode.m_lpConsts[oCode.m_lpInstrs[nInstr].nArg].Swap(valStack.top());
+		return true;
+	}
+
+	if (nInstr < 1 || oCode.m_lpInstrs[nInstr-1].nOp != BC_PUSHCONST)
+		return false;
+
+	// Binary, replace both constants with the result.  The second constant is now unused so
+	// drop it from the pool too when it was the last one added (it normally is) so that long
+	// folded chains don't grow the pool
+	valStack.push(oCode.m_lpConsts[oCode.m_lpInstrs[nInstr-1].nArg]);
+	valStack.push(oCode.m_lpConsts[oCode.m_lpInstrs[nInstr].nArg]);
+	Parser_OprApply(nOp, valStack);
+
+	oCode.m_lpConsts[oCode.m_lpInstrs[nInstr-1].nArg].Swap(valStack.top());
+	if (oCode.m_lpInstrs[nInstr].nArg == oCode.m_nConsts - 1)
+		oCode.popconst();
+	oCode.pop();
+
+	return true;
+
+} // Parser_CompileFold()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parser_GetFoldableConst()
+//
+// Gets the value of a variable if it can be compiled as a literal.  It must
+// be a Const holding a number or string and the token must be outside any
+// user function (tokens in a function have a local slot).  Inside a function
+// a Local of the same name could hide the global on some calls but not others.
+///////////////////////////////////////////////////////////////////////////////
+
+bool AutoIt_Script::Parser_GetFoldableConst(const Token &tokVar, Variant &vResult)
+{
+	Variant	*pvTemp;
+	bool	bConst = false;
+
+	if (tokVar.m_nVarSlot != -1 || g_oVarTable.IsGlobalLevel() == false)
+		return false;
+
+	if (g_oVarTable.GetRef(tokVar, &pvTemp, bConst) == false || bConst == false)
+		return false;
+
+	if (pvTemp->isNumber() == false && pvTemp->isString() == false)
+		return false;
+
+	vResult = *pvTemp;
+
+	return true;
+
+} // Parser_GetFoldableConst()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Parser_ExecuteExprCode()
+//
+// Runs a compiled expression.  The result and final token position are the
+// same as Parser_EvaluateExpression() would give.
+///////////////////////////////////////////////////////////////////////////////
+
+AUT_RESULT AutoIt_Script::Parser_ExecuteExprCode(ByteCode &oCode, VectorToken &vLineToks, uint &ivPos, Variant &vResult)
+{
+	StackVariant		&valStack = m_ExprValStack;	// Value (variant) stack (shared, ours is above any existing values)
+	Variant				vTemp;
+	uint				ivTok;
+	int					nInstr = 0;
+	const ByteCodeInstr	*lpInstr;
+
+	while (nInstr < oCode.m_nInstrs)
+	{
+		lpInstr = &oCode.m_lpInstrs[nInstr++];
+
+		switch (lpInstr->nOp)
+		{
+			case BC_PUSHCONST:
+				valStack.push(oCode.m_lpConsts[lpInstr->nArg]);
+				break;
+
+			case BC_PUSHSTRING:
+				if (m_bExpandEnvStrings || m_bExpandVarStrings)
+				{
+					vTemp = oCode.m_lpConsts[lpInstr->nArg];
+					if (m_bExpandEnvStrings)
+						Parser_ExpandEnvString(vTemp);
+					if (m_bExpandVarStrings)
+						Parser_ExpandVarString(vTemp);
+					valStack.pushmove(vTemp);
+				}
+				else
+					valStack.push(oCode.m_lpConsts[lpInstr->nArg]);
+				break;
+
+			case BC_VARIABLE:
+				ivTok = lpInstr->nArg;
+				if ( AUT_FAILED(Parser_EvaluateVariable(vLineToks, ivTok, vTemp)) )
+					return AUT_ERR;
+				valStack.pushmove(vTemp);
+				break;
+
+			case BC_FUNCTION:
+				ivTok = lpInstr->nArg;
+				if ( AUT_FAILED(Parser_FunctionCall(vLineToks, ivTok, vTemp)) )
+					return AUT_ERR;
+				valStack.pushmove(vTemp);
+				break;
+
+			case BC_USERFUNCTION:
+				ivTok = lpInstr->nArg;
+				if ( AUT_FAILED(Parser_UserFunctionCall(vLineToks, ivTok, vTemp)) )
+					return AUT_ERR;
+				valStack.pushmove(vTemp);
+				break;
+
+			case BC_MACRO:
+				if ( AUT_FAILED(Parser_EvaluateMacro(vLineToks[lpInstr->nArg].m_nVarID, vLineToks[lpInstr->nArg].szValue, vTemp)) )
+				{
+					FatalError(IDS_AUT_E_MACROUNKNOWN, vLineToks[lpInstr->nArg].m_nCol);
+					return AUT_ERR;
+				}
+				valStack.pushmove(vTemp);
+				break;
+
+			case BC_OPERATOR:
+				Parser_OprApply(lpInstr->nArg, valStack);
+				break;
+
+			case BC_JUMPAND:
+				if (!valStack.top().isTrue())
+				{
+					valStack.top() = 0;			// As the interpreter would after skipping
+					nInstr = lpInstr->nArg;
+				}
+				break;
+
+			case BC_JUMPOR:
+				if (valStack.top().isTrue())
+				{
+					valStack.top() = 1;
+					nInstr = lpInstr->nArg;
+				}
+				break;
+		}
+	}
+
+	vResult.Swap(valStack.top());
+	valStack.pop();
+	ivPos = oCode.m_ivEnd;
+
+	return AUT_OK;
+
+} // Parser_ExecuteExprCode()
@@ -96,23 +96,15 @@ bool AutoIt_Script::HandleProcessWait(void)
 	if (m_nCurrentOperation != AUT_PROCESSWAIT && m_nCurrentOperation != AUT_PROCESSWAITCLOSE)
 		return false;
 
-	// Idle a little to remove CPU usage
-	Sleep(AUT_IDLE);
-
-
 	// If required, process the timeout
+	DWORD	dwTimeLeft = INFINITE;
+
 	if (m_nProcessWaitTimeout != 0)
 	{
-		// Get current time in ms
-		DWORD	dwDiff;
-		DWORD	dwCur = timeGetTime();
-		if (dwCur < m_tProcessTimerStarted)
-			dwDiff = (UINT_MAX - m_tProcessTimerStarted) + dwCur; // timer wraps at 2^32
-		else
-			dwDiff = dwCur - m_tProcessTimerStarted;
+		dwTimeLeft = Util_TimeLeft(m_tProcessTimerStarted, m_nProcessWaitTimeout);
 
 		// Timer elapsed?
-		if (dwDiff >= m_nProcessWaitTimeout)
+		if (dwTimeLeft == 0)
 		{
 			m_vUserRetVal = 0;					// We timed out (default = 1)
 			m_bUserFuncReturned = true;			// Request exit from Execute()
@@ -122,38 +114,62 @@ bool AutoIt_Script::HandleProcessWait(void)
 	}
 
 
-	// Perform relevant command
-	bool bRes = false;
-	DWORD	dwPid;
-	if (m_nCurrentOperation == AUT_PROCESSWAIT)
+	// Process lists are polled, but only every AUT_IDLE ms however often messages wake us up
+	DWORD	dwPollLeft = Util_TimeLeft(m_tWaitLastPoll, AUT_IDLE);
+
+	if (dwPollLeft == 0)
 	{
-		// Process Wait
+		m_tWaitLastPoll = timeGetTime();
+
+		// Perform relevant command
+		bool	bRes = false;
+		DWORD	dwPid;
+
 		if (Util_DoesProcessExist(m_sProcessSearchTitle.c_str(), dwPid, bRes) == false)
 		{
 			FatalError(IDE_AUT_E_PROCESSNT);
 			m_nCurrentOperation = AUT_QUIT;
+			return true;
 		}
-	}
-	else
-	{
-		// Process Wait Close
-		if (Util_DoesProcessExist(m_sProcessSearchTitle.c_str(), dwPid, bRes) == false)
+
+		if (m_nCurrentOperation == AUT_PROCESSWAITCLOSE)
 		{
-			FatalError(IDE_AUT_E_PROCESSNT);
-			m_nCurrentOperation = AUT_QUIT;
+			// Process Wait Close - a running process can be waited on directly so block
+			// until it ends (then check again in case another of the same name exists)
+			if (bRes == true)
+			{
+				HANDLE	hProcess = OpenProcess(SYNCHRONIZE, FALSE, dwPid);
+
+				if (hProcess != NULL)
+				{
+					if (WaitForEvents(dwTimeLeft, hProcess) == WAIT_OBJECT_0)
+						m_tWaitLastPoll = timeGetTime() - AUT_IDLE;
+
+					CloseHandle(hProcess);
+					return true;
+				}
+			}
+
+			bRes = !bRes;
 		}
-		bRes = !bRes;
-	}
 
+		// Wait Command successful?
+		if (bRes == true)
+		{
+			m_bUserFuncReturned = true;			// Request exit from Execute()
+			m_nCurrentOperation = AUT_RUN;		// Continue script
+			Sleep(m_nWinWaitDelay);				// Briefly pause before continuing
+			return true;
+		}
 
-	// Wait Command successful?
-	if (bRes == true)
-	{
-		m_bUserFuncReturned = true;			// Request exit from Execute()
-		m_nCurrentOperation = AUT_RUN;		// Continue script
-		Sleep(m_nWinWaitDelay);				// Briefly pause before continuing
+		dwPollLeft = AUT_IDLE;
 	}
 
+	if (dwPollLeft < dwTimeLeft)
+		dwTimeLeft = dwPollLeft;
+
+	WaitForEvents(dwTimeLeft);
+
 	return true;
 
 } // HandleProcessWait()
@@ -178,6 +194,7 @@ void AutoIt_Script::ProcessWaitInit(VectorVariant &vParams, uint iNumParams)
 
 	// Make a note of current system time for comparision in timer
 	m_tProcessTimerStarted	= timeGetTime();
+	m_tWaitLastPoll			= m_tProcessTimerStarted - AUT_IDLE;	// Check straight away
 
 } // ProcessWaitInit()
 
@@ -402,6 +419,9 @@ AUT_RESULT AutoIt_Script::Run(int nFunction, VectorVariant &vParams, uint iNumPa
 	MyCreateProcessWithLogonW	lpfnDLLProc = NULL;
 
 
+	// The child may share our stdout so write out any buffered console output first
+	ConsoleFlush();
+
 	// init structure for running programs
 	si.cb			= sizeof(STARTUPINFO);
 	si.lpReserved	= NULL;
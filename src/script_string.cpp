@@ -50,6 +50,7 @@
 	#include <stdio.h>
 	#include <windows.h>
 	#include <ctype.h>
+	#include <limits.h>
 #endif
 
 #include "AutoIt.h"								// Autoit values, macros and config options
@@ -57,6 +58,7 @@
 #include "script.h"
 #include "resources\resource.h"
 #include "utility.h"
+#include "string_search.h"
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -336,8 +338,9 @@ AUT_RESULT AutoIt_Script::F_StringAddCR(VectorVariant &vParams, Variant &vResult
 //
 // $var = StringReplace(<string>, <searchstring or start>, <replacestring>, <numreplaces>, [casesense])
 //
-// This is a little bit inefficient as the input and output string will be
-// constantly changing sizes with the AString class, but makes for easy reading :)
+// The search string is compiled once and the input scanned in a single pass
+// to find the matches, the output is then built in one buffer of the exact
+// size required.  @error = 1 if the result would be too big for a string.
 //
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -349,7 +352,6 @@ AUT_RESULT AutoIt_Script::F_StringReplace(VectorVariant &vParams, Variant &vResu
 	int		nReplacesDone, nReplacesToDo;
 
 	int		nPos;
-	int		iSearchStrLen;
 
 	if (vParams[1].type() == VAR_INT32 || vParams[1].type() == VAR_INT64)
 	{
@@ -366,6 +368,7 @@ AUT_RESULT AutoIt_Script::F_StringReplace(VectorVariant &vParams, Variant &vResu
 		sOutput += vParams[2].szValue();
 		sTemp.assign(vParams[0].szValue(), nPos+(int)strlen(vParams[2].szValue()), (int)strlen(vParams[0].szValue()) );
 		sOutput += sTemp;
+		vResult =  sOutput.c_str();
 	}
 	else
 	{
@@ -390,53 +393,70 @@ AUT_RESULT AutoIt_Script::F_StringReplace(VectorVariant &vParams, Variant &vResu
 		else
 			bCaseSense = false;
 
+		const char		*szInput		= vParams[0].szValue();
+		const char		*szReplace		= vParams[2].szValue();
+		int				nInputLen		= (int)strlen(szInput);
+		int				nReplaceLen		= (int)strlen(szReplace);
+		StringSearch	oSearch(vParams[1].szValue(), bCaseSense);
+		int				nSearchLen		= oSearch.length();
 
-		// Get the input string into our nice string class
-		AString sInput = vParams[0].szValue();
-
-		// Make a note of how long the search string is
-		iSearchStrLen = (int)strlen(vParams[1].szValue());
+		// Find all the (non-overlapping) matches first
+		int		*pnMatches	= NULL;
+		int		nMatchAlloc	= 0;
 
-		bool bLoop = true;
 		nReplacesDone = 0;
-		while (bLoop)
+		nPos = oSearch.find(szInput, nInputLen, 0);
+		while (nPos >= 0 && (nReplacesToDo <= 0 || nReplacesDone < nReplacesToDo))
 		{
-			nPos = sInput.find_str(vParams[1].szValue(), bCaseSense);
-			if (nPos == sInput.length())
+			if (nReplacesDone == nMatchAlloc)
 			{
-				sTemp.assign(sInput, 0, nPos);		// Copy remaining input
-				sOutput += sTemp;					// And append to output
-				bLoop = false;						// No more found
+				nMatchAlloc	= nMatchAlloc ? nMatchAlloc * 2 : 64;
+				int	*pnTemp	= new int[nMatchAlloc];
+				for (int i=0; i<nReplacesDone; ++i)
+					pnTemp[i] = pnMatches[i];
+				delete [] pnMatches;
+				pnMatches = pnTemp;
 			}
-			else
-			{
-				// Copy from the input up to the found string
-				sTemp.assign(sInput, 0, nPos);
 
-				// Append this to our output, and include the replace string
-				sOutput += sTemp;
-				sOutput += vParams[2].szValue();
+			pnMatches[nReplacesDone++] = nPos;
+			nPos = oSearch.find(szInput, nInputLen, nPos + nSearchLen);
+		}
 
-				// Now erase everything up to and including our search string in sInput
-				sInput.erase(0, nPos+iSearchStrLen);
+		// Work out the output size in 64bit so lots of long replacements can't wrap it
+		__int64	n64OutLen	= (__int64)nInputLen + (__int64)nReplacesDone * (__int64)(nReplaceLen - nSearchLen);
+		if (n64OutLen >= INT_MAX)
+		{
+			delete [] pnMatches;
+			vResult = "";
+			SetFuncErrorCode(1);
+			return AUT_OK;
+		}
 
-				nReplacesDone++;
+		// Build the output in one go
+		char	*szOutput	= new char[(size_t)n64OutLen + 1];
+		char	*szOut		= szOutput;
+		int		nLast		= 0;
 
-				// More replacing to do?
-				if ( nReplacesToDo != 0 && nReplacesDone == nReplacesToDo)
-				{
-					sOutput += sInput;						// Append remaing input to output
-					bLoop = false;							// No more to do
-				}
-				else
-					bLoop = true;
-			}
+		for (int i=0; i<nReplacesDone; ++i)
+		{
+			memcpy(szOut, szInput + nLast, pnMatches[i] - nLast);
+			szOut += pnMatches[i] - nLast;
+			memcpy(szOut, szReplace, nReplaceLen);
+			szOut += nReplaceLen;
+			nLast = pnMatches[i] + nSearchLen;
 		}
 
+		memcpy(szOut, szInput + nLast, nInputLen - nLast);
+		szOut[nInputLen - nLast] = '\0';
+
+		vResult = szOutput;
+
+		delete [] szOutput;
+		delete [] pnMatches;
+
 		// Store the number of replacements done in @extended
 		SetFuncExtCode(nReplacesDone);
 	}
-	vResult =  sOutput.c_str();
 
 	return AUT_OK;
 
@@ -454,11 +474,13 @@ AUT_RESULT AutoIt_Script::F_StringSplit(VectorVariant &vParams, Variant &vResult
 {
 	int			iCount, iElements, iIndex;
 	int			nPos, nFlag;
-	char const	*pcSearch, *pcDelim, *pcTmp;	// pointer can change, but the pointed at stuff will not.
+	int			nInputLen, nDelimPos;
+	char const	*pcSearch, *pcDelim;			// pointer can change, but the pointed at stuff will not.
 	Variant		*pvTemp;
 
 	// For speed, pre-allocate our string class to be same size as input string
-	AString		sElement((int)strlen(vParams[0].szValue()));
+	AString		sInput = vParams[0].szValue();
+	AString		sElement(sInput.length());
 
 	if (vParams.size() < 3)
 		nFlag = 0;
@@ -467,19 +489,20 @@ AUT_RESULT AutoIt_Script::F_StringSplit(VectorVariant &vParams, Variant &vResult
 
 	pcSearch	= vParams[0].szValue();
 	pcDelim		= vParams[1].szValue();
+	nInputLen	= sInput.length();
 
 	// Create array with single characters when the delimiter is empty
 	if (pcDelim[0] == '\0')
 	{
 		iCount   = 0;
 		iIndex   = 1;
-		iElements = (int)strlen(pcSearch);
+		iElements = nInputLen;
 		Util_VariantArrayDim(&vResult, iElements+1);    // create the array , String length + 1
 		pvTemp = Util_VariantArrayGetRef(&vResult, 0);  // First element set to length
 		*pvTemp = iElements;
 		while (iCount < iElements)
 		{
-			sElement.assign(pcSearch, iCount, iCount + 1);
+			sElement.assign(sInput, iCount, iCount + 1);
 			pvTemp = Util_VariantArrayGetRef(&vResult, iIndex++);   //Next element
 			*pvTemp = sElement.c_str();
 			++iCount;                  // Increase count
@@ -488,6 +511,8 @@ AUT_RESULT AutoIt_Script::F_StringSplit(VectorVariant &vParams, Variant &vResult
 	}
 
 
+	StringSearch	oDelim(pcDelim, true);		// Compiled delimiter for flag 1
+
 	switch (nFlag)
 	{
 	case 0:	// default method - any characters in delimeter string delimit fields
@@ -502,17 +527,13 @@ AUT_RESULT AutoIt_Script::F_StringSplit(VectorVariant &vParams, Variant &vResult
 		}
 		break;
 	case 1: // use exact delimeter string to delimit fields
-		iCount=0;
-		while (pcSearch != NULL)
+		iCount = 0;
+		nPos = oDelim.find(pcSearch, nInputLen, 0);
+		while (nPos >= 0)
 		{
-			pcSearch = strstr(pcSearch, pcDelim);
-			if (pcSearch != NULL) {
-				++iCount;
-				pcSearch += strlen(pcDelim);	// skip by the length of the delimter
-			}
+			++iCount;
+			nPos = oDelim.find(pcSearch, nInputLen, nPos + oDelim.length());	// skip by the length of the delimiter
 		}
-		// reset back to starting place
-		pcSearch = vParams[0].szValue();
 		break;
 	default:
 		iCount = -1;
@@ -572,19 +593,14 @@ AUT_RESULT AutoIt_Script::F_StringSplit(VectorVariant &vParams, Variant &vResult
 			++nPos;
 			break;
 		case 1:
-			pcTmp = pcSearch;
-			pcSearch = strstr(pcSearch, pcDelim);
-			if (pcSearch != NULL) {
-				sElement = "";
+			// copy everything up to the beginning of the next delimiter (or the end) into sElement
+			nDelimPos = oDelim.find(pcSearch, nInputLen, nPos);
+			if (nDelimPos < 0)
+				nDelimPos = nInputLen;
 
-				// copy all elements up to the beginning of the delimiter into sElement
-				for (;pcTmp != pcSearch; ++pcTmp)
-					sElement += *pcTmp;
+			sElement.assign(sInput, nPos, nDelimPos);
+			nPos = nDelimPos + oDelim.length();	// skip by the length of the delimiter
 
-				pcSearch += strlen(pcDelim);	// skip by the length of the delimter
-			}
-			else
-				sElement = pcTmp;
 			// copy string into array
 			pvTemp = Util_VariantArrayGetRef(&vResult, iIndex++);	//Next element
 			*pvTemp = sElement.c_str();
@@ -1113,3 +1129,292 @@ AUT_RESULT AutoIt_Script::F_StringIsASCII(VectorVariant &vParams, Variant &vResu
 
 } // StringIsASCII()
 
+
+
+///////////////////////////////////////////////////////////////////////////////
+// StringRegExpCompile()
+//
+// Returns the compiled program for a pattern, using the cache of the last
+// AUT_MAXREGEXPS patterns so that a pattern used in a loop is only compiled
+// once.  Any (?ims) flags are part of the pattern text so the pattern alone
+// is the cache key.  Returns NULL if the pattern is invalid, nErrOffset is
+// then the position of the error.
+///////////////////////////////////////////////////////////////////////////////
+
+CRegExp * AutoIt_Script::StringRegExpCompile(const char *szPattern, int &nErrOffset)
+{
+	CRegExp	*lpRegExp;
+	int		i;
+
+	// Cached?  Move it to the front
+	for (i=0; i<AUT_MAXREGEXPS && m_RegExpCache[i] != NULL; ++i)
+	{
+		if (!strcmp(m_RegExpCache[i]->Pattern(), szPattern))
+		{
+			lpRegExp = m_RegExpCache[i];
+			for (; i>0; --i)
+				m_RegExpCache[i] = m_RegExpCache[i-1];
+			m_RegExpCache[0] = lpRegExp;
+
+			return lpRegExp;
+		}
+	}
+
+	lpRegExp = new CRegExp;
+	if (!lpRegExp->Compile(szPattern))
+	{
+		nErrOffset = lpRegExp->ErrorOffset();
+		delete lpRegExp;
+		return NULL;
+	}
+
+	// Drop the least recently used entry and add the new one at the front
+	delete m_RegExpCache[AUT_MAXREGEXPS-1];
+	for (i=AUT_MAXREGEXPS-1; i>0; --i)
+		m_RegExpCache[i] = m_RegExpCache[i-1];
+	m_RegExpCache[0] = lpRegExp;
+
+	return lpRegExp;
+
+} // StringRegExpCompile()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// StringRegExp()
+//
+// $result = StringRegExp("test", "pattern" [, flag] )
+//
+// flag 0 = returns 1 (matched) or 0 (no match)
+// flag 1 = returns an array of the groups of the first match
+// flag 2 = as 1 but element 0 is the full match (Perl / PHP style)
+// flag 3 = returns an array of the groups of every match
+//
+// Arrays are zero based.  When the pattern has no groups the full match is
+// used instead.  @error = 1 no match, 2 bad pattern (@extended = offset)
+///////////////////////////////////////////////////////////////////////////////
+
+AUT_RESULT AutoIt_Script::F_StringRegExp(VectorVariant &vParams, Variant &vResult)
+{
+	const char	*szText		= vParams[0].szValue();
+	int			nTextLen	= (int)strlen(szText);
+	int			nFlag		= 0;
+	int			nErrOffset, nFirst, nGroups, nPos, nStart, nEnd, i, j;
+	CRegExp		*lpRegExp;
+	int			*pnFound	= NULL;				// Start/end pairs of the values to return
+	int			nFound		= 0;
+	int			nFoundAlloc	= 0;
+	Variant		*pvTemp;
+
+	if (vParams.size() >= 3)
+		nFlag = vParams[2].nValue();
+	if (nFlag < 0 || nFlag > 3)
+		nFlag = 0;
+
+	vResult = 0;
+
+	if ( (lpRegExp = StringRegExpCompile(vParams[1].szValue(), nErrOffset)) == NULL )
+	{
+		SetFuncErrorCode(2);
+		SetFuncExtCode(nErrOffset);
+		return AUT_OK;
+	}
+
+	if (nFlag == 0)
+	{
+		vResult = lpRegExp->Find(szText, nTextLen, 0) ? 1 : 0;
+		return AUT_OK;
+	}
+
+	nFirst	= (nFlag == 2 || lpRegExp->NumGroups() == 0) ? 0 : 1;
+	nGroups	= lpRegExp->NumGroups() + 1 - nFirst;
+
+	// Collect the groups of the first (or every) match
+	nPos = 0;
+	while (nPos <= nTextLen && lpRegExp->Find(szText, nTextLen, nPos))
+	{
+		if (nFound + nGroups > nFoundAlloc)
+		{
+			nFoundAlloc	= (nFound + nGroups) * 2;
+			int	*pnTemp	= new int[nFoundAlloc * 2];
+			for (i=0; i<nFound*2; ++i)
+				pnTemp[i] = pnFound[i];
+			delete [] pnFound;
+			pnFound = pnTemp;
+		}
+
+		for (i=0; i<nGroups; ++i, ++nFound)
+		{
+			pnFound[nFound*2]	= lpRegExp->GroupStart(nFirst + i);
+			pnFound[nFound*2+1]	= lpRegExp->GroupEnd(nFirst + i);
+		}
+
+		if (nFlag != 3)
+			break;
+
+		// Carry on after this match (an empty match must still move on)
+		nStart	= lpRegExp->GroupStart(0);
+		nEnd	= lpRegExp->GroupEnd(0);
+		nPos	= (nEnd == nStart) ? nEnd + 1 : nEnd;
+	}
+
+	if (nFound == 0)
+	{
+		SetFuncErrorCode(1);
+		return AUT_OK;
+	}
+
+	// Build the array, groups that didn't take part in the match are blank
+	char	*szTemp = new char[nTextLen+1];
+
+	Util_VariantArrayDim(&vResult, nFound);
+	for (i=0; i<nFound; ++i)
+	{
+		j = 0;
+		if (pnFound[i*2] >= 0)
+		{
+			j = pnFound[i*2+1] - pnFound[i*2];
+			memcpy(szTemp, szText + pnFound[i*2], j);
+		}
+		szTemp[j] = '\0';
+
+		pvTemp = Util_VariantArrayGetRef(&vResult, i);
+		*pvTemp = szTemp;
+	}
+
+	delete [] szTemp;
+	delete [] pnFound;
+
+	return AUT_OK;
+
+} // StringRegExp()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// StringRegExpReplace_Append()
+//
+// Appends text to a growing output buffer (doubling, so that building the
+// result stays linear).
+///////////////////////////////////////////////////////////////////////////////
+
+static void StringRegExpReplace_Append(char *&szBuf, int &nLen, int &nAlloc, const char *szText, int nTextLen)
+{
+	if (nLen + nTextLen + 1 > nAlloc)
+	{
+		nAlloc = (nLen + nTextLen + 1) * 2;
+		char *szTemp = new char[nAlloc];
+		memcpy(szTemp, szBuf, nLen);
+		delete [] szBuf;
+		szBuf = szTemp;
+	}
+
+	memcpy(szBuf + nLen, szText, nTextLen);
+	nLen += nTextLen;
+
+} // StringRegExpReplace_Append()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// StringRegExpReplace()
+//
+// $result = StringRegExpReplace("test", "pattern", "replace" [, count] )
+//
+// count 0 = replace all matches (default)
+//
+// In the replacement \0 - \9 (or $0 - $9 or ${nn}) insert the matching
+// group (0 = the full match), \\ inserts a backslash.
+// @extended = number of replacements, @error = 2 bad pattern (@extended =
+// offset, the input is returned unchanged)
+///////////////////////////////////////////////////////////////////////////////
+
+AUT_RESULT AutoIt_Script::F_StringRegExpReplace(VectorVariant &vParams, Variant &vResult)
+{
+	const char	*szText		= vParams[0].szValue();
+	const char	*szReplace	= vParams[2].szValue();
+	int			nTextLen	= (int)strlen(szText);
+	int			nReplacesToDo = 0;
+	int			nReplacesDone = 0;
+	int			nErrOffset, nPos, nLast, nStart, nEnd, nGroup, i;
+	CRegExp		*lpRegExp;
+	char		*szOutput	= NULL;
+	int			nOutLen		= 0;
+	int			nOutAlloc	= 0;
+
+	if (vParams.size() >= 4)
+		nReplacesToDo = vParams[3].nValue();
+
+	if ( (lpRegExp = StringRegExpCompile(vParams[1].szValue(), nErrOffset)) == NULL )
+	{
+		vResult = szText;
+		SetFuncErrorCode(2);
+		SetFuncExtCode(nErrOffset);
+		return AUT_OK;
+	}
+
+	nPos = nLast = 0;
+	while ( (nReplacesToDo <= 0 || nReplacesDone < nReplacesToDo) &&
+			nPos <= nTextLen && lpRegExp->Find(szText, nTextLen, nPos) )
+	{
+		nStart	= lpRegExp->GroupStart(0);
+		nEnd	= lpRegExp->GroupEnd(0);
+
+		// Text before the match
+		StringRegExpReplace_Append(szOutput, nOutLen, nOutAlloc, szText + nLast, nStart - nLast);
+
+		// The replacement, with any group references expanded
+		for (i=0; szReplace[i] != '\0'; ++i)
+		{
+			nGroup = -1;
+
+			if ( (szReplace[i] == '\\' || szReplace[i] == '$') && szReplace[i+1] >= '0' && szReplace[i+1] <= '9' )
+			{
+				nGroup = szReplace[++i] - '0';
+			}
+			else if (szReplace[i] == '$' && szReplace[i+1] == '{' && szReplace[i+2] >= '0' && szReplace[i+2] <= '9')
+			{
+				nGroup = szReplace[i+2] - '0';
+				if (szReplace[i+3] >= '0' && szReplace[i+3] <= '9' && szReplace[i+4] == '}')
+				{
+					nGroup = nGroup * 10 + szReplace[i+3] - '0';
+					i += 4;
+				}
+				else if (szReplace[i+3] == '}')
+					i += 3;
+				else
+					nGroup = -1;				// Not a reference, output as is
+			}
+			else if (szReplace[i] == '\\' && szReplace[i+1] == '\\')
+				++i;
+
+			if (nGroup < 0)
+				StringRegExpReplace_Append(szOutput, nOutLen, nOutAlloc, szReplace + i, 1);
+			else if (nGroup <= lpRegExp->NumGroups() && lpRegExp->GroupStart(nGroup) >= 0)
+				StringRegExpReplace_Append(szOutput, nOutLen, nOutAlloc, szText + lpRegExp->GroupStart(nGroup),
+										   lpRegExp->GroupEnd(nGroup) - lpRegExp->GroupStart(nGroup));
+		}
+
+		++nReplacesDone;
+		nLast = nPos = nEnd;
+
+		// After an empty match copy the next char and move on
+		if (nEnd == nStart)
+		{
+			if (nEnd < nTextLen)
+				StringRegExpReplace_Append(szOutput, nOutLen, nOutAlloc, szText + nEnd, 1);
+			nLast = nPos = nEnd + 1;
+		}
+	}
+
+	// Text after the last match
+	if (nLast < nTextLen)
+		StringRegExpReplace_Append(szOutput, nOutLen, nOutAlloc, szText + nLast, nTextLen - nLast);
+	StringRegExpReplace_Append(szOutput, nOutLen, nOutAlloc, "", 0);
+	szOutput[nOutLen] = '\0';
+
+	vResult = szOutput;
+	delete [] szOutput;
+
+	SetFuncExtCode(nReplacesDone);
+
+	return AUT_OK;
+
+} // StringRegExpReplace()
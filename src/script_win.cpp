@@ -77,23 +77,15 @@ bool AutoIt_Script::Win_HandleWinWait(void)
 		m_nCurrentOperation != AUT_WINWAITNOTACTIVE)
 		return false;
 
-	// Idle a little to remove CPU usage
-	Sleep(AUT_IDLE);
-
-
 	// If required, process the timeout
+	DWORD	dwTimeLeft = INFINITE;
+
 	if (m_nWinWaitTimeout != 0)
 	{
-		// Get current time in ms
-		DWORD	dwDiff;
-		DWORD	dwCur = timeGetTime();
-		if (dwCur < m_tWinTimerStarted)
-			dwDiff = (UINT_MAX - m_tWinTimerStarted) + dwCur; // timer wraps at 2^32
-		else
-			dwDiff = dwCur - m_tWinTimerStarted;
+		dwTimeLeft = Util_TimeLeft(m_tWinTimerStarted, m_nWinWaitTimeout);
 
 		// Timer elapsed?
-		if (dwDiff >= m_nWinWaitTimeout)
+		if (dwTimeLeft == 0)
 		{
 			if (m_nCurrentOperation != AUT_SLEEP)
 				m_vUserRetVal = 0;				// We timed out (default = 1, Sleep gives no error)
@@ -104,37 +96,57 @@ bool AutoIt_Script::Win_HandleWinWait(void)
 		}
 	}
 
-
-	// Perform relevant command
-	bool bRes = false;
-	switch (m_nCurrentOperation)
+	// Sleep has nothing to check, just wait for the timer
+	if (m_nCurrentOperation == AUT_SLEEP)
 	{
-		case AUT_WINWAITACTIVE:
-			bRes = Win_WinActive();
-			break;
-		case AUT_WINWAITNOTACTIVE:
-			bRes = !Win_WinActive();
-			break;
-		case AUT_WINWAIT:
-			bRes = Win_WinExists();
-			break;
-		case AUT_WINWAITCLOSE:
-			bRes = !Win_WinExists();
-			break;
-
-		case AUT_SLEEP:
-			break;								// Don't do anything, timer processed above
+		WaitForEvents(dwTimeLeft);
+		return true;
 	}
 
 
-	// Wait Command successful?
-	if (bRes == true)
+	// There is nothing to block on for a window so it has to be polled - but only every
+	// AUT_IDLE ms however often messages wake us up
+	DWORD	dwPollLeft = Util_TimeLeft(m_tWaitLastPoll, AUT_IDLE);
+
+	if (dwPollLeft == 0)
 	{
-		m_bUserFuncReturned = true;			// Request exit from Execute()
-		m_nCurrentOperation = AUT_RUN;		// Continue script
-		Util_Sleep(m_nWinWaitDelay);		// Briefly pause before continuing
+		m_tWaitLastPoll = timeGetTime();
+
+		// Perform relevant command
+		bool bRes = false;
+		switch (m_nCurrentOperation)
+		{
+			case AUT_WINWAITACTIVE:
+				bRes = Win_WinActive();
+				break;
+			case AUT_WINWAITNOTACTIVE:
+				bRes = !Win_WinActive();
+				break;
+			case AUT_WINWAIT:
+				bRes = Win_WinExists();
+				break;
+			case AUT_WINWAITCLOSE:
+				bRes = !Win_WinExists();
+				break;
+		}
+
+		// Wait Command successful?
+		if (bRes == true)
+		{
+			m_bUserFuncReturned = true;			// Request exit from Execute()
+			m_nCurrentOperation = AUT_RUN;		// Continue script
+			Util_Sleep(m_nWinWaitDelay);		// Briefly pause before continuing
+			return true;
+		}
+
+		dwPollLeft = AUT_IDLE;
 	}
 
+	if (dwPollLeft < dwTimeLeft)
+		dwTimeLeft = dwPollLeft;
+
+	WaitForEvents(dwTimeLeft);
+
 	return true;
 
 } // Win_HandleWinWait()
@@ -177,6 +189,7 @@ void AutoIt_Script::Win_WindowWaitInit(VectorVariant &vParams)
 
 	// Make a note of current system time for comparision in timer
 	m_tWinTimerStarted			= timeGetTime();
+	m_tWaitLastPoll				= m_tWinTimerStarted - AUT_IDLE;	// Check straight away
 
 } // Win_WindowWaitInit()
 
@@ -58,7 +58,7 @@
 // Constructor()
 ///////////////////////////////////////////////////////////////////////////////
 
-StackInt::StackInt() : m_nItems(0), m_lpTop(NULL)
+StackInt::StackInt() : m_nItems(0), m_nAlloc(0), m_lpItems(NULL)
 {
 
 } // StackInt()
@@ -70,16 +70,7 @@ StackInt::StackInt() : m_nItems(0), m_lpTop(NULL)
 
 StackInt::~StackInt()
 {
-	StackIntNode	*lpTemp2;
-
-	StackIntNode *lpTemp = m_lpTop;
-
-	while(lpTemp != NULL)
-	{
-		lpTemp2 = lpTemp->lpPrev;
-		delete lpTemp;
-		lpTemp = lpTemp2;
-	}
+	delete [] m_lpItems;
 
 } // ~StackInt()
 
@@ -91,40 +82,24 @@ StackInt::~StackInt()
 
 void StackInt::push(const int &nItem)
 {
-	// Create a new node
-	StackIntNode *lpTemp = new StackIntNode;
-	lpTemp->nItem	= nItem;
-
-	// Add it to the top
-	if (m_lpTop)
-		lpTemp->lpPrev = m_lpTop;
-	else
-		lpTemp->lpPrev = NULL;
-
-	m_lpTop	= lpTemp;
-	++m_nItems;
-
-} // push()
+	if (m_nItems == m_nAlloc)
+	{
+		// Full, double the size
+		unsigned int	i;
+		unsigned int	nNewAlloc	= m_nAlloc ? m_nAlloc * 2 : 16;
+		int				*lpNew		= new int[nNewAlloc];
 
+		for (i = 0; i < m_nItems; ++i)
+			lpNew[i] = m_lpItems[i];
 
-///////////////////////////////////////////////////////////////////////////////
-// pop()
-// Pops a value from the stack
-///////////////////////////////////////////////////////////////////////////////
-
-void StackInt::pop(void)
-{
-	if (m_lpTop)
-	{
-		StackIntNode *lpTemp = m_lpTop->lpPrev;
-		delete m_lpTop;
-		m_lpTop = lpTemp;
-		--m_nItems;
+		delete [] m_lpItems;
+		m_lpItems	= lpNew;
+		m_nAlloc	= nNewAlloc;
 	}
-	else
-		return;
 
-} // pop()
+	m_lpItems[m_nItems++] = nItem;
+
+} // push()
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -155,7 +130,7 @@ int& StackInt::top(void)
 		return m_nNull;							// Dummy value
 	}
 	else
-		return m_lpTop->nItem;
+		return m_lpItems[m_nItems-1];
 
 } // top()
 
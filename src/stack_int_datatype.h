@@ -43,18 +43,12 @@
 // The class for an int stack datatype.  Not using STL because of the
 // code bloat.
 //
+// The stack is a growable array so that pushes don't allocate once the stack
+// has reached its working size.
+//
 ///////////////////////////////////////////////////////////////////////////////
 
 
-// Structs for stack node
-typedef struct _StackIntNode
-{
-	int						nItem;				// The item
-	struct _StackIntNode	*lpPrev;			// Previous node (or NULL)
-
-} StackIntNode;
-
-
 class StackInt
 {
 public:
@@ -63,7 +57,10 @@ public:
 	~StackInt();								// Destructor
 
 	void			push(const int &nItem);		// Push item onto stack
-	void			pop(void);					// Pop item from stack
+	void			pop(void)					// Pop item from stack
+						{ if (m_nItems) --m_nItems; }
+	void			truncate(unsigned int nItems)	// Pop items until only nItems remain
+						{ if (nItems < m_nItems) m_nItems = nItems; }
 
 	// Properties
 	int&			top(void);								// Get top item from stack
@@ -76,7 +73,8 @@ public:
 private:
 	// Variables
 	unsigned int	m_nItems;					// Number of items on stack
-	StackIntNode	*m_lpTop;					// Pointer to top node
+	unsigned int	m_nAlloc;					// Number of items allocated in m_lpItems
+	int				*m_lpItems;					// The items (bottom first)
 	int				m_nNull;					// Dummy return value
 };
 
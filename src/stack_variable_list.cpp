@@ -86,16 +86,18 @@ StackVarList::~StackVarList()
 
 ///////////////////////////////////////////////////////////////////////////////
 // push()
-// creates a new blank top entry
+// creates a new blank top entry, with nSlots empty variable slots whose IDs
+// are given by pnSlotIDs
 ///////////////////////////////////////////////////////////////////////////////
 
-void StackVarList::push(void)
+void StackVarList::push(int nSlots, const int *pnSlotIDs)
 {
 	StackVarListNode	*lpTemp;
 
 	// Create a new node, and a new blank list entry
 	lpTemp			= new StackVarListNode;
 	lpTemp->lpList	= new VariableList;
+	lpTemp->lpList->setslots(nSlots, pnSlotIDs);
 
 	// Add it to the top
 	if (m_lpTop)
@@ -69,7 +69,7 @@ public:
 	StackVarList();								// Constructor
 	~StackVarList();							// Destructor
 
-	void	push(void);							// Create/push empty list item onto stack
+	void	push(int nSlots = 0, const int *pnSlotIDs = NULL);	// Create/push empty list item (with frame slots) onto stack
 	void	pop(void);							// Pop and free top list item from stack
 
 	// Properties
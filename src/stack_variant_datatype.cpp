@@ -58,7 +58,7 @@
 // Constructor()
 ///////////////////////////////////////////////////////////////////////////////
 
-StackVariant::StackVariant() : m_nItems(0), m_lpTop(NULL)
+StackVariant::StackVariant() : m_nItems(0), m_nAlloc(0), m_lpItems(NULL)
 {
 
 } // StackVariant()
@@ -70,18 +70,30 @@ StackVariant::StackVariant() : m_nItems(0), m_lpTop(NULL)
 
 StackVariant::~StackVariant()
 {
-	StackVariantNode	*lpTemp, *lpTemp2;
+	delete [] m_lpItems;
 
-	lpTemp = m_lpTop;
+} // ~StackVariant()
 
-	while(lpTemp != NULL)
-	{
-		lpTemp2 = lpTemp->lpPrev;
-		delete lpTemp;
-		lpTemp = lpTemp2;
-	}
 
-} // ~StackVariant()
+///////////////////////////////////////////////////////////////////////////////
+// grow()
+// Doubles the allocated size, existing items are swapped across (not copied)
+///////////////////////////////////////////////////////////////////////////////
+
+void StackVariant::grow(void)
+{
+	unsigned int	i;
+	unsigned int	nNewAlloc	= m_nAlloc ? m_nAlloc * 2 : 16;
+	Variant			*lpNew		= new Variant[nNewAlloc];
+
+	for (i = 0; i < m_nItems; ++i)
+		lpNew[i].Swap(m_lpItems[i]);
+
+	delete [] m_lpItems;
+	m_lpItems	= lpNew;
+	m_nAlloc	= nNewAlloc;
+
+} // grow()
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -91,22 +103,28 @@ StackVariant::~StackVariant()
 
 void StackVariant::push(const Variant &vItem)
 {
-	StackVariantNode	*lpTemp;
+	if (m_nItems == m_nAlloc)
+		grow();
 
-	// Create a new node
-	lpTemp			= new StackVariantNode;
-	lpTemp->vItem	= vItem;
+	m_lpItems[m_nItems++] = vItem;
 
-	// Add it to the top
-	if (m_lpTop)
-		lpTemp->lpPrev = m_lpTop;
-	else
-		lpTemp->lpPrev = NULL;
+} // push()
 
-	m_lpTop	= lpTemp;
-	m_nItems++;
 
-} // push()
+///////////////////////////////////////////////////////////////////////////////
+// pushmove()
+// Pushes a value onto the stack by swapping it with the free slot (which is
+// always 0) so that no strings or arrays are copied
+///////////////////////////////////////////////////////////////////////////////
+
+void StackVariant::pushmove(Variant &vItem)
+{
+	if (m_nItems == m_nAlloc)
+		grow();
+
+	m_lpItems[m_nItems++].Swap(vItem);
+
+} // pushmove()
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -116,21 +134,25 @@ void StackVariant::push(const Variant &vItem)
 
 void StackVariant::pop(void)
 {
-	StackVariantNode	*lpTemp;
-
-	if (m_lpTop)
-	{
-		lpTemp	= m_lpTop->lpPrev;
-		delete m_lpTop;
-		m_lpTop = lpTemp;
-		m_nItems--;
-	}
-	else
-		return;
+	if (m_nItems)
+		m_lpItems[--m_nItems] = 0;				// Release any string/array now
 
 } // pop()
 
 
+///////////////////////////////////////////////////////////////////////////////
+// truncate()
+// Pops values until only nItems remain
+///////////////////////////////////////////////////////////////////////////////
+
+void StackVariant::truncate(unsigned int nItems)
+{
+	while (m_nItems > nItems)
+		m_lpItems[--m_nItems] = 0;
+
+} // truncate()
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // empty()
 // Returns true if the stack is empty
@@ -156,7 +178,22 @@ Variant& StackVariant::top(void)
 	if (!m_nItems)
 		return m_vNull;							// Returns a dummy variant
 	else
-		return m_lpTop->vItem;
+		return m_lpItems[m_nItems-1];
+
+} // top()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// top()
+// Returns the value nDepth below the top of the stack (0 = top)
+///////////////////////////////////////////////////////////////////////////////
+
+Variant& StackVariant::top(unsigned int nDepth)
+{
+	if (nDepth >= m_nItems)
+		return m_vNull;							// Returns a dummy variant
+	else
+		return m_lpItems[m_nItems-1-nDepth];
 
 } // top()
 
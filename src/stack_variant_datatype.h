@@ -43,6 +43,10 @@
 // The class for Variant stack datatype.  Not using STL because of the
 // code bloat.
 //
+// The stack is a growable array of Variants that are kept when popped (but
+// reset to 0 so they don't hold on to strings or arrays).  pushmove() swaps a
+// value in so that pushing a temporary doesn't copy it.
+//
 ///////////////////////////////////////////////////////////////////////////////
 
 
@@ -50,15 +54,6 @@
 #include "variant_datatype.h"
 
 
-// Structs for stack node
-typedef struct _StackVariantNode
-{
-	Variant						vItem;			// The item
-	struct _StackVariantNode	*lpPrev;		// Previous node (or NULL)
-
-} StackVariantNode;
-
-
 class StackVariant
 {
 public:
@@ -67,10 +62,13 @@ public:
 	~StackVariant();							// Destructor
 
 	void			push(const Variant &vItem);	// Push item onto stack
+	void			pushmove(Variant &vItem);	// Push item by swapping it in (vItem is left as 0)
 	void			pop(void);					// Pop item from stack
+	void			truncate(unsigned int nItems);	// Pop items until only nItems remain
 
 	// Properties
 	Variant&		top(void);								// Get top item from stack
+	Variant&		top(unsigned int nDepth);				// Get item nDepth below the top (0 = top)
 	unsigned int	size(void) const { return m_nItems; }	// Return number of items on stack
 	bool			empty(void) const;						// Tests if stack empty
 
@@ -80,8 +78,12 @@ public:
 private:
 	// Variables
 	unsigned int		m_nItems;				// Number of items on stack
-	StackVariantNode	*m_lpTop;				// Pointer to top node
+	unsigned int		m_nAlloc;				// Number of items allocated in m_lpItems
+	Variant				*m_lpItems;				// The items (bottom first)
 	Variant				m_vNull;				// Dummy value to return on error
+
+	// Functions
+	void				grow(void);				// Double the allocated size
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,299 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// string_search.cpp
+//
+// A compiled substring search pattern (Boyer-Moore-Horspool).
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+// Includes
+#include "StdAfx.h"								// Pre-compiled headers
+
+#ifndef _MSC_VER								// Includes for non-MS compilers
+	#include <string.h>
+	#include <windows.h>
+#endif
+
+#include "string_search.h"
+
+#ifndef PF_XMMI64_INSTRUCTIONS_AVAILABLE
+	#define PF_XMMI64_INSTRUCTIONS_AVAILABLE	10
+#endif
+
+#define STRINGSEARCH_SSE2_MAXLEN	16			// Longer patterns are faster with Horspool skips
+
+
+// Static members
+unsigned char	StringSearch::m_Fold[256];
+bool			StringSearch::m_bFoldInit = false;
+bool			StringSearch::m_bSSE2 = false;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor()
+///////////////////////////////////////////////////////////////////////////////
+
+StringSearch::StringSearch(const char *szPattern, bool bCaseSense) : m_bCaseSense(bCaseSense)
+{
+	int	i;
+
+	InitFold();
+
+	m_nLen		= (int)strlen(szPattern);
+	m_szPattern	= new unsigned char[m_nLen+1];
+
+	for (i=0; i<=m_nLen; ++i)
+		m_szPattern[i] = bCaseSense ? (unsigned char)szPattern[i] : m_Fold[(unsigned char)szPattern[i]];
+
+	// Build the shift table, a mismatch on the character under the last pattern
+	// position can skip ahead to the last occurence of that character in the
+	// pattern (excluding the final position)
+	for (i=0; i<256; ++i)
+		m_nShift[i] = m_nLen;
+
+	for (i=0; i<m_nLen-1; ++i)
+		m_nShift[m_szPattern[i]] = m_nLen - 1 - i;
+
+	// When case insensitive both cases of a letter must give the same shift
+	if (!bCaseSense)
+	{
+		for (i=0; i<256; ++i)
+			m_nShift[i] = m_nShift[m_Fold[i]];
+	}
+
+} // StringSearch()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor()
+///////////////////////////////////////////////////////////////////////////////
+
+StringSearch::~StringSearch()
+{
+	delete [] m_szPattern;
+
+} // ~StringSearch()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// InitFold()
+//
+// Builds the ASCII case folding table (A-Z to a-z) and checks for SSE2.
+// IsProcessorFeaturePresent() also confirms that the OS saves the SSE
+// registers; it is missing on 9x so look it up dynamically.
+///////////////////////////////////////////////////////////////////////////////
+
+void StringSearch::InitFold(void)
+{
+	if (m_bFoldInit)
+		return;
+
+	for (int i=0; i<256; ++i)
+		m_Fold[i] = (i >= 'A' && i <= 'Z') ? (unsigned char)(i + ('a' - 'A')) : (unsigned char)i;
+
+	typedef BOOL (WINAPI *MyIsProcessorFeaturePresent)(DWORD);
+	MyIsProcessorFeaturePresent	lpfnIsProcessorFeaturePresent;
+
+	lpfnIsProcessorFeaturePresent = (MyIsProcessorFeaturePresent)GetProcAddress(GetModuleHandle("kernel32.dll"), "IsProcessorFeaturePresent");
+	if (lpfnIsProcessorFeaturePresent != NULL)
+		m_bSSE2 = lpfnIsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE) != FALSE;
+
+	m_bFoldInit = true;
+
+} // InitFold()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// UseSSE2()
+//
+// Turns the SSE2 path off, or back on if the CPU supports it.  It is on by
+// default; this is only for comparing the two paths (bench_strsearch).
+///////////////////////////////////////////////////////////////////////////////
+
+bool StringSearch::UseSSE2(bool bUse)
+{
+	m_bFoldInit = false;						// Repeat the CPU check
+	InitFold();
+
+	if (!bUse)
+		m_bSSE2 = false;
+
+	return m_bSSE2;
+
+} // UseSSE2()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Match()
+//
+// Checks the pattern against the text at szT (which must have at least
+// m_nLen characters available).
+///////////////////////////////////////////////////////////////////////////////
+
+inline bool StringSearch::Match(const unsigned char *szT) const
+{
+	int	j;
+
+	if (m_bCaseSense)
+	{
+		for (j=0; j<m_nLen; ++j)
+		{
+			if (szT[j] != m_szPattern[j])
+				return false;
+		}
+	}
+	else
+	{
+		for (j=0; j<m_nLen; ++j)
+		{
+			if (m_Fold[szT[j]] != m_szPattern[j])
+				return false;
+		}
+	}
+
+	return true;
+
+} // Match()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// find()
+//
+// Returns the index of the first match that starts at or after nStart, or -1
+// if there isn't one.  An empty pattern never matches.
+///////////////////////////////////////////////////////////////////////////////
+
+int StringSearch::find(const char *szText, int nTextLen, int nStart) const
+{
+	if (m_nLen == 0 || nStart < 0)
+		return -1;
+
+	if (m_bSSE2 && m_nLen <= STRINGSEARCH_SSE2_MAXLEN)
+		return FindSSE2((const unsigned char *)szText, nTextLen, nStart);
+
+	return FindHorspool((const unsigned char *)szText, nTextLen, nStart);
+
+} // find()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// rfind()
+//
+// Returns the index of the last match that starts at or before nStart, or -1
+// if there isn't one.  An empty pattern never matches.
+///////////////////////////////////////////////////////////////////////////////
+
+int StringSearch::rfind(const char *szText, int nTextLen, int nStart) const
+{
+	const unsigned char	*szT = (const unsigned char *)szText;
+	unsigned char		chFirst = m_szPattern[0];
+	int					i;
+
+	if (m_nLen == 0)
+		return -1;
+
+	i = nTextLen - m_nLen;
+	if (nStart < i)
+		i = nStart;
+
+	// Only run the full compare where the first character matches
+	if (m_bCaseSense)
+	{
+		for (; i>=0; --i)
+		{
+			if (szT[i] == chFirst && Match(szT+i))
+				return i;
+		}
+	}
+	else
+	{
+		for (; i>=0; --i)
+		{
+			if (m_Fold[szT[i]] == chFirst && Match(szT+i))
+				return i;
+		}
+	}
+
+	return -1;
+
+} // rfind()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FindHorspool()
+///////////////////////////////////////////////////////////////////////////////
+
+int StringSearch::FindHorspool(const unsigned char *szT, int nTextLen, int i) const
+{
+	const unsigned char	*szP = m_szPattern;
+	int					nLast = m_nLen - 1;
+	int					j;
+
+	if (m_bCaseSense)
+	{
+		while (i <= nTextLen - m_nLen)
+		{
+			if (szT[i+nLast] == szP[nLast])
+			{
+				for (j=0; j<nLast && szT[i+j] == szP[j]; ++j)
+					;
+				if (j == nLast)
+					return i;
+			}
+			i += m_nShift[szT[i+nLast]];
+		}
+	}
+	else
+	{
+		while (i <= nTextLen - m_nLen)
+		{
+			if (m_Fold[szT[i+nLast]] == szP[nLast])
+			{
+				for (j=0; j<nLast && m_Fold[szT[i+j]] == szP[j]; ++j)
+					;
+				if (j == nLast)
+					return i;
+			}
+			i += m_nShift[szT[i+nLast]];
+		}
+	}
+
+	return -1;
+
+} // FindHorspool()
@@ -0,0 +1,94 @@
+#ifndef __STRING_SEARCH_H
+#define __STRING_SEARCH_H
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+//
+// string_search.h
+//
+// A compiled substring search pattern (Boyer-Moore-Horspool).  The pattern
+// and its shift table are built once so that repeated searches of the same
+// needle (StringReplace, StringSplit, etc) don't redo any setup.
+//
+// Case insensitive searches compare through an ASCII case folding table,
+// the same folding as strnicmp() in the C locale.
+//
+// Where the compiler supports SSE2 intrinsics, short patterns are searched by
+// comparing the first and last pattern characters against 16 text positions
+// at a time and only verifying the candidates that match both.  The SSE2
+// path is selected at runtime and falls back to Horspool on older CPUs.  It
+// lives in string_search_sse2.cpp, the only file built with SSE2 enabled.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+class StringSearch
+{
+public:
+	// Functions
+	StringSearch(const char *szPattern, bool bCaseSense);	// Constructor (compiles the pattern)
+	~StringSearch();										// Destructor
+
+	int			find(const char *szText, int nTextLen, int nStart = 0) const;	// Index of next match at or after nStart (or -1)
+	int			rfind(const char *szText, int nTextLen, int nStart) const;		// Index of last match at or before nStart (or -1)
+
+	// Properties
+	int			length(void) const { return m_nLen; }	// Length of the pattern
+
+	static bool	UseSSE2(bool bUse);				// Allow the SSE2 path (if the CPU has it), returns true if used
+
+private:
+	// Variables
+	unsigned char	*m_szPattern;				// The pattern (case folded when !m_bCaseSense)
+	int				m_nLen;						// Pattern length
+	bool			m_bCaseSense;				// Case sensitive?
+	int				m_nShift[256];				// Horspool shift for each text character
+
+	static unsigned char	m_Fold[256];		// ASCII case folding table
+	static bool				m_bFoldInit;		// m_Fold has been built
+	static bool				m_bSSE2;			// CPU and OS support SSE2
+
+	// Functions
+	static void		InitFold(void);
+	bool			Match(const unsigned char *szT) const;			// Does the pattern match at szT?
+	int				FindHorspool(const unsigned char *szT, int nTextLen, int i) const;
+	int				FindSSE2(const unsigned char *szT, int nTextLen, int i) const;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,149 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// AutoIt v3
+//
+// Copyright (C)1999-2005:
+//		- Jonathan Bennett <jon at hiddensoft dot com>
+//		- See "AUTHORS.txt" for contributors.
+//
+// This file is part of AutoIt.
+//
+// AutoIt source code is copyrighted software distributed under the terms of the
+// AutoIt source code license.
+//
+// You may:
+//
+// - Customize the design and operation of the AutoIt source code to suit
+// the internal needs of your organization except to the extent not
+// permitted in this Agreement
+//
+// You may not:
+//
+// - Distribute the AutoIt source code and/or compiled versions of AutoIt
+// created with the AutoIt source code.
+// - Create derivative works based on the AutoIt source code for distribution
+// or usage outside your organisation.
+// - Modify and/or remove any copyright notices or labels included in the
+// AutoIt source code.
+//
+// AutoIt is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+// See the LICENSE.txt file that accompanies the AutoIt source
+// code for more details.
+//
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+//
+// string_search_sse2.cpp
+//
+// The SSE2 part of StringSearch.  It is kept in its own file so that only
+// this code is built with SSE2 enabled (-msse2 under gcc).  Everything in
+// string_search.cpp must still run on CPUs without SSE2 as FindSSE2() is
+// only called once InitFold() has checked that the CPU supports it.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+// Includes
+#include "StdAfx.h"								// Pre-compiled headers
+
+#ifndef _MSC_VER								// Includes for non-MS compilers
+	#include <windows.h>
+#endif
+
+#include "string_search.h"
+
+// SSE2 intrinsics are available in VC7+ and in gcc when targeting SSE2
+#if (defined(_MSC_VER) && _MSC_VER >= 1300 && defined(_M_IX86)) || defined(__SSE2__)
+	#define STRINGSEARCH_SSE2
+	#include <emmintrin.h>
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FindSSE2()
+//
+// Compares the first and last pattern characters against 16 consecutive
+// start positions at once and verifies only those candidates that match
+// both.  The last (partial) block is left to FindHorspool() so that no load
+// ever reads past the end of the text.
+//
+// Candidates are verified here rather than with Match() so that no inline
+// copy of the scalar code is built with SSE2 enabled.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef STRINGSEARCH_SSE2
+
+// Folds A-Z to a-z in all 16 bytes (bytes >= 0x80 are negative as signed
+// chars so never fall in the range)
+static inline __m128i StringSearch_Fold16(__m128i vText)
+{
+	__m128i	vUpper = _mm_and_si128(_mm_cmpgt_epi8(vText, _mm_set1_epi8('A' - 1)),
+								   _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), vText));
+
+	return _mm_or_si128(vText, _mm_and_si128(vUpper, _mm_set1_epi8(0x20)));
+}
+
+int StringSearch::FindSSE2(const unsigned char *szT, int nTextLen, int i) const
+{
+	int				nLast = m_nLen - 1;
+	__m128i			vFirst = _mm_set1_epi8((char)m_szPattern[0]);
+	__m128i			vLast = _mm_set1_epi8((char)m_szPattern[nLast]);
+	__m128i			vA, vB;
+	unsigned int	nMask;
+	int				nBit, j;
+	const unsigned char	*szC;
+
+	while (i <= nTextLen - nLast - 16)
+	{
+		vA = _mm_loadu_si128((const __m128i *)(szT + i));
+		vB = _mm_loadu_si128((const __m128i *)(szT + i + nLast));
+
+		if (!m_bCaseSense)
+		{
+			vA = StringSearch_Fold16(vA);
+			vB = StringSearch_Fold16(vB);
+		}
+
+		nMask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(vA, vFirst), _mm_cmpeq_epi8(vB, vLast)));
+
+		for (nBit = 0; nMask != 0; ++nBit, nMask >>= 1)
+		{
+			if ( (nMask & 1) == 0 )
+				continue;
+
+			// The first and last characters match, check the ones in between
+			szC = szT + i + nBit;
+			if (m_bCaseSense)
+			{
+				for (j=1; j<nLast && szC[j] == m_szPattern[j]; ++j)
+					;
+			}
+			else
+			{
+				for (j=1; j<nLast && m_Fold[szC[j]] == m_szPattern[j]; ++j)
+					;
+			}
+
+			if (j >= nLast)
+				return i + nBit;
+		}
+
+		i += 16;
+	}
+
+	return FindHorspool(szT, nTextLen, i);
+
+} // FindSSE2()
+
+#else
+
+int StringSearch::FindSSE2(const unsigned char *szT, int nTextLen, int i) const
+{
+	return FindHorspool(szT, nTextLen, i);
+
+} // FindSSE2()
+
+#endif
@@ -59,7 +59,7 @@
 // Constructor()
 ///////////////////////////////////////////////////////////////////////////////
 
-Token::Token() : m_nType(TOK_UNDEFINED)
+Token::Token() : m_nType(TOK_UNDEFINED), m_nVarID(-1), m_nVarSlot(-1)
 {
 } // Token()
 
@@ -72,6 +72,8 @@ Token::Token(const Token &vOp2)
 {
 	m_nType		= vOp2.m_nType;
 	m_nCol		= vOp2.m_nCol;
+	m_nVarID	= vOp2.m_nVarID;
+	m_nVarSlot	= vOp2.m_nVarSlot;
 
 	if (m_nType == TOK_STRING || m_nType == TOK_VARIABLE || m_nType == TOK_USERFUNCTION || m_nType == TOK_MACRO)
 	{
@@ -112,6 +114,8 @@ Token& Token::operator=(const Token &vOp2)
 
 		m_nType		= vOp2.m_nType;
 		m_nCol		= vOp2.m_nCol;
+		m_nVarID	= vOp2.m_nVarID;
+		m_nVarSlot	= vOp2.m_nVarSlot;
 
 		if (m_nType == TOK_STRING || m_nType == TOK_VARIABLE || m_nType == TOK_USERFUNCTION || m_nType == TOK_MACRO)
 		{
@@ -163,7 +167,9 @@ void Token::settype(int nType)
 		szValue = NULL;
 	}
 
-	m_nType = nType;
+	m_nType		= nType;
+	m_nVarID	= -1;
+	m_nVarSlot	= -1;
 
 	if (m_nType == TOK_STRING || m_nType == TOK_VARIABLE || m_nType == TOK_USERFUNCTION || m_nType == TOK_MACRO)
 		szValue = NULL;
@@ -189,3 +195,21 @@ bool Token::isliteral(void)
 		return false;
 
 } // isliteral()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Swap()
+///////////////////////////////////////////////////////////////////////////////
+
+void Token::Swap(Token &tOp2)
+{
+	__int64	n64Temp;
+	int		nTemp;
+
+	n64Temp	= n64Value;		n64Value	= tOp2.n64Value;	tOp2.n64Value	= n64Temp;	// Whole union
+	nTemp	= m_nType;		m_nType		= tOp2.m_nType;		tOp2.m_nType	= nTemp;
+	nTemp	= m_nCol;		m_nCol		= tOp2.m_nCol;		tOp2.m_nCol		= nTemp;
+	nTemp	= m_nVarID;		m_nVarID	= tOp2.m_nVarID;	tOp2.m_nVarID	= nTemp;
+	nTemp	= m_nVarSlot;	m_nVarSlot	= tOp2.m_nVarSlot;	tOp2.m_nVarSlot	= nTemp;
+
+} // Swap()
@@ -81,6 +81,8 @@
 #define TOK_INT64			26
 #define TOK_DOUBLE			27
 
+#define TOK_CONCATEQUAL		28					// &=
+
 class Token
 {
 public:
@@ -90,14 +92,17 @@ public:
 	~Token();									// Destructor
 	void		settype(int nType);				// Set new type
 	bool		isliteral(void);				// Returns true if the token is a literal (string, int, int64, double)
+	void		Swap(Token &tOp2);				// Exchange contents with another token (no copying)
 
 	Token&		operator=(const Token &vOp2);	// Overloaded = for tokens
 	Token&		operator=(const char *szStr);	// Overloaded = for C strings
 
 	// Variables
-	// Total size is 16 bytes per token + any string length
+	// Total size is 24 bytes per token + any string length
 	int 		m_nType;						// Token type
 	int			m_nCol;							// Column number this token came from
+	int			m_nVarID;						// TOK_VARIABLE: script-wide variable ID, TOK_MACRO: built-in macro index (-1 = unresolved)
+	int			m_nVarSlot;						// TOK_VARIABLE: slot in the enclosing function's frame (-1 = none)
 
 	union
 	{
@@ -58,7 +58,7 @@
 // Constructor()
 ///////////////////////////////////////////////////////////////////////////////
 
-UserFuncList::UserFuncList() : m_lpFirst(NULL), m_lpLast(NULL), m_Index(NULL), m_nNumItems(0)
+UserFuncList::UserFuncList() : m_lpFirst(NULL), m_lpLast(NULL), m_lpTable(NULL), m_nTableSize(0), m_nNumItems(0)
 {
 
 } // UserFuncList()
@@ -70,9 +70,8 @@ UserFuncList::UserFuncList() : m_lpFirst(NULL), m_lpLast(NULL), m_Index(NULL), m
 
 UserFuncList::~UserFuncList()
 {
-	// Delete the index
-	if (m_Index)
-		delete [] m_Index;
+	// Delete the hash table
+	delete [] m_lpTable;
 
 
 	// Delete the actual entries
@@ -83,6 +82,8 @@ UserFuncList::~UserFuncList()
 	while(lpTemp != NULL)
 	{
 		lpTemp2 = lpTemp->lpNext;
+		delete [] lpTemp->uItem.pnSlotIDs;
+		delete [] lpTemp->uItem.lpParams;
 		delete lpTemp;
 		lpTemp = lpTemp2;
 	}
@@ -90,6 +91,30 @@ UserFuncList::~UserFuncList()
 } // ~UserFuncList()
 
 
+///////////////////////////////////////////////////////////////////////////////
+// hash()
+// FNV-1a hash of a function name.  Function names only contain A-Z, 0-9 and _
+// so lower case is folded to upper case with a simple ASCII test.
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned int UserFuncList::hash(const char *szName)
+{
+	unsigned int	nHash = 2166136261U;
+	unsigned char	ch;
+
+	while ( (ch = (unsigned char)*szName++) != '\0' )
+	{
+		if (ch >= 'a' && ch <= 'z')
+			ch -= 'a' - 'A';
+		nHash ^= ch;
+		nHash *= 16777619U;
+	}
+
+	return nHash;
+
+} // hash()
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // add()
 // Add a userfunction node (doesn't check for duplicates...)
@@ -97,26 +122,15 @@ UserFuncList::~UserFuncList()
 
 void UserFuncList::add(const UserFuncDetails &uItem)
 {
-	// If there is an index then no more additions are possible
-	if (m_Index)
-		return;
-
 	UserFuncListNode	*lpTemp;
 
 	// Create a new node
 	lpTemp			= new UserFuncListNode;
 	lpTemp->uItem	= uItem;
 	lpTemp->uItem.sName.toupper();				// Make sure funcname is stored as upper case
+	lpTemp->nHash	= hash(lpTemp->uItem.sName.c_str());
 	lpTemp->lpNext	= NULL;
 
-// Check that default assignment/copy constructor is indeed creating a new copy with different memory!
-//	char szText[100];
-//	sprintf(szText, "%p", &uItem.sName);
-//	MessageBox(NULL, szText, uItem.sName.c_str(), MB_OK);
-//	sprintf(szText, "%p", &lpTemp->uItem.sName);
-//	MessageBox(NULL, szText, lpTemp->uItem.sName.c_str(), MB_OK);
-
-
 	// Add it to the end of the list
 	if (m_lpLast)
 	{
@@ -129,114 +143,84 @@ void UserFuncList::add(const UserFuncDetails &uItem)
 		m_lpFirst = m_lpLast = lpTemp;
 	}
 
-	// Increase number of items
-	++m_nNumItems;
+	// Add it to the hash table
+	addnode(lpTemp);
 
 } // add()
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// find()
-// Lookup a function name and if found return the pointer to the details.
-// Once the first find operation is performed no more additions to the list
-// can be made.
+// addnode()
+// Add a node to the hash table, growing it to keep the load under 1/2.
 ///////////////////////////////////////////////////////////////////////////////
 
-UserFuncDetails* UserFuncList::find(AString sName)
+void UserFuncList::addnode(UserFuncListNode *lpNewNode)
 {
-	if (m_nNumItems == 0)
-		return NULL;							// No items to search!
-
-	// Convert the search name to upper case (everything stored as upper case)
-	sName.toupper();
+	unsigned int	nMask, i;
 
-	// Make sure we have an index
-	if (m_Index == NULL)
+	if ( (m_nNumItems + 1) * 2 > m_nTableSize )
 	{
-		// No index, slow search
-		UserFuncListNode	*lpTemp = m_lpFirst;
-
-		while(lpTemp != NULL)
-		{
-			if ( lpTemp->uItem.sName == sName)
-				return &lpTemp->uItem;			// Found, return the UserFuncDetails
-			else
-				lpTemp = lpTemp->lpNext;
-		}
-
-		return NULL;
-	}
+		// Rehash into a table twice the size
+		int					nOldSize	= m_nTableSize;
+		UserFuncListNode	**lpOld		= m_lpTable;
 
+		m_nTableSize	= nOldSize ? nOldSize * 2 : 64;
+		m_lpTable		= new UserFuncListNode*[m_nTableSize];
+		nMask			= (unsigned int)m_nTableSize - 1;
 
-	// Has index and the index is sorted so we do a quick binary search
-	// The built-in function list is in alphabetical order so we can do a binary search :)
-	int nFirst = 0;
-	int nLast = m_nNumItems - 1;
-	int nRes, i;
+		for (i = 0; i < (unsigned int)m_nTableSize; ++i)
+			m_lpTable[i] = NULL;
 
-	while (nFirst <= nLast)
-	{
-		i = (nFirst + nLast) / 2;			// Truncated to an integer!
+		for (int j = 0; j < nOldSize; ++j)
+		{
+			if (lpOld[j] == NULL)
+				continue;
 
-		nRes = strcmp( sName.c_str(), m_Index[i]->sName.c_str() );
+			i = lpOld[j]->nHash & nMask;
+			while (m_lpTable[i])
+				i = (i + 1) & nMask;
+			m_lpTable[i] = lpOld[j];
+		}
 
-		if ( nRes < 0 )
-			nLast = i - 1;
-		else if ( nRes > 0 )
-			nFirst = i + 1;
-		else
-			break;								// nRes == 0
+		delete [] lpOld;
 	}
 
-	if ( nFirst <= nLast )
-		return m_Index[i];
-	else
-		return NULL;
+	nMask = (unsigned int)m_nTableSize - 1;
+	i = lpNewNode->nHash & nMask;
+	while (m_lpTable[i])
+		i = (i + 1) & nMask;
 
-} // find()
+	m_lpTable[i] = lpNewNode;
+	++m_nNumItems;
+
+} // addnode()
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// createindex()
-// Create an index and then sort it for quick searching
+// find()
+// Lookup a function name and if found return the pointer to the details.
 ///////////////////////////////////////////////////////////////////////////////
 
-void UserFuncList::createindex(void)
+UserFuncDetails* UserFuncList::find(const char *szName) const
 {
-	if (m_nNumItems < 6)
-		return;									// Don't bother doing an index for < 6 items :)
-
-	int i;
+	if (m_nNumItems == 0)
+		return NULL;							// No items to search!
 
-	// Create an array/index of pointers
-	m_Index = new UserFuncDetails*[m_nNumItems];
+	unsigned int		nHash = hash(szName);
+	unsigned int		nMask = (unsigned int)m_nTableSize - 1;
+	unsigned int		i = nHash & nMask;
+	UserFuncListNode	*lpTemp;
 
-	UserFuncListNode	*lpTemp = m_lpFirst;
-	for (i = 0; i < m_nNumItems; ++i)
+	// Linear probe until we hit an empty entry (the table is never full), names
+	// are stored as upper case so compare without case
+	while ( (lpTemp = m_lpTable[i]) != NULL )
 	{
-		m_Index[i] = &lpTemp->uItem;			// Get direct pointer to the UserFuncDetails
-		lpTemp = lpTemp->lpNext;				// Next
-	}
-
-
-	// Bubble sort the list - yes, it is a crap sort but it is the smallest and
-	// speed is NOT really important here
-	bool bSwapOccured = true;
-	UserFuncDetails *lpFuncTemp;
+		if (lpTemp->nHash == nHash && stricmp(lpTemp->uItem.sName.c_str(), szName) == 0)
+			return &lpTemp->uItem;				// Found, return the UserFuncDetails
 
-	while (bSwapOccured)
-	{
-		bSwapOccured = false;
-		for (i = 0; i < (m_nNumItems-1); ++i)
-		{
-			if (m_Index[i]->sName > m_Index[i+1]->sName)
-			{
-				bSwapOccured = true;
-				lpFuncTemp = m_Index[i];
-				m_Index[i] = m_Index[i+1];
-				m_Index[i+1] = lpFuncTemp;
-			}
-		}
+		i = (i + 1) & nMask;
 	}
 
-} // createindex()
+	return NULL;
+
+} // find()
@@ -49,6 +49,14 @@
 #include "astring_datatype.h"
 
 
+typedef struct
+{
+	unsigned int	ivVar;							// Position of the $var token in the Func line
+	unsigned int	ivDefault;						// Position of the default value expression (0=none)
+	bool	bByRef;								// Passed by reference
+} UserFuncParam;
+
+
 typedef struct
 {
 	AString sName;								// Name of the user defined function
@@ -56,17 +64,24 @@ typedef struct
 	int		nNumParams;							// Number of parameters this function has
 	int		nNumParamsMin;						// Min Number of parameters this function has
 	int		nEndFuncLineNum;					// Line number of the EndFunc keyword
+	int		nNumSlots;							// Number of local variable slots in the function frame
+	int		*pnSlotIDs;							// Variable ID of each slot (owned by the list, or NULL)
+	UserFuncParam	*lpParams;					// Parsed parameter declarations (owned by the list, or NULL)
 } UserFuncDetails;
 
 
 typedef struct _UserFuncListNode
 {
 	UserFuncDetails	uItem;
+	unsigned int	nHash;						// Hash of the (upper case) function name
 	struct _UserFuncListNode	*lpNext;		// Next node (or NULL)
 
 } UserFuncListNode;
 
 
+// Functions are kept in a linked list (which owns them) and an open addressing
+// hash table (linear probing) for lookups.  Names are matched case insensitively.
+
 class UserFuncList
 {
 public:
@@ -75,15 +90,19 @@ public:
 	~UserFuncList();							// Destructor
 
 	void				add(const UserFuncDetails &uItem);	// Add item to the list
-	UserFuncDetails*	find(AString sName);
-	void				createindex(void);					// Creates the index and sorts the list - NO MORE ADDITIONS POSSIBLE
+	UserFuncDetails*	find(const char *szName) const;		// Lookup a function by name
 
 private:
+	// Functions
+	static unsigned int	hash(const char *szName);			// Hash a function name (case insensitive)
+	void				addnode(UserFuncListNode *lpNewNode);	// Add a node to the hash table
+
 	// Variables
 	UserFuncListNode	*m_lpFirst;				// Pointer to first node
 	UserFuncListNode	*m_lpLast;				// Pointer to last node
 
-	UserFuncDetails		**m_Index;
+	UserFuncListNode	**m_lpTable;			// Hash table of nodes (or NULL)
+	int					m_nTableSize;			// Size of m_lpTable (power of 2)
 	int					m_nNumItems;
 
 };
@@ -1504,15 +1504,15 @@ void Util_GetIPAddress(int nAdapter, char *szInetBuf)
 // Util_VariantArrayDim()
 //
 // Simple helper function for Diming a SINGLE dimension variant with specified
-// number of elements
+// number of elements.  Returns false if the array could not be allocated.
 //
 ///////////////////////////////////////////////////////////////////////////////
 
-void Util_VariantArrayDim(Variant *pvVariant, unsigned int iElements)
+bool Util_VariantArrayDim(Variant *pvVariant, unsigned int iElements)
 {
 	pvVariant->ArraySubscriptClear();			// Reset the subscript
 	pvVariant->ArraySubscriptSetNext(iElements);// Number of elements
-	pvVariant->ArrayDim();						// Dimension array
+	return pvVariant->ArrayDim();				// Dimension array
 
 } // Util_VariantArrayDim()
 
@@ -2001,6 +2001,66 @@ char * Util_fgetsb(char *szBuffer, int nBufSize, FILE *fptr)
 } // Util_fgetsb()
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Util_MapFile()
+//
+// Maps a whole file into memory for reading.  Returns false if the file
+// can't be opened or mapped.  An empty file can't be mapped so gives a NULL
+// view and a size of 0.  Release the view with Util_UnmapFile().
+///////////////////////////////////////////////////////////////////////////////
+
+bool Util_MapFile(const char *szFile, const char *&lpView, DWORD &dwSize)
+{
+	HANDLE	hFile, hMap;
+	DWORD	dwSizeHigh;
+
+	lpView	= NULL;
+	dwSize	= 0;
+
+	hFile = CreateFile(szFile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	dwSize = GetFileSize(hFile, &dwSizeHigh);
+	if (dwSizeHigh != 0 || dwSize > INT_MAX)
+	{
+		CloseHandle(hFile);						// Error, or too big for a string
+		return false;
+	}
+
+	if (dwSize == 0)
+	{
+		CloseHandle(hFile);
+		return true;
+	}
+
+	// The view keeps the mapping (and file) open so the handles can be closed straight away
+	hMap = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (hMap != NULL)
+	{
+		lpView = (const char *)MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(hMap);
+	}
+
+	CloseHandle(hFile);
+
+	return lpView != NULL;
+
+} // Util_MapFile()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Util_UnmapFile()
+///////////////////////////////////////////////////////////////////////////////
+
+void Util_UnmapFile(const char *lpView)
+{
+	if (lpView)
+		UnmapViewOfFile((LPCVOID)lpView);
+
+} // Util_UnmapFile()
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Util_Sleep()
 //
@@ -2056,6 +2116,26 @@ void Util_Sleep(int nTimeOut)
 } // Util_Sleep()
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Util_TimeLeft()
+//
+// Returns the number of ms left before a timer started at dwStart (a
+// timeGetTime() value) reaches dwTimeout, or 0 if it already has.  Unsigned
+// subtraction gives the right answer when timeGetTime() wraps at 2^32.
+///////////////////////////////////////////////////////////////////////////////
+
+DWORD Util_TimeLeft(DWORD dwStart, DWORD dwTimeout)
+{
+	DWORD	dwDiff = timeGetTime() - dwStart;
+
+	if (dwDiff >= dwTimeout)
+		return 0;
+	else
+		return dwTimeout - dwDiff;
+
+} // Util_TimeLeft()
+
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Util_WinPrintf()
@@ -106,7 +106,7 @@ BOOL	CALLBACK Util_GetClassListProc(HWND hWnd, LPARAM lParam);
 
 void	Util_GetIPAddress(int nAdapter, char *szInetBuf);
 
-void	Util_VariantArrayDim(Variant *pvVariant, unsigned int iElements);
+bool	Util_VariantArrayDim(Variant *pvVariant, unsigned int iElements);
 Variant * Util_VariantArrayGetRef(Variant *pvVariant, unsigned int iElement);
 
 void	Util_SoundPlay(const char *szFilename, bool bWait);
@@ -129,7 +129,10 @@ bool	Util_DownloadFile(const char *szUrl, const char *szOutFile, bool &bFatal);
 
 void	Util_Strncpy(char *szBuffer, const char *szString, int nBufSize);
 char *	Util_fgetsb(char *szBuffer, int nBufSize, FILE *fptr);
+bool	Util_MapFile(const char *szFile, const char *&lpView, DWORD &dwSize);
+void	Util_UnmapFile(const char *lpView);
 void	Util_Sleep(int nTimeOut);
+DWORD	Util_TimeLeft(DWORD dwStart, DWORD dwTimeout);
 int		Util_WinPrintf(const char *szTitle, const char *szFormat, ...);
 
 void	Util_BGRtoRGB(int &nCol);
@@ -57,7 +57,8 @@
 // Constructor()
 ///////////////////////////////////////////////////////////////////////////////
 
-VariableList::VariableList() : m_lpRoot(NULL)
+VariableList::VariableList() : m_lpTable(NULL), m_nTableSize(0), m_nNodes(0),
+	m_lpSlots(NULL), m_nSlots(0), m_pnSlotIDs(NULL)
 {
 
 } // VariableList()
@@ -69,38 +70,64 @@ VariableList::VariableList() : m_lpRoot(NULL)
 
 VariableList::~VariableList()
 {
-	removenode(m_lpRoot);
+	int	i;
+
+	for (i = 0; i < m_nTableSize; ++i)
+	{
+		if (m_lpTable[i])
+			freenode(m_lpTable[i]);
+	}
+
+	for (i = 0; i < m_nSlots; ++i)
+	{
+		if (m_lpSlots[i])
+			freenode(m_lpSlots[i]);
+	}
+
+	delete [] m_lpTable;
+	delete [] m_lpSlots;
 
 } // ~VariableList()
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// removenode()
-// Removes the given node and any children
+// freenode()
+// Frees a single node (table or slot)
 ///////////////////////////////////////////////////////////////////////////////
 
-void VariableList::removenode(VarNode *lpRoot)
+void VariableList::freenode(VarNode *lpNode)
 {
-	if (lpRoot == NULL)
-		return;
-
-	if (lpRoot->lpLeft)
-		removenode(lpRoot->lpLeft);
-	if (lpRoot->lpRight)
-		removenode(lpRoot->lpRight);
-
-	// All children deleted, now delete this node
-
 	// Do we need to free the memory for the variant, if it is a reference var then
 	// we don't have to as its owner will do it, if it is a normal variant then we
 	// must do it.
-	if (lpRoot->nType == VARTABLE_VARIANT)
-		delete lpRoot->pvVariant;			// Delete the variant
+	if (lpNode->nType == VARTABLE_VARIANT)
+		delete lpNode->pvVariant;			// Delete the variant
 
-	delete [] lpRoot->szName;				// Delete the string name
-	delete lpRoot;							// Delete the node itself
+	delete [] lpNode->szName;				// Delete the string name (NULL for slots)
+	delete lpNode;							// Delete the node itself
 
-} // removenode()
+} // freenode()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// hash()
+// FNV-1a hash of a variable name.  The variable table computes this once per
+// name so that lookups from tokens don't need to rehash.
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned int VariableList::hash(const char *szName)
+{
+	unsigned int	nHash = 2166136261U;
+
+	while (*szName)
+	{
+		nHash ^= (unsigned char)*szName++;
+		nHash *= 16777619U;
+	}
+
+	return nHash;
+
+} // hash()
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -108,21 +135,22 @@ void VariableList::removenode(VarNode *lpRoot)
 // Lookup a variable and if found return the pointer to the NODE
 ///////////////////////////////////////////////////////////////////////////////
 
-VarNode* VariableList::findvarnode(const char *szName)
+VarNode* VariableList::findvarnode(const char *szName, unsigned int nHash)
 {
-	VarNode	*lpTemp = m_lpRoot;
-	int	nRes;
+	if (m_nNodes == 0)
+		return NULL;
 
-	while (lpTemp != NULL)
-	{
-		nRes = strcmp(lpTemp->szName, szName);
+	unsigned int	nMask = (unsigned int)m_nTableSize - 1;
+	unsigned int	i = nHash & nMask;
+	VarNode			*lpTemp;
 
-		if (nRes < 0)
-			lpTemp = lpTemp->lpLeft;			// Less than (left child)
-		else if (nRes > 0)
-			lpTemp = lpTemp->lpRight;			// Greater than (right child)
-		else
+	// Linear probe until we hit an empty entry (the table is never full)
+	while ( (lpTemp = m_lpTable[i]) != NULL )
+	{
+		if (lpTemp->nHash == nHash && strcmp(lpTemp->szName, szName) == 0)
 			return lpTemp;						// Found
+
+		i = (i + 1) & nMask;
 	}
 
 	// Not found
@@ -136,9 +164,9 @@ VarNode* VariableList::findvarnode(const char *szName)
 // Lookup a variable name and if found return the pointer to the actual VARIANT data
 ///////////////////////////////////////////////////////////////////////////////
 
-Variant* VariableList::findvar(const char *szName, bool &bConst)
+Variant* VariableList::findvar(const char *szName, unsigned int nHash, bool &bConst)
 {
-	VarNode *lpTemp = findvarnode(szName);
+	VarNode *lpTemp = findvarnode(szName, nHash);
 
 	if (lpTemp)
 	{
@@ -151,14 +179,39 @@ Variant* VariableList::findvar(const char *szName, bool &bConst)
 } // findvar()
 
 
+///////////////////////////////////////////////////////////////////////////////
+// newnode()
+// Creates a node with a copy of the name (type/variant filled in by caller)
+///////////////////////////////////////////////////////////////////////////////
+
+VarNode* VariableList::newnode(const char *szName, unsigned int nHash)
+{
+	VarNode	*lpTemp		= new VarNode;
+
+	if (szName)
+	{
+		lpTemp->szName	= new char[strlen(szName)+1];
+		strcpy(lpTemp->szName, szName);
+	}
+	else
+		lpTemp->szName	= NULL;
+
+	lpTemp->nHash		= nHash;
+	lpTemp->bConst		= false;
+
+	return lpTemp;
+
+} // newnode()
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // addvar()
 // Add or update a variant to the list
 ///////////////////////////////////////////////////////////////////////////////
 
-void VariableList::addvar(const char *szName, const Variant &vVar, bool bConst)
+void VariableList::addvar(const char *szName, unsigned int nHash, const Variant &vVar, bool bConst)
 {
-	VarNode	*lpTemp = findvarnode(szName);
+	VarNode	*lpTemp = findvarnode(szName, nHash);
 
 	// Does this variable already exist?
 	if (lpTemp)
@@ -169,19 +222,13 @@ void VariableList::addvar(const char *szName, const Variant &vVar, bool bConst)
 	}
 
 	// Not found, add a new node
-	lpTemp				= new VarNode;
-
-	lpTemp->szName		= new char[strlen(szName)+1];
-	strcpy(lpTemp->szName, szName);
-
+	lpTemp				= newnode(szName, nHash);
 	lpTemp->nType		= VARTABLE_VARIANT;
 	lpTemp->pvVariant	= new Variant;
 	*(lpTemp->pvVariant)= vVar;
 	lpTemp->bConst		= bConst;
-	lpTemp->lpLeft		= NULL;
-	lpTemp->lpRight		= NULL;
 
-	addnode(szName, lpTemp);
+	addnode(lpTemp);
 
 } // addvar()
 
@@ -191,9 +238,9 @@ void VariableList::addvar(const char *szName, const Variant &vVar, bool bConst)
 // Add or update a reference to a variant to the list
 ///////////////////////////////////////////////////////////////////////////////
 
-void VariableList::addref(const char *szName, Variant *pvVar)
+void VariableList::addref(const char *szName, unsigned int nHash, Variant *pvVar)
 {
-	VarNode	*lpTemp = findvarnode(szName);
+	VarNode	*lpTemp = findvarnode(szName, nHash);
 
 	// Does this variable already exist?
 	if (lpTemp)
@@ -204,73 +251,243 @@ void VariableList::addref(const char *szName, Variant *pvVar)
 	}
 
 	// Not found, add a new node
-	lpTemp				= new VarNode;
-
-	lpTemp->szName		= new char[strlen(szName)+1];
-	strcpy(lpTemp->szName, szName);
-
+	lpTemp				= newnode(szName, nHash);
 	lpTemp->nType		= VARTABLE_REFERENCE;
 	lpTemp->pvVariant	= pvVar;				// Instead add a reference
-	lpTemp->bConst		= false;
-	lpTemp->lpLeft		= NULL;
-	lpTemp->lpRight		= NULL;
 
-	// Add this node to the tree
-	addnode(szName, lpTemp);
+	// Add this node to the table
+	addnode(lpTemp);
 
 } // addref()
 
 
 ///////////////////////////////////////////////////////////////////////////////
 // addnode()
-// Add a new node to the tree.
-// ASSUMES THE NAME DOES NOT ALREADY EXIST IN THE TREE.  MUST CHECK BEFORE
+// Add a new node to the hash table, growing it to keep the load under 1/2.
+// ASSUMES THE NAME DOES NOT ALREADY EXIST IN THE TABLE.  MUST CHECK BEFORE
 // CALLING THIS FUNCTION!
 ///////////////////////////////////////////////////////////////////////////////
 
-void VariableList::addnode(const char *szName, VarNode *lpNewNode)
+void VariableList::addnode(VarNode *lpNewNode)
 {
-	if (m_lpRoot == NULL)
+	unsigned int	nMask, i;
+
+	if ( (m_nNodes + 1) * 2 > m_nTableSize )
 	{
-		// Very first entry
-		m_lpRoot = lpNewNode;
-		return;
-	}
+		// Rehash into a table twice the size
+		int		nOldSize	= m_nTableSize;
+		VarNode	**lpOld		= m_lpTable;
 
-	// Not the root entry, Find a place in the tree to add this node
-	// Note we only have to check for < and > because we know from above that
-	// the exact entry does NOT exist
-	VarNode	*lpCur = m_lpRoot;
-	int		nRes;
+		m_nTableSize	= nOldSize ? nOldSize * 2 : 16;
+		m_lpTable		= new VarNode*[m_nTableSize];
+		nMask			= (unsigned int)m_nTableSize - 1;
 
-	for (;;)
-	{
-		nRes = strcmp(lpCur->szName, szName);
+		for (i = 0; i < (unsigned int)m_nTableSize; ++i)
+			m_lpTable[i] = NULL;
 
-		if (nRes < 0)
+		for (int j = 0; j < nOldSize; ++j)
 		{
-			// Less than (left child)
-			// Another node to check or do we add the new node here?
-			if (lpCur->lpLeft)
-				lpCur = lpCur->lpLeft;			// Next node
-			else
-			{
-				lpCur->lpLeft = lpNewNode;		// Add the node here
-				break;
-			}
-		}
-		else
-		{
-			// Greater than (right child)
-			if (lpCur->lpRight)
-				lpCur = lpCur->lpRight;			// Next node
-			else
-			{
-				lpCur->lpRight = lpNewNode;		// Add the node here
-				break;
-			}
+			if (lpOld[j] == NULL)
+				continue;
+
+			i = lpOld[j]->nHash & nMask;
+			while (m_lpTable[i])
+				i = (i + 1) & nMask;
+			m_lpTable[i] = lpOld[j];
 		}
+
+		delete [] lpOld;
 	}
 
+	nMask = (unsigned int)m_nTableSize - 1;
+	i = lpNewNode->nHash & nMask;
+	while (m_lpTable[i])
+		i = (i + 1) & nMask;
+
+	m_lpTable[i] = lpNewNode;
+	++m_nNodes;
+
 } // addnode()
 
+
+///////////////////////////////////////////////////////////////////////////////
+// setslots()
+// Creates nSlots empty slots for a function frame.  pnSlotIDs gives the
+// variable ID of each slot and must remain valid for the life of the list.
+///////////////////////////////////////////////////////////////////////////////
+
+void VariableList::setslots(int nSlots, const int *pnSlotIDs)
+{
+	if (nSlots <= 0 || m_lpSlots)
+		return;
+
+	m_lpSlots	= new VarNode*[nSlots];
+	m_nSlots	= nSlots;
+	m_pnSlotIDs	= pnSlotIDs;
+
+	for (int i = 0; i < nSlots; ++i)
+		m_lpSlots[i] = NULL;
+
+} // setslots()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// findslot()
+// Returns the frame slot used for the variable nID or -1 if it has none.
+// nHint is the slot the lexer assigned to the token (checked before use as
+// the token may be executing in a different frame).
+///////////////////////////////////////////////////////////////////////////////
+
+int VariableList::findslot(int nID, int nHint) const
+{
+	if (m_pnSlotIDs == NULL || nID < 0)
+		return -1;
+
+	if (nHint >= 0 && nHint < m_nSlots && m_pnSlotIDs[nHint] == nID)
+		return nHint;
+
+	for (int i = 0; i < m_nSlots; ++i)
+	{
+		if (m_pnSlotIDs[i] == nID)
+			return i;
+	}
+
+	return -1;
+
+} // findslot()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// findslotvar()
+// Return the pointer to the variant held in a slot (or NULL if unassigned)
+///////////////////////////////////////////////////////////////////////////////
+
+Variant* VariableList::findslotvar(int nSlot, bool &bConst)
+{
+	VarNode	*lpTemp;
+
+	if (nSlot >= m_nSlots || (lpTemp = m_lpSlots[nSlot]) == NULL)
+		return NULL;
+
+	bConst = lpTemp->bConst;
+	return lpTemp->pvVariant;
+
+} // findslotvar()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// addslotvar()
+// Add or update a variant held in a slot
+///////////////////////////////////////////////////////////////////////////////
+
+void VariableList::addslotvar(int nSlot, const Variant &vVar, bool bConst)
+{
+	growslots(nSlot);
+
+	VarNode	*lpTemp = m_lpSlots[nSlot];
+
+	// Does this variable already exist?
+	if (lpTemp)
+	{
+		// Found, update entry
+		*(lpTemp->pvVariant) = vVar;
+		return;
+	}
+
+	lpTemp				= newnode(NULL, 0);
+	lpTemp->nType		= VARTABLE_VARIANT;
+	lpTemp->pvVariant	= new Variant;
+	*(lpTemp->pvVariant)= vVar;
+	lpTemp->bConst		= bConst;
+
+	m_lpSlots[nSlot]	= lpTemp;
+
+} // addslotvar()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// addslotref()
+// Add or update a reference to a variant held in a slot
+///////////////////////////////////////////////////////////////////////////////
+
+void VariableList::addslotref(int nSlot, Variant *pvVar)
+{
+	growslots(nSlot);
+
+	VarNode	*lpTemp = m_lpSlots[nSlot];
+
+	// Does this variable already exist?
+	if (lpTemp)
+	{
+		// Found, update entry
+		lpTemp->pvVariant = pvVar;
+		return;
+	}
+
+	lpTemp				= newnode(NULL, 0);
+	lpTemp->nType		= VARTABLE_REFERENCE;
+	lpTemp->pvVariant	= pvVar;				// Instead add a reference
+
+	m_lpSlots[nSlot]	= lpTemp;
+
+} // addslotref()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// adoptvar()
+// If the named variable exists in the table then move ownership of its
+// variant into a slot.  The table node is left behind as a reference to the
+// same variant so nothing has to be removed from the table.
+///////////////////////////////////////////////////////////////////////////////
+
+void VariableList::adoptvar(const char *szName, unsigned int nHash, int nSlot)
+{
+	VarNode	*lpNode = findvarnode(szName, nHash);
+
+	if (lpNode == NULL)
+		return;
+
+	growslots(nSlot);
+	if (m_lpSlots[nSlot])
+		return;
+
+	VarNode	*lpTemp		= newnode(NULL, 0);
+	lpTemp->nType		= lpNode->nType;
+	lpTemp->pvVariant	= lpNode->pvVariant;
+	lpTemp->bConst		= lpNode->bConst;
+
+	m_lpSlots[nSlot]	= lpTemp;
+	lpNode->nType		= VARTABLE_REFERENCE;	// Slot now owns the variant
+
+} // adoptvar()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// growslots()
+// Make sure nSlot is a valid index.  Only lists indexed directly by variable
+// ID (no m_pnSlotIDs) ever grow, frame lists are sized by setslots().
+///////////////////////////////////////////////////////////////////////////////
+
+void VariableList::growslots(int nSlot)
+{
+	if (nSlot < m_nSlots)
+		return;
+
+	int		nNewSlots = m_nSlots ? m_nSlots * 2 : 64;
+	while (nNewSlots <= nSlot)
+		nNewSlots *= 2;
+
+	VarNode	**lpNewSlots = new VarNode*[nNewSlots];
+	int		i;
+
+	for (i = 0; i < m_nSlots; ++i)
+		lpNewSlots[i] = m_lpSlots[i];
+	for (; i < nNewSlots; ++i)
+		lpNewSlots[i] = NULL;
+
+	delete [] m_lpSlots;
+	m_lpSlots	= lpNewSlots;
+	m_nSlots	= nNewSlots;
+
+} // growslots()
+
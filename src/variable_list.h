@@ -42,6 +42,15 @@
 //
 // A list of named variables.  (Case sensitive!)
 //
+// Named variables are kept in an open addressing hash table (linear probing).
+// Variables are never removed from a list, only the whole list is freed, so
+// the table needs no deletion markers.
+//
+// Variables whose names were resolved to a script-wide ID by the lexer may
+// also be held in a flat array of slots.  The slot to ID mapping belongs to
+// the owner of the list (see VariableTable); a variable is only ever owned by
+// either a slot or the name table, never both.
+//
 ///////////////////////////////////////////////////////////////////////////////
 
 
@@ -68,12 +77,11 @@ typedef struct _VarEntry
 typedef struct _VarNode
 {
 	char			*szName;					// Name of this variable
+	unsigned int	nHash;						// Hash of szName
 	int				nType;						// Variant OR reference to a variant
 	Variant			*pvVariant;					// Pointer to a variant (either a reference to another, or one we create!)
 	bool			bConst;						// True is this is a const
 
-	_VarNode		*lpLeft, *lpRight;			// Left/Right nodes, or NULL if no child
-
 } VarNode;
 
 
@@ -85,17 +93,41 @@ public:
 	VariableList();								// Constructor
 	~VariableList();							// Destructor
 
-	void		addvar(const char *szName, const Variant &vVar, bool bConst);	// Add/update variant to the list
-	void		addref(const char *szName, Variant *pvVar);						// Add/update variant REFERENCE to the list
-	Variant*	findvar(const char *szName, bool &bConst);						// Find a variable in the list
+	static unsigned int	hash(const char *szName);							// Hash a variable name
+
+	void		addvar(const char *szName, const Variant &vVar, bool bConst)	// Add/update variant to the list
+					{ addvar(szName, hash(szName), vVar, bConst); }
+	void		addref(const char *szName, Variant *pvVar)						// Add/update variant REFERENCE to the list
+					{ addref(szName, hash(szName), pvVar); }
+	Variant*	findvar(const char *szName, bool &bConst)						// Find a variable in the list
+					{ return findvar(szName, hash(szName), bConst); }
+
+	void		addvar(const char *szName, unsigned int nHash, const Variant &vVar, bool bConst);
+	void		addref(const char *szName, unsigned int nHash, Variant *pvVar);
+	Variant*	findvar(const char *szName, unsigned int nHash, bool &bConst);
+
+	void		setslots(int nSlots, const int *pnSlotIDs);						// Create empty frame slots
+	int			findslot(int nID, int nHint) const;								// Get the frame slot for an ID (or -1)
+	Variant*	findslotvar(int nSlot, bool &bConst);							// Find a variable in a slot
+	void		addslotvar(int nSlot, const Variant &vVar, bool bConst);		// Add/update variant in a slot
+	void		addslotref(int nSlot, Variant *pvVar);							// Add/update variant REFERENCE in a slot
+	void		adoptvar(const char *szName, unsigned int nHash, int nSlot);	// Move a named variable into a slot
 
 private:
-	void		removenode(VarNode *lpRoot);
-	VarNode*	findvarnode(const char *szName);
-	void		addnode(const char *szName, VarNode *lpNewNode);
+	void		freenode(VarNode *lpNode);
+	VarNode*	findvarnode(const char *szName, unsigned int nHash);
+	VarNode*	newnode(const char *szName, unsigned int nHash);
+	void		addnode(VarNode *lpNewNode);
+	void		growslots(int nSlot);
 
 	// Variables
-	VarNode		*m_lpRoot;						// Pointer to root node, or NULL if none yet.
+	VarNode		**m_lpTable;					// Open addressing hash table of named variables (or NULL)
+	int			m_nTableSize;					// Size of m_lpTable (power of 2)
+	int			m_nNodes;						// Number of entries in m_lpTable
+
+	VarNode		**m_lpSlots;					// Slot array (entries are NULL until assigned)
+	int			m_nSlots;						// Number of entries in m_lpSlots
+	const int	*m_pnSlotIDs;					// Frame slot -> variable ID (NULL = slot is the ID)
 
 };
 
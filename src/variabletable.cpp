@@ -53,35 +53,210 @@
 #include "variabletable.h"
 
 
+
 ///////////////////////////////////////////////////////////////////////////////
-// Assign()
+// Constructor()
 ///////////////////////////////////////////////////////////////////////////////
 
-bool VariableTable::Assign(AString sVarName, const Variant &vVariant, bool bConst, int nReqScope)
+VariableTable::VariableTable() : m_szVarNames(NULL), m_pnVarHashes(NULL), m_nVarIDs(0), m_nVarIDsAlloc(0)
+{
+
+} // VariableTable()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor()
+///////////////////////////////////////////////////////////////////////////////
+
+VariableTable::~VariableTable()
+{
+	for (int i = 0; i < m_nVarIDs; ++i)
+		delete [] m_szVarNames[i];
+
+	delete [] m_szVarNames;
+	delete [] m_pnVarHashes;
+
+} // ~VariableTable()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RegisterVar()
+//
+// Called by the lexer for every $variable token.  Returns the script-wide ID
+// for the name, allocating a new one if this is the first time it was seen.
+// If a global of that name was already created by name (e.g. $CmdLine) it is
+// moved into its ID slot.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+int VariableTable::RegisterVar(const char *szName)
 {
+	AString	sVarName = szName;
+
 	sVarName.toupper();							// Always use uppercase to force case insensitive operation
 
-	switch (nReqScope)
+	unsigned int	nHash = VariableList::hash(sVarName.c_str());
+	int				nID = FindVarID(sVarName.c_str(), nHash);
+	if (nID >= 0)
+		return nID;
+
+	// New name, make sure there is room in the ID -> name array
+	if (m_nVarIDs >= m_nVarIDsAlloc)
+	{
+		int				nNewAlloc = m_nVarIDsAlloc ? m_nVarIDsAlloc * 2 : 64;
+		char			**szNewNames = new char*[nNewAlloc];
+		unsigned int	*pnNewHashes = new unsigned int[nNewAlloc];
+
+		for (int i = 0; i < m_nVarIDs; ++i)
+		{
+			szNewNames[i] = m_szVarNames[i];
+			pnNewHashes[i] = m_pnVarHashes[i];
+		}
+
+		delete [] m_szVarNames;
+		delete [] m_pnVarHashes;
+		m_szVarNames	= szNewNames;
+		m_pnVarHashes	= pnNewHashes;
+		m_nVarIDsAlloc	= nNewAlloc;
+	}
+
+	nID = m_nVarIDs++;
+
+	m_szVarNames[nID] = new char[sVarName.length()+1];
+	strcpy(m_szVarNames[nID], sVarName.c_str());
+	m_pnVarHashes[nID] = nHash;
+
+	Variant	vID;
+	vID = nID;
+	m_VarIDs.addvar(sVarName.c_str(), nHash, vID, true);
+
+	m_Globals.adoptvar(sVarName.c_str(), nHash, nID);
+
+	return nID;
+
+} // RegisterVar()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FindVarID()
+//
+// Returns the ID of a registered (uppercase) name, or -1 if not registered.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+int VariableTable::FindVarID(const char *szName, unsigned int nHash)
+{
+	bool	bConst;
+	Variant	*pvID = m_VarIDs.findvar(szName, nHash, bConst);
+
+	return pvID ? pvID->nValue() : -1;
+
+} // FindVarID()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Lookup()
+//
+// Common lookup for the name and token based functions.  szName must be
+// uppercase and nHash its hash, nID may be -1 for an unregistered name, nSlot
+// is the local slot hint from the token (or -1).
+//
+///////////////////////////////////////////////////////////////////////////////
+
+Variant* VariableTable::Lookup(int nID, int nSlot, const char *szName, unsigned int nHash, bool &bConst, int nReqScope)
+{
+	Variant *lpVar = NULL;
+
+	if (nReqScope != VARTABLE_FORCEGLOBAL && !m_Locals.empty())
+	{
+		VariableList *lpLocals = m_Locals.top();
+
+		nSlot = lpLocals->findslot(nID, nSlot);
+		if (nSlot >= 0)
+			lpVar = lpLocals->findslotvar(nSlot, bConst);
+		else
+			lpVar = lpLocals->findvar(szName, nHash, bConst);
+
+		if (nReqScope == VARTABLE_FORCELOCAL)
+			return lpVar;
+	}
+
+	if (lpVar == NULL)
+	{
+		if (nID >= 0)
+			lpVar = m_Globals.findslotvar(nID, bConst);
+		else
+			lpVar = m_Globals.findvar(szName, nHash, bConst);
+	}
+
+	return lpVar;
+
+} // Lookup()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Store()
+//
+// Common assignment for the name and token based functions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+void VariableTable::Store(int nID, int nSlot, const char *szName, unsigned int nHash, const Variant &vVariant, bool bConst, int nReqScope)
+{
+	if (nReqScope != VARTABLE_FORCEGLOBAL && !m_Locals.empty())
+	{
+		VariableList *lpLocals = m_Locals.top();
+
+		nSlot = lpLocals->findslot(nID, nSlot);
+		if (nSlot >= 0)
+			lpLocals->addslotvar(nSlot, vVariant, bConst);
+		else
+			lpLocals->addvar(szName, nHash, vVariant, bConst);
+	}
+	else
 	{
-		case VARTABLE_ANY:
-			if (m_Locals.empty())
-				m_Globals.addvar(sVarName.c_str(), vVariant, bConst);
-			else
-				m_Locals.top()->addvar(sVarName.c_str(), vVariant, bConst);
-			break;
-
-		case VARTABLE_FORCELOCAL:
-			if (m_Locals.empty())
-				m_Globals.addvar(sVarName.c_str(), vVariant, bConst);
-			else
-				m_Locals.top()->addvar(sVarName.c_str(), vVariant, bConst);
-			break;
-
-		case VARTABLE_FORCEGLOBAL:
-			m_Globals.addvar(sVarName.c_str(), vVariant, bConst);
-			break;
+		if (nID >= 0)
+			m_Globals.addslotvar(nID, vVariant, bConst);
+		else
+			m_Globals.addvar(szName, nHash, vVariant, bConst);
 	}
 
+} // Store()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Assign()
+///////////////////////////////////////////////////////////////////////////////
+
+bool VariableTable::Assign(AString sVarName, const Variant &vVariant, bool bConst, int nReqScope)
+{
+	sVarName.toupper();							// Always use uppercase to force case insensitive operation
+
+	unsigned int nHash = VariableList::hash(sVarName.c_str());
+
+	Store(FindVarID(sVarName.c_str(), nHash), -1, sVarName.c_str(), nHash, vVariant, bConst, nReqScope);
+
+	return true;
+
+} // Assign()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Assign()
+//
+// Token version, uses the variable ID and slot resolved by the lexer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+bool VariableTable::Assign(const Token &tokVar, const Variant &vVariant, bool bConst, int nReqScope)
+{
+	int nID = tokVar.m_nVarID;
+
+	if (nID < 0)
+		return Assign(tokVar.szValue, vVariant, bConst, nReqScope);
+
+	Store(nID, tokVar.m_nVarSlot, m_szVarNames[nID], m_pnVarHashes[nID], vVariant, bConst, nReqScope);
+
 	return true;
 
 } // Assign()
@@ -93,37 +268,34 @@ bool VariableTable::Assign(AString sVarName, const Variant &vVariant, bool bCons
 
 bool VariableTable::GetRef(AString sVarName, Variant **pvVariant, bool &bConst, int nReqScope)
 {
-	Variant *lpVar = NULL;
-
 	sVarName.toupper();							// Always use uppercase to force case insensitive operation
 
-	switch (nReqScope)
-	{
-		case VARTABLE_ANY:
-			if (!m_Locals.empty())
-				lpVar = m_Locals.top()->findvar(sVarName.c_str(), bConst);
+	unsigned int nHash = VariableList::hash(sVarName.c_str());
 
-			if (lpVar == NULL)
-				lpVar = m_Globals.findvar(sVarName.c_str(), bConst);
+	*pvVariant = Lookup(FindVarID(sVarName.c_str(), nHash), -1, sVarName.c_str(), nHash, bConst, nReqScope);
 
-			break;
+	return (*pvVariant != NULL);
 
-		case VARTABLE_FORCELOCAL:
-			if (!m_Locals.empty())
-				lpVar = m_Locals.top()->findvar(sVarName.c_str(), bConst);
-			else
-				lpVar = m_Globals.findvar(sVarName.c_str(), bConst);
+} // GetRef()
 
-			break;
 
-		case VARTABLE_FORCEGLOBAL:
-			lpVar = m_Globals.findvar(sVarName.c_str(), bConst);
-			break;
-	}
+///////////////////////////////////////////////////////////////////////////////
+// GetRef()
+//
+// Token version, uses the variable ID and slot resolved by the lexer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+bool VariableTable::GetRef(const Token &tokVar, Variant **pvVariant, bool &bConst, int nReqScope)
+{
+	int nID = tokVar.m_nVarID;
+
+	if (nID < 0)
+		return GetRef(tokVar.szValue, pvVariant, bConst, nReqScope);
 
-	*pvVariant = lpVar;
+	*pvVariant = Lookup(nID, tokVar.m_nVarSlot, m_szVarNames[nID], m_pnVarHashes[nID], bConst, nReqScope);
 
-	return (lpVar != NULL);
+	return (*pvVariant != NULL);
 
 } // GetRef()
 
@@ -150,7 +322,45 @@ bool VariableTable::CreateRef(AString sRefName, Variant *pvVariant)
 	if (m_Locals.empty() || pvVariant == NULL)
 		return false;
 
-	m_Locals.top()->addref(sRefName.c_str(), pvVariant);
+	VariableList	*lpLocals = m_Locals.top();
+	unsigned int	nHash = VariableList::hash(sRefName.c_str());
+	int				nSlot = lpLocals->findslot(FindVarID(sRefName.c_str(), nHash), -1);
+
+	if (nSlot >= 0)
+		lpLocals->addslotref(nSlot, pvVariant);
+	else
+		lpLocals->addref(sRefName.c_str(), nHash, pvVariant);
+
+	return true;
+
+} // CreateRef()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// CreateRef()
+//
+// Token version, uses the variable ID and slot resolved by the lexer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+bool VariableTable::CreateRef(const Token &tokVar, Variant *pvVariant)
+{
+	int nID = tokVar.m_nVarID;
+
+	if (nID < 0)
+		return CreateRef(tokVar.szValue, pvVariant);
+
+	// If not in a local function, then can't execute
+	if (m_Locals.empty() || pvVariant == NULL)
+		return false;
+
+	VariableList	*lpLocals = m_Locals.top();
+	int				nSlot = lpLocals->findslot(nID, tokVar.m_nVarSlot);
+
+	if (nSlot >= 0)
+		lpLocals->addslotref(nSlot, pvVariant);
+	else
+		lpLocals->addref(m_szVarNames[nID], m_pnVarHashes[nID], pvVariant);
 
 	return true;
 
@@ -159,11 +369,15 @@ bool VariableTable::CreateRef(AString sRefName, Variant *pvVariant)
 
 ///////////////////////////////////////////////////////////////////////////////
 // ScopeIncrease()
+//
+// nSlots/pnSlotIDs give the local variable slots of the user function being
+// called (pnSlotIDs must stay valid until the matching ScopeDecrease()).
+//
 ///////////////////////////////////////////////////////////////////////////////
 
-void VariableTable::ScopeIncrease(void)
+void VariableTable::ScopeIncrease(int nSlots, const int *pnSlotIDs)
 {
-	m_Locals.push();
+	m_Locals.push(nSlots, pnSlotIDs);
 
 } // ScopeIncrease()
 
@@ -192,12 +406,15 @@ int VariableTable::isDeclared(AString sVarName)
 
 	sVarName.toupper();							// Always use uppercase to force case insensitive operation
 
+	unsigned int	nHash = VariableList::hash(sVarName.c_str());
+	int				nID = FindVarID(sVarName.c_str(), nHash);
+
 	// Look in local variables
-	if (!(m_Locals.empty()) && m_Locals.top()->findvar(sVarName.c_str(), bConst) != NULL)
+	if (!(m_Locals.empty()) && Lookup(nID, -1, sVarName.c_str(), nHash, bConst, VARTABLE_FORCELOCAL) != NULL)
 		return -1;								// Local
 
 	// Look in global variables
-	if (m_Globals.findvar(sVarName.c_str(), bConst) != NULL)
+	if (Lookup(nID, -1, sVarName.c_str(), nHash, bConst, VARTABLE_FORCEGLOBAL) != NULL)
 		return 1;								// Global
 
 	// not found at all
@@ -46,11 +46,20 @@
 // characters will never appear in a variable name.  But, we may internally store
 // variables with other names in the table for special uses.  (Such as @ExitMethod)
 //
+// Every $variable name seen by the lexer is registered and given a script-wide
+// ID which is stored in the token.  Globals with a registered name are held
+// in a flat array indexed by that ID, and locals of a user function in the
+// slots assigned to the function when the script was loaded, so token based
+// lookups never compare names.  Other names (and locals created by name, e.g.
+// with Assign()) still live in the name tables and lookups fall back to them.
+// The hash of each registered name is computed once and kept with its ID.
+//
 ///////////////////////////////////////////////////////////////////////////////
 
 
 // Includes
 #include "stack_variable_list.h"
+#include "token_datatype.h"
 
 // Magic numbers used in assigning/getting vars, sometimes we want force local/global operations
 #define VARTABLE_ANY			0				// Any type (local first, then global)
@@ -64,13 +73,34 @@ private:
 	VariableList	m_Globals;					// global variables
 	StackVarList	m_Locals;					// local variables
 
+	VariableList	m_VarIDs;					// Registered variable names (value is the ID)
+	char			**m_szVarNames;				// Uppercase name of each registered ID
+	unsigned int	*m_pnVarHashes;				// Name hash of each registered ID
+	int				m_nVarIDs;					// Number of registered IDs
+	int				m_nVarIDsAlloc;				// Allocated size of m_szVarNames
+
+	int			FindVarID(const char *szName, unsigned int nHash);	// Get ID of an uppercase name (or -1)
+	Variant*	Lookup(int nID, int nSlot, const char *szName, unsigned int nHash, bool &bConst, int nReqScope);
+	void		Store(int nID, int nSlot, const char *szName, unsigned int nHash, const Variant &vVariant, bool bConst, int nReqScope);
+
 public:
 	// Functions
+	VariableTable();							// Constructor
+	~VariableTable();							// Destructor
+
 	bool	Assign(AString sVarName, const Variant &vVariant, bool bConst = false, int nReqScope = VARTABLE_ANY);	// Assign variable
 	bool	GetRef(AString sVarName, Variant **pvVariant, bool &bConst, int nReqScope = VARTABLE_ANY);		// Get pointer to a variable
 	bool	CreateRef(AString sRefName, Variant *pvVariant);									// Create a reference variable (alt)
 
-	void	ScopeIncrease(void);				// Increase scope (user function call)
+	bool	Assign(const Token &tokVar, const Variant &vVariant, bool bConst = false, int nReqScope = VARTABLE_ANY);	// Assign variable (token)
+	bool	GetRef(const Token &tokVar, Variant **pvVariant, bool &bConst, int nReqScope = VARTABLE_ANY);		// Get pointer to a variable (token)
+	bool	CreateRef(const Token &tokVar, Variant *pvVariant);									// Create a reference variable (token)
+
+	int		RegisterVar(const char *szName);	// Register a $variable name and return its ID
+	int		GetNumVarIDs(void) const			// Number of registered variable IDs
+				{ return m_nVarIDs; }
+
+	void	ScopeIncrease(int nSlots = 0, const int *pnSlotIDs = NULL);	// Increase scope (user function call)
 	void	ScopeDecrease(void);				// Decrease scope (return from user function)
 	int		isDeclared(AString sVarName);		// Return true if the reference variable exists (and type of variable, global/local etc)
 	bool	IsGlobalLevel(void)					// Returns true when vartable is in base/global state
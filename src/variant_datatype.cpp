@@ -49,11 +49,18 @@
 	#include <stdlib.h>
 	#include <string.h>
 	#include <windef.h>
+	#include <new.h>
 #endif
 
+#include <new>									// std::nothrow
+
 #include "variant_datatype.h"
 
 
+// Largest number of elements that can be allocated in one block
+#define VAR_ARRAY_MAXELEMENTS	((__int64)(((size_t)-1) / sizeof(Variant)))
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Copy constructor
 ///////////////////////////////////////////////////////////////////////////////
@@ -80,9 +87,8 @@ Variant::Variant(const Variant &vOp2):
 
 		case VAR_STRING:
 			m_nStrLen	= vOp2.m_nStrLen;
-			m_nStrAlloc = m_nStrLen + 1;
-			m_szValue	= new char[m_nStrAlloc];
-			strcpy(m_szValue, vOp2.m_szValue);
+			StringAlloc(m_nStrLen + 1);
+			memcpy(m_szValue, vOp2.m_szValue, m_nStrLen + 1);
 			break;
 
 		case VAR_REFERENCE:
@@ -106,15 +112,9 @@ Variant::Variant(const Variant &vOp2):
 			// Allocate this array (based on _current_ subscript)
 			ArrayDim();
 
-			// Now copy the individual variant elements (each array element is a pointer to a variant)
-			for (i=0; i<m_Array->nElements; i++)
-			{
-				if (vOp2.m_Array->Data[i] != NULL)
-				{
-					m_Array->Data[i] = new Variant;	// Allocate a variant for this spot
-					*(m_Array->Data[i]) = *(vOp2.m_Array->Data[i]);
-				}
-			}
+			// Now copy the individual variant elements (one contiguous block)
+			for (__int64 n=0; n<m_Array->nElements; n++)
+				m_Array->Data[n] = vOp2.m_Array->Data[n];
 			break;
 	}
 }
@@ -158,6 +158,37 @@ void Variant::ReInit(void)
 } // ReInit()
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Swap()
+//
+// Exchanges the contents of two variants without copying any strings or
+// array elements.  Used to move values around (e.g. during ReDim) and as the
+// "move" for results and stack/vector items.
+///////////////////////////////////////////////////////////////////////////////
+
+void Variant::Swap(Variant &vOp2)
+{
+	__int64	n64Temp;
+	char	*szTemp;
+	int		nTemp;
+	bool	bInline1 = (m_szValue == m_szInline);
+	bool	bInline2 = (vOp2.m_szValue == vOp2.m_szInline);
+
+	n64Temp = m_n64Value;	m_n64Value	= vOp2.m_n64Value;	vOp2.m_n64Value	= n64Temp;	// Whole union
+	szTemp	= m_szValue;	m_szValue	= vOp2.m_szValue;	vOp2.m_szValue	= szTemp;
+	nTemp	= m_nStrLen;	m_nStrLen	= vOp2.m_nStrLen;	vOp2.m_nStrLen	= nTemp;
+	nTemp	= m_nStrAlloc;	m_nStrAlloc	= vOp2.m_nStrAlloc;	vOp2.m_nStrAlloc= nTemp;
+	nTemp	= m_nVarType;	m_nVarType	= vOp2.m_nVarType;	vOp2.m_nVarType	= nTemp;
+
+	// Inline strings moved with the union, so point them at their new home
+	if (bInline2)
+		m_szValue = m_szInline;
+	if (bInline1)
+		vOp2.m_szValue = vOp2.m_szInline;
+
+} // Swap()
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // HexToDec()
 ///////////////////////////////////////////////////////////////////////////////
@@ -201,6 +232,177 @@ bool Variant::HexToDec(const char *szHex, int &nDec)
 } // Util_ConvDec()
 
 
+///////////////////////////////////////////////////////////////////////////////
+// FormatInt64()
+//
+// Writes the decimal version of a number to szBuf (at least 21 bytes) and
+// returns its length.  Same output as _i64toa() but two digits at a time.
+///////////////////////////////////////////////////////////////////////////////
+
+int Variant::FormatInt64(__int64 n64Value, char *szBuf)
+{
+	static const char szPairs[] =
+		"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+		"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+		"8081828384858687888990919293949596979899";
+
+	char				szTemp[24];
+	char				*p = &szTemp[sizeof(szTemp)];
+	unsigned __int64	u64;
+	int					nLen = 0;
+	int					i;
+
+	// Work with the magnitude as unsigned so that the most negative int64 is OK
+	if (n64Value < 0)
+	{
+		u64 = (unsigned __int64)0 - (unsigned __int64)n64Value;
+		szBuf[nLen++] = '-';
+	}
+	else
+		u64 = (unsigned __int64)n64Value;
+
+	while (u64 >= 100)
+	{
+		i = (int)(u64 % 100) * 2;
+		u64 /= 100;
+		*--p = szPairs[i+1];
+		*--p = szPairs[i];
+	}
+
+	if (u64 >= 10)
+	{
+		i = (int)u64 * 2;
+		*--p = szPairs[i+1];
+		*--p = szPairs[i];
+	}
+	else
+		*--p = (char)('0' + (int)u64);
+
+	while (p < &szTemp[sizeof(szTemp)])
+		szBuf[nLen++] = *p++;
+
+	szBuf[nLen] = '\0';
+
+	return nLen;
+
+} // FormatInt64()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FormatDouble()
+//
+// Same output as sprintf("%.15g") (what AutoIt has always used) and returns
+// the length.  Whole numbers below 1e15 are printed by %.15g with no decimal
+// point or exponent so they take the FormatInt64() path and skip the CRT.
+///////////////////////////////////////////////////////////////////////////////
+
+int Variant::FormatDouble(double fValue, char *szBuf)
+{
+	if (fValue > -1e15 && fValue < 1e15)
+	{
+		__int64	n64Temp = (__int64)fValue;
+
+		// -0.0 prints as "-0" so leave it to sprintf
+		if ((double)n64Temp == fValue && (n64Temp != 0 || !(*(const unsigned __int64 *)&fValue >> 63)) )
+			return FormatInt64(n64Temp, szBuf);
+	}
+
+	return sprintf(szBuf, "%.15g", fValue);		// Have at least 15 digits after the . for precision (default is 6)
+
+} // FormatDouble()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ParseInt64()
+//
+// Fast path for the common "[+-]digits" strings.  Returns false (and the
+// caller should fall back to atoi() etc.) if the string is anything else or
+// has more than nMaxDigits digits - so overflow/whitespace/junk behaviour is
+// left exactly as the CRT has it.
+///////////////////////////////////////////////////////////////////////////////
+
+bool Variant::ParseInt64(const char *szNum, __int64 &n64Value, int nMaxDigits)
+{
+	bool	bNeg = false;
+	int		nDigits = 0;
+	__int64	n64Temp = 0;
+
+	if (*szNum == '-' || *szNum == '+')
+		bNeg = (*szNum++ == '-');
+
+	while (*szNum >= '0' && *szNum <= '9')
+	{
+		if (++nDigits > nMaxDigits)
+			return false;
+		n64Temp = n64Temp * 10 + (*szNum++ - '0');
+	}
+
+	if (nDigits == 0 || *szNum != '\0')
+		return false;
+
+	n64Value = bNeg ? -n64Temp : n64Temp;
+
+	return true;
+
+} // ParseInt64()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ParseDouble()
+//
+// Fast path for "[+-]digits[.digits]" strings of up to 15 digits.  The
+// digits and the power of ten are then both exact doubles so one division
+// gives the correctly rounded result (same as atof).  Returns false for
+// anything else (exponents, long numbers, junk) - use atof() for those.
+///////////////////////////////////////////////////////////////////////////////
+
+bool Variant::ParseDouble(const char *szNum, double &fValue)
+{
+	static const double fPow10[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+	};
+
+	bool	bNeg = false;
+	int		nDigits = 0;
+	int		nFrac = -1;							// Digits after the . (-1 = no . yet)
+	__int64	n64Temp = 0;
+
+	if (*szNum == '-' || *szNum == '+')
+		bNeg = (*szNum++ == '-');
+
+	for (;;)
+	{
+		if (*szNum >= '0' && *szNum <= '9')
+		{
+			if (++nDigits > 15)
+				return false;
+			n64Temp = n64Temp * 10 + (*szNum - '0');
+			if (nFrac >= 0)
+				++nFrac;
+		}
+		else if (*szNum == '.' && nFrac < 0)
+			nFrac = 0;
+		else
+			break;
+
+		++szNum;
+	}
+
+	if (nDigits == 0 || *szNum != '\0')
+		return false;
+
+	fValue = (double)n64Temp;
+	if (nFrac > 0)
+		fValue /= fPow10[nFrac];
+	if (bNeg)
+		fValue = -fValue;
+
+	return true;
+
+} // ParseDouble()
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // szValue()
 ///////////////////////////////////////////////////////////////////////////////
@@ -243,7 +445,12 @@ double Variant::fValue(void)
 				return (double)nTemp;
 			}
 			else
+			{
+				double	fTemp;
+				if (ParseDouble(m_szValue, fTemp))
+					return fTemp;
 				return atof(m_szValue);
+			}
 
 		case VAR_REFERENCE:
 		case VAR_ARRAY:
@@ -282,7 +489,12 @@ int	Variant::nValue(void)
 				return nTemp;
 			}
 			else
+			{
+				__int64	n64Temp;
+				if (ParseInt64(m_szValue, n64Temp, 9))
+					return (int)n64Temp;
 				return atoi(m_szValue);
+			}
 
 		case VAR_REFERENCE:
 		case VAR_ARRAY:
@@ -321,7 +533,12 @@ __int64	Variant::n64Value(void)
 				return (__int64)nTemp;
 			}
 			else
+			{
+				__int64	n64Temp;
+				if (ParseInt64(m_szValue, n64Temp, 18))
+					return n64Temp;
 				return _atoi64(m_szValue);
+			}
 
 		case VAR_REFERENCE:
 		case VAR_ARRAY:
@@ -376,6 +593,7 @@ void Variant::GenStringValue(void)
 		return;									// Already a current string, nothing to do
 
 	char	szTemp[128];						// It is unclear just how many 0000 the sprintf function can add...
+	int		nLen;
 
 	InvalidateStringValue();					// Remove previous string cache
 
@@ -383,35 +601,35 @@ void Variant::GenStringValue(void)
 	{
 		case VAR_INT32:
 			// Work out the string representation of the number
-			itoa(m_nValue, szTemp, 10);
+			nLen = FormatInt64((__int64)m_nValue, szTemp);
 			break;
 
 		case VAR_INT64:
 			// Work out the string representation of the number
-			_i64toa(m_n64Value, szTemp, 10);
+			nLen = FormatInt64(m_n64Value, szTemp);
 			break;
 
 
 		case VAR_DOUBLE:
 			// Work out the string representation of the number, don't print trailing zeros
-			sprintf(szTemp, "%.15g", m_fValue);		// Have at least 15 digits after the . for precision (default is 6)
+			nLen = FormatDouble(m_fValue, szTemp);
 			break;
 
-		case VAR_REFERENCE:
-		case VAR_ARRAY:
-			szTemp[0] = '\0';
+		case VAR_HWND:
+			nLen = sprintf(szTemp, "%p", m_hWnd);
 			break;
 
-		case VAR_HWND:
-			sprintf(szTemp, "%p", m_hWnd);
+		default:								// VAR_REFERENCE, VAR_ARRAY
+			szTemp[0] = '\0';
+			nLen = 0;
 			break;
 	}
 
 	// Copy from szTemp
-	m_nStrLen = (int)strlen(szTemp);
+	m_nStrLen = nLen;
 	m_nStrAlloc = m_nStrLen + 1;
 	m_szValue = new char[m_nStrAlloc];
-	strcpy(m_szValue, szTemp);
+	memcpy(m_szValue, szTemp, m_nStrAlloc);
 
 } // GenStringValue()
 
@@ -430,13 +648,40 @@ void Variant::InvalidateStringValue(void)
 {
 	if (m_szValue)
 	{
-		delete [] m_szValue;
+		if (m_szValue != m_szInline)
+			delete [] m_szValue;
 		m_szValue = NULL;
 	}
 
 } // InvalidateStringValue()
 
 
+///////////////////////////////////////////////////////////////////////////////
+// StringAlloc()
+//
+// Sets m_szValue to a buffer of at least nAlloc bytes and m_nStrAlloc to its
+// size.  Short strings use the union so only call this for VAR_STRING types
+// (and after any previous string has been freed).
+///////////////////////////////////////////////////////////////////////////////
+
+char * Variant::StringAlloc(int nAlloc)
+{
+	if (nAlloc <= VAR_STRINLINE)
+	{
+		m_nStrAlloc	= VAR_STRINLINE;
+		m_szValue	= m_szInline;
+	}
+	else
+	{
+		m_nStrAlloc	= nAlloc;
+		m_szValue	= new char[nAlloc];
+	}
+
+	return m_szValue;
+
+} // StringAlloc()
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Overloaded operator=() for variants
 ///////////////////////////////////////////////////////////////////////////////
@@ -469,9 +714,8 @@ Variant& Variant::operator=(const Variant &vOp2)
 
 		case VAR_STRING:
 			m_nStrLen = vOp2.m_nStrLen;
-			m_nStrAlloc = vOp2.m_nStrAlloc;
-			m_szValue = new char[m_nStrAlloc];	// Same as the ALLOCATED size of the other string
-			strcpy(m_szValue, vOp2.m_szValue);
+			StringAlloc(vOp2.m_nStrAlloc);		// Same as the ALLOCATED size of the other string
+			memcpy(m_szValue, vOp2.m_szValue, m_nStrLen + 1);
 			break;
 
 		case VAR_REFERENCE:
@@ -495,15 +739,9 @@ Variant& Variant::operator=(const Variant &vOp2)
 			// Allocate this array (based on _current_ subscript)
 			ArrayDim();
 
-			// Now copy the individual variant elements (each array element is a pointer to a variant)
-			for (i=0; i<m_Array->nElements; i++)
-			{
-				if (vOp2.m_Array->Data[i] != NULL)
-				{
-					m_Array->Data[i] = new Variant;	// Allocate a variant for this spot
-					*(m_Array->Data[i]) = *(vOp2.m_Array->Data[i]);
-				}
-			}
+			// Now copy the individual variant elements (one contiguous block)
+			for (__int64 n=0; n<m_Array->nElements; n++)
+				m_Array->Data[n] = vOp2.m_Array->Data[n];
 			break;
 	}
 
@@ -593,15 +831,43 @@ Variant& Variant::operator=(const char *szOp2)
 
 	// Copy the string
 	m_nStrLen = (int)strlen(szOp2);
-	m_nStrAlloc =  m_nStrLen + 1;
-	m_szValue = new char[m_nStrAlloc];
-	strcpy(m_szValue, szOp2);
+	StringAlloc(m_nStrLen + 1);
+	memcpy(m_szValue, szOp2, m_nStrLen + 1);
 
 	return *this;								// Return this object that generated the call
 
 } // operator=()
 
 
+///////////////////////////////////////////////////////////////////////////////
+// SetString()
+//
+// Assigns a string that isn't \0 terminated (e.g. part of a file) in one
+// copy.  Like a C string assignment the string ends at the first \0 found.
+///////////////////////////////////////////////////////////////////////////////
+
+Variant& Variant::SetString(const char *szStr, int nLen)
+{
+	const char	*szNull = (const char *)memchr(szStr, '\0', nLen);
+
+	// Free any local array data / zero array variables
+	ReInit();
+
+	m_nVarType	= VAR_STRING;
+
+	if (szNull)
+		nLen = (int)(szNull - szStr);
+
+	m_nStrLen = nLen;
+	StringAlloc(m_nStrLen + 1);
+	memcpy(m_szValue, szStr, nLen);
+	m_szValue[nLen] = '\0';
+
+	return *this;								// Return this object that generated the call
+
+} // SetString()
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Overloaded operator=() for pointers
 ///////////////////////////////////////////////////////////////////////////////
@@ -1331,34 +1597,37 @@ void Variant::Concat(Variant &vOp2)
 {
 	char	*szTempString;
 	const char	*szOp2;
+	int		nOp2Len;
 
 	// This must be a string type
 	ChangeToString();
 
 	// Ensure that the other variant has a valid string value and
 	// the m_nStrLen m_nStrAlloc variables - VERY IMPORTANT
-	szOp2 = vOp2.szValue();
-
-	// Get new total string length
-	m_nStrLen += vOp2.m_nStrLen;
+	szOp2	= vOp2.szValue();
+	nOp2Len	= vOp2.m_nStrLen;
 
 	// Do we have enough space for the concat?
-	if ( (m_nStrLen+1) > m_nStrAlloc)			// +1 for \0
+	if ( (m_nStrLen+nOp2Len+1) > m_nStrAlloc)	// +1 for \0
 	{
-		// Create DOUBLE the space we need (room to grow)
-		m_nStrAlloc = (m_nStrLen << 1) + 1;
+		// Create DOUBLE the space we need (room to grow) so that repeated
+		// appends only copy the string O(log n) times
+		m_nStrAlloc = ((m_nStrLen+nOp2Len) << 1) + 1;
 
 		szTempString	= new char[m_nStrAlloc];
+		memcpy(szTempString, m_szValue, m_nStrLen);
+		memcpy(&szTempString[m_nStrLen], szOp2, nOp2Len);
 
-		strcpy(szTempString, m_szValue);
-		strcat(szTempString, szOp2);
-
-		delete [] m_szValue;
+		if (m_szValue != m_szInline)
+			delete [] m_szValue;				// (After the copy as vOp2 may be this)
 		m_szValue	= szTempString;
 	}
 	else
-		strcat(m_szValue, szOp2);		// We have the space - no need to realloc
+		memcpy(&m_szValue[m_nStrLen], szOp2, nOp2Len);	// We have the space - no need to realloc
 
+	// Lengths are known so no strcat() rescanning the whole string each time
+	m_nStrLen += nOp2Len;
+	m_szValue[m_nStrLen] = '\0';
 
 } // Concat()
 
@@ -1378,6 +1647,7 @@ void Variant::ArrayDetailsCreate(void)
 
 		m_Array->Data			= NULL;
 		m_Array->nElements		= 0;
+		m_Array->nCapacity		= 0;
 		m_Array->Dimensions		= 0;
 		m_Array->DimensionsCur	= 0;
 
@@ -1452,19 +1722,13 @@ void Variant::ArrayFree(void)
 	if (m_nVarType != VAR_ARRAY || m_Array == NULL)
 		return;							// Not an array or no array details
 
-	if (m_Array->Data)					// Only delete if used
-	{
-		// Delete all the individual variants' in the array
-		for (int i=0; i<m_Array->nElements; i++)
-			delete m_Array->Data[i];
-
-		// Delete the array
-		delete [] m_Array->Data;
-		m_Array->Data = NULL;
-	}
+	// Delete the array (and all the variants in it)
+	delete [] m_Array->Data;
+	m_Array->Data = NULL;
 
 	// Zero everything for possible reuse
 	m_Array->nElements		= 0;
+	m_Array->nCapacity		= 0;
 	m_Array->Dimensions		= 0;
 	//DimensionsCur	= 0;				// DO NOT UNCOMMENT
 
@@ -1474,50 +1738,204 @@ void Variant::ArrayFree(void)
 ///////////////////////////////////////////////////////////////////////////////
 // ArrayDim()
 //
-// Create an array based on the current subscript details
+// Create an array based on the current subscript details.  The elements are
+// stored inline in one block and the stride of each subscript is worked out
+// here so that ArrayGetElem() is a single pass.
 ///////////////////////////////////////////////////////////////////////////////
 
 bool Variant::ArrayDim(void)
 {
-	int	i;
+	int		i;
+	__int64	nElements;
+	Variant	*lpData;
 
 	if (m_nVarType != VAR_ARRAY)
 		return false;							// ArrayCreateDetails not been called!
 
+	// Work out the total number of elements required
+	nElements = 1;
+	for (i=0; i<m_Array->DimensionsCur; i++)
+	{
+		// Check if the array is too big to allocate (checked before multiplying so
+		// the 64bit count can't overflow either)
+		if ( m_Array->SubscriptCur[i] < 0 ||
+			(m_Array->SubscriptCur[i] > 0 && nElements > VAR_ARRAY_MAXELEMENTS / m_Array->SubscriptCur[i]) )
+			return false;						// Abort (any previous array is untouched)
+
+		nElements = nElements * m_Array->SubscriptCur[i];
+	}
+
+	// Create space for the array, all elements start as the default variant
+	lpData = ArrayAlloc(nElements);
+	if (lpData == NULL)
+		return false;							// Out of memory (any previous array is untouched)
+
 	// Delete any cached string values and any previous array DATA - Do not use
 	// ReInit() as the SubScriptCur contains valid data that would be destroyed
 	InvalidateStringValue();
 	ArrayFree();
 
-	// Copy the subscripts required and work out the total number of elements
+	// Copy the subscripts required
+	m_Array->Data		= lpData;
+	m_Array->nElements	= nElements;
+	m_Array->nCapacity	= nElements;
 	m_Array->Dimensions	= m_Array->DimensionsCur;
-	m_Array->nElements	= 1;
 	for (i=0; i<m_Array->Dimensions; i++)
-	{
 		m_Array->Subscript[i] = m_Array->SubscriptCur[i];
-		m_Array->nElements = m_Array->nElements * m_Array->Subscript[i];
 
-		// Check if the array is too big (4096*4096 (0x1000000) elements is 64MB JUST FOR THE TABLE!)
-		if ( m_Array->nElements >= 0x1000000 )
-			return false;						// Abort
+	// Work out the strides (last subscript varies fastest)
+	__int64 nStride = 1;
+	for (i=m_Array->Dimensions-1; i>=0; i--)
+	{
+		m_Array->Stride[i] = nStride;
+		nStride *= m_Array->Subscript[i];
 	}
 
-	// Create space for the array (effectively an array of Variant POINTERS)
-	m_Array->Data = new Variant *[m_Array->nElements];
+	return true;
+
+} // ArrayDim()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ArrayAlloc()
+//
+// Allocates a block of default variants, or returns NULL if there isn't
+// enough memory.  The application's new handler ends the program when new
+// fails, so it is switched off for this one allocation - a Dim that is too
+// big is reported to the script rather than killing it.
+///////////////////////////////////////////////////////////////////////////////
+
+Variant * Variant::ArrayAlloc(__int64 nElements)
+{
+	_PNH	pfnOldHandler = _set_new_handler(NULL);
+	Variant	*lpData = new (std::nothrow) Variant[(size_t)nElements];
+
+	_set_new_handler(pfnOldHandler);
 
-	// We will allocate array entries when required, so just NULL for now
-	for (i=0; i<m_Array->nElements; i++)
-		m_Array->Data[i] = NULL;
+	return lpData;
+
+} // ArrayAlloc()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ArrayReDim()
+//
+// Resize the array to the current subscript details keeping the values of
+// elements that are still in range (REDIM keyword).
+///////////////////////////////////////////////////////////////////////////////
+
+bool Variant::ArrayReDim(void)
+{
+	int	i;
+
+	if (m_nVarType != VAR_ARRAY)
+		return false;							// ArrayCreateDetails not been called!
+
+	// If only the first subscript changes (e.g. adding rows) then all existing elements
+	// keep their position and the array can be resized in place
+	if (m_Array->Data != NULL && m_Array->Dimensions > 0 && m_Array->Dimensions == m_Array->DimensionsCur)
+	{
+		for (i=1; i<m_Array->Dimensions; i++)
+		{
+			if (m_Array->SubscriptCur[i] != m_Array->Subscript[i])
+				break;
+		}
+
+		if (i == m_Array->Dimensions)
+			return ArrayResizeFirst();
+	}
+
+	// Otherwise create a new array with the new subscript and move the old elements into it
+	Variant	vOld;
+
+	vOld.Swap(*this);
+	ArrayDetailsCreate();
+
+	m_Array->DimensionsCur = vOld.m_Array->DimensionsCur;
+	for (i=0; i<m_Array->DimensionsCur; i++)
+		m_Array->SubscriptCur[i] = vOld.m_Array->SubscriptCur[i];
+
+	if (ArrayDim() == false)
+	{
+		Swap(vOld);								// Failed, leave the original array alone
+		return false;
+	}
+
+	if (vOld.m_Array->Dimensions > 0)
+		ArrayMove(vOld);
 
 	return true;
 
-} // ArrayDim()
+} // ArrayReDim()
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ArrayResizeFirst()
+//
+// ReDim where only the first subscript has changed.  The block is allocated
+// with spare capacity (doubling) so that scripts that append one row at a
+// time get amortized O(1) growth instead of a full copy each time.
+// Elements past nElements are always default variants.
+///////////////////////////////////////////////////////////////////////////////
+
+bool Variant::ArrayResizeFirst(void)
+{
+	__int64	n;
+	__int64	nNew;
+
+	if (m_Array->SubscriptCur[0] < 0)
+		return false;
+
+	// Stride[0] is the number of elements in each "row" of the first subscript
+	if (m_Array->SubscriptCur[0] > 0 && m_Array->Stride[0] > VAR_ARRAY_MAXELEMENTS / m_Array->SubscriptCur[0])
+		return false;							// Too big
+
+	nNew = m_Array->Stride[0] * m_Array->SubscriptCur[0];
+
+	InvalidateStringValue();
+
+	if (nNew > m_Array->nCapacity)
+	{
+		// Grow, at least doubling the capacity
+		__int64	nCapacity = m_Array->nCapacity * 2;
+
+		if (nCapacity < nNew || nCapacity > VAR_ARRAY_MAXELEMENTS)
+			nCapacity = nNew;
+
+		Variant	*lpData = ArrayAlloc(nCapacity);
+		if (lpData == NULL)
+			return false;						// Out of memory (array is untouched)
+
+		for (n=0; n<m_Array->nElements; n++)
+			lpData[n].Swap(m_Array->Data[n]);
+
+		delete [] m_Array->Data;
+		m_Array->Data		= lpData;
+		m_Array->nCapacity	= nCapacity;
+	}
+	else
+	{
+		// Shrink (or same size), release the values of any elements dropped
+		for (n=nNew; n<m_Array->nElements; n++)
+		{
+			Variant	vEmpty;
+			m_Array->Data[n].Swap(vEmpty);
+		}
+	}
+
+	m_Array->Subscript[0]	= m_Array->SubscriptCur[0];
+	m_Array->nElements		= nNew;
+
+	return true;
+
+} // ArrayResizeFirst()
 
 
 ///////////////////////////////////////////////////////////////////////////////
 // ArrayGetElem()
 //
-// Returns the index to the current array element
+// Returns the index to the current array element, or -1 if the current
+// subscript is the wrong size or out of bounds.
 //
 //[2][2][2]
 // a  b  c
@@ -1533,45 +1951,42 @@ bool Variant::ArrayDim(void)
 // 1  1  0 		element 6
 // 1  1  1		element 7
 //
-// index  = 0
-// index += s1 * b * c
-// index += s2 * c
-// index += s3
+// index  = s1 * Stride[0] + s2 * Stride[1] + s3 * Stride[2]
+// where Stride[0] = b * c, Stride[1] = c, Stride[2] = 1 (set by ArrayDim)
 //
 // e.g. [1][0][1]
-// index  = 0
-// index += 1 * 2 * 2
-// index += 0 * 2
-// index += 1
+// index  = 1*4 + 0*2 + 1*1
 // index equals element 5
 //
 ///////////////////////////////////////////////////////////////////////////////
-int Variant::ArrayGetElem(void)
+__int64 Variant::ArrayGetElem(void)
 {
-	int i, j;
-	int index, mult;
+	int		i, nSub;
+	__int64	index;
 
 	// Do we have array data?
 	if (m_nVarType != VAR_ARRAY)
 		return -1;
 
-	// Get for correct number of subscripts/size etc
-	if (ArrayBoundsCheck() == false)
+	// Get for correct number of subscripts
+	if (m_Array->Dimensions != m_Array->DimensionsCur)
 		return -1;
 
 	// Convert our multidimensional array to an element in our internal single dimension array
+	// checking each subscript is in range as we go
 	index = 0;
 	for (i=0; i<m_Array->Dimensions; i++)
 	{
-		mult = 1;
-		for (j=i+1; j<m_Array->Dimensions; j++)
-			mult = mult * m_Array->Subscript[j];
+		nSub = m_Array->SubscriptCur[i];
+		if (nSub < 0 || nSub >= m_Array->Subscript[i])
+			return -1;
 
-		mult = mult * m_Array->SubscriptCur[i];
-		index += mult;
+		index += nSub * m_Array->Stride[i];
 	}
+
 	return index;
-}
+
+} // ArrayGetElem()
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1580,12 +1995,12 @@ int Variant::ArrayGetElem(void)
 // Returns a pointer to the current array element
 // See GetArrayElem() for mapping info.
 //
-// By default bCreate is true so the array entry is created.
+// Elements are all allocated by ArrayDim() so there is nothing to create here.
 ///////////////////////////////////////////////////////////////////////////////
 
-Variant* Variant::ArrayGetRef(bool bCreate)
+Variant* Variant::ArrayGetRef(void)
 {
-	int	index;
+	__int64	index;
 
 	index = ArrayGetElem();
 
@@ -1593,40 +2008,11 @@ Variant* Variant::ArrayGetRef(bool bCreate)
 	// not a valid element
 		return NULL;
 
-	// index is the entry we need to return, if required, allocate the entry
-	// otherwise return previously allocated entry
-
-	if (m_Array->Data[index] == NULL && bCreate)
-		m_Array->Data[index] = new Variant;
-
-	return m_Array->Data[index];
+	return &m_Array->Data[index];
 
 } // ArrayGetRef()
 
 
-///////////////////////////////////////////////////////////////////////////////
-// ArrayBoundsCheck()
-///////////////////////////////////////////////////////////////////////////////
-
-bool Variant::ArrayBoundsCheck(void)
-{
-	int	i;
-
-	if (m_Array->Dimensions != m_Array->DimensionsCur)
-		return false;
-
-	for (i=0; i<m_Array->Dimensions; i++)
-	{
-		if (m_Array->SubscriptCur[i] < 0 || m_Array->SubscriptCur[i] >= m_Array->Subscript[i])
-			return false;
-	}
-
-	// If we get here then the requested subscript is in bounds
-	return true;
-
-} // ArrayBoundsCheck()
-
-
 ///////////////////////////////////////////////////////////////////////////////
 // ArrayGetBound(int)
 //
@@ -1652,49 +2038,61 @@ int Variant::ArrayGetBound(int iSub)
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// ArrayCopy(Variant &)
+// ArrayMove(Variant &)
 //
-// Copy the other array into the current one, matching array locations.
+// Move the elements of the other array into the current one, matching array
+// locations.  Elements are swapped rather than copied so the other array is
+// left with default values where the arrays overlap.
 // To be used after ArrayDim() in REDIM keyword
 ///////////////////////////////////////////////////////////////////////////////
-bool Variant::ArrayCopy(Variant &other)
+bool Variant::ArrayMove(Variant &other)
 {
-	int i;
-	Variant *vOldValue, *vLocal;
+	int		i, nDims;
+	int		nCount[VAR_SUBSCRIPT_MAX];		// Overlapping size of each subscript
+	int		nSub[VAR_SUBSCRIPT_MAX];		// Current position in the overlap
+	__int64	nIndex, nOtherIndex;
 
 	// make sure that this is an array and that the other is the same size.
-	if (m_Array->Dimensions == 0 || m_Array->Dimensions != other.m_Array->Dimensions)
+	if (m_nVarType != VAR_ARRAY || other.m_nVarType != VAR_ARRAY)
 		return false;
-	// reset subscripts for comparison
-	for (i=0; i<m_Array->Dimensions; ++i) {
-		m_Array->SubscriptCur[i]=0;
-		other.m_Array->SubscriptCur[i]=0;
+
+	nDims = m_Array->Dimensions;
+	if (nDims == 0 || nDims != other.m_Array->Dimensions)
+		return false;
+
+	for (i=0; i<nDims; ++i)
+	{
+		nCount[i] = m_Array->Subscript[i] < other.m_Array->Subscript[i] ? m_Array->Subscript[i] : other.m_Array->Subscript[i];
+		if (nCount[i] == 0)
+			return true;						// Nothing overlaps
+		nSub[i] = 0;
 	}
-	// start copying
-	do {
-		// check if variant in other exists
-		i = other.ArrayGetElem();
-		if (i < 0)
-			vOldValue = NULL;
-		else
-			vOldValue = other.m_Array->Data[i];
-		if (vOldValue != NULL) {
-			// copy variant
-			vLocal = ArrayGetRef();
-			if (vLocal != NULL)
-				*vLocal = *vOldValue;
+
+	// Walk the overlapping region a row (last subscript) at a time
+	for (;;)
+	{
+		nIndex = nOtherIndex = 0;
+		for (i=0; i<nDims-1; ++i)
+		{
+			nIndex		+= nSub[i] * m_Array->Stride[i];
+			nOtherIndex	+= nSub[i] * other.m_Array->Stride[i];
 		}
-		// increment search locations
-		for (i=0; i<m_Array->Dimensions; ++i) {
-			++m_Array->SubscriptCur[i];
-			++other.m_Array->SubscriptCur[i];
-			if (ArrayBoundsCheck() && other.ArrayBoundsCheck())
+
+		for (i=0; i<nCount[nDims-1]; ++i)
+			m_Array->Data[nIndex+i].Swap(other.m_Array->Data[nOtherIndex+i]);
+
+		// Next row
+		for (i=nDims-2; i>=0; --i)
+		{
+			if (++nSub[i] < nCount[i])
 				break;
-			m_Array->SubscriptCur[i]=0;
-			other.m_Array->SubscriptCur[i]=0;
+			nSub[i] = 0;
 		}
-	} while (i<m_Array->Dimensions);
 
-	return false;
+		if (i < 0)
+			break;								// Done
+	}
+
+	return true;
 
-} // ArrayCopy
+} // ArrayMove()
@@ -79,6 +79,7 @@
 
 #define VAR_ITOA_MAX		65					// Maximum returned length of an i64toa operation
 #define VAR_SUBSCRIPT_MAX	64					// Maximum number of subscripts for an array
+#define VAR_STRINLINE		8					// Strings up to this size (inc \0) are held in the union
 
 
 
@@ -97,6 +98,7 @@ public:
 	Variant&	operator=(HWND nOp2);			// Overloaded = for HWNDs
 	Variant&	operator=(double fOp2);			// Overloaded = for floats
 	Variant&	operator=(const char *szOp2);	// Overloaded = for strings
+	Variant&	SetString(const char *szStr, int nLen);	// Assign up to nLen chars (stops at a \0)
 	Variant&	operator=(Variant *pOp2);		// Overloaded = for pointers/references
 	Variant&	operator+=(Variant &vOp2);		// Overloaded += (addition/concatenation)
 	Variant&	operator-=(Variant &vOp2);		// Overloaded -= (subtraction)
@@ -114,6 +116,10 @@ public:
 
 	bool		StringCompare(Variant &vOp2);			// Compare two strings with case sense
 	bool		HexToDec(const char *szHex, int &nDec);	// Convert hex string to an integer
+	static int	FormatInt64(__int64 n64Value, char *szBuf);	// Fast _i64toa(), returns length
+	static int	FormatDouble(double fValue, char *szBuf);	// Fast sprintf("%.15g"), returns length
+	static bool	ParseInt64(const char *szNum, __int64 &n64Value, int nMaxDigits);	// Fast path for simple integer strings
+	static bool	ParseDouble(const char *szNum, double &fValue);	// Fast path for simple decimal strings
 	void		Concat(Variant &vOp2);					// Concats two variants (forces string if possible)
 	void		ChangeToDouble(void);					// Convert variant to a DOUBLE
 	void		ChangeToString(void);					// Convert variant to a STRING
@@ -123,14 +129,18 @@ public:
 	void		ArraySubscriptClear(void);			// Reset the current subscript
 	bool		ArraySubscriptSetNext(int iSub);	// Set next subscript
 	bool		ArrayDim(void);						// Allocate memory for array
+	bool		ArrayReDim(void);					// Resize array to the current subscript, keeping values
 	void		ArrayFree(void);					// Releases all memory in the array and resets
-	Variant*	ArrayGetRef(bool bCreate=true);		// Returns a pointer to cur array element, creating them if not present
+	Variant*	ArrayGetRef(void);					// Returns a pointer to cur array element (NULL if out of bounds)
 	int			ArrayGetBound(int iSub);			// Returns size of dimension.  returns -1 if not defined
-	bool		ArrayCopy(Variant &other);			// Copies the given array into the current variant, minding array bounds
+	bool		ArrayMove(Variant &other);			// Moves the elements of the given array into the current one, minding array bounds
+
+	void		Swap(Variant &vOp2);				// Exchange contents with another variant (no copying)
 
 	// Properties
 	int		type(void) const { return m_nVarType; }	// Returns variant type
 	const char	*szValue(void);						// Returns string value
+	int			szLength(void) { szValue(); return m_nStrLen; }	// Returns length of string value
 	double		fValue(void);						// Returns float (double) value
 	int			nValue(void);						// Returns int value
 	__int64		n64Value(void);						// Returns int64 value
@@ -153,10 +163,12 @@ private:
 	// Structure used for storing array details
 	typedef struct
 	{
-		Variant	**Data;							// Memory area for the array (array of Variant pointers) (NULL = not used)
+		Variant	*Data;							// Memory area for the array (contiguous block of Variants) (NULL = not used)
 
-		int		nElements;						// Actual number of elements in array ([10][10] = 100 elements)
+		__int64	nElements;						// Actual number of elements in array ([10][10] = 100 elements)
+		__int64	nCapacity;						// Number of elements allocated in Data (>= nElements)
 		int		Subscript[VAR_SUBSCRIPT_MAX];	// Subscript details
+		__int64	Stride[VAR_SUBSCRIPT_MAX];		// Elements between consecutive values of each subscript
 		int		SubscriptCur[VAR_SUBSCRIPT_MAX];	// Current subscript
 		char	Dimensions;						// Number of dimensions/subscripts
 		char	DimensionsCur;					// Current number of dimensions
@@ -178,6 +190,7 @@ private:
 		Variant				*m_pValue;			// Value of pointer (for VAR_REFERENCE)
 		VariantArrayDetails	*m_Array;			// Value of array (for VAR_ARRAY)
 		HWND				m_hWnd;				// Value of handle (for VAR_HWND)
+		char				m_szInline[VAR_STRINLINE];	// Short string (for VAR_STRING - m_szValue points here)
 	};
 
 	// There is always a string value even if not a string type so that
@@ -192,11 +205,13 @@ private:
 	void		ReInit(void);					// Reset a variant to initial values
 	void		GenStringValue(void);			// Generate internal values as required
 	void		InvalidateStringValue(void);	// Invalidate the cached string value
+	char *		StringAlloc(int nAlloc);		// Allocate m_szValue (inline if small enough, VAR_STRING only)
 	int			GetComparisionType(int nOp1, int nOp2) const;
 	void		ArrayDetailsCreate();
 	void		ArrayDetailsFree();
-	bool		ArrayBoundsCheck(void);			// Checks if requested subscript is in range
-	int			ArrayGetElem(void);				// Returns which element of the array corresponds to current array values;
+	__int64		ArrayGetElem(void);				// Returns which element of the array corresponds to current array values (-1 = out of range)
+	bool		ArrayResizeFirst(void);			// ReDim changing only the first subscript (in place)
+	static Variant *	ArrayAlloc(__int64 nElements);	// Allocate array elements (NULL if out of memory)
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -58,7 +58,7 @@
 // Constructor()
 ///////////////////////////////////////////////////////////////////////////////
 
-VectorToken::VectorToken() : m_nItems(0), m_lpFirst(NULL), m_lpLast(NULL)
+VectorToken::VectorToken() : m_nItems(0), m_nAlloc(VECTORTOKEN_INLINE), m_lpItems(m_Inline)
 {
 
 } // VectorToken()
@@ -68,16 +68,12 @@ VectorToken::VectorToken() : m_nItems(0), m_lpFirst(NULL), m_lpLast(NULL)
 // Copy Constructor()
 ///////////////////////////////////////////////////////////////////////////////
 
-VectorToken::VectorToken(const VectorToken &vSource) : m_nItems(0), m_lpFirst(NULL), m_lpLast(NULL)
+VectorToken::VectorToken(const VectorToken &vSource) : m_nItems(0), m_nAlloc(VECTORTOKEN_INLINE), m_lpItems(m_Inline)
 {
-	VectorTokenNode	*lpTemp;
+	unsigned int	i;
 
-	lpTemp = vSource.m_lpFirst;
-	while(lpTemp != NULL)
-	{
-		push_back(lpTemp->tItem);
-		lpTemp = lpTemp->lpNext;
-	}
+	for (i = 0; i < vSource.m_nItems; ++i)
+		push_back(vSource.m_lpItems[i]);
 }
 
 
@@ -87,69 +83,56 @@ VectorToken::VectorToken(const VectorToken &vSource) : m_nItems(0), m_lpFirst(NU
 
 VectorToken::~VectorToken()
 {
-	VectorTokenNode	*lpTemp, *lpTemp2;
-
-	lpTemp = m_lpFirst;
-
-	while(lpTemp != NULL)
-	{
-		lpTemp2 = lpTemp->lpNext;
-		delete lpTemp;
-		lpTemp = lpTemp2;
-	}
+	if (m_lpItems != m_Inline)
+		delete [] m_lpItems;
 
 } // ~VectorToken()
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// Overloaded operator[]()
+// Overloaded operator=()
 ///////////////////////////////////////////////////////////////////////////////
 
-Token& VectorToken::operator[](unsigned int nIndex)
+VectorToken& VectorToken::operator=(VectorToken &vOp2)
 {
-	// Check bounds
-	if (nIndex >= m_nItems)
-	{
-		m_tNull.m_nType = TOK_END;
-		return m_tNull;							// return an END token
-	}
+	if ( this == &vOp2 )
+		return *this;
 
+	// Clear this vector
+	clear();
 
-	// Loop through and return the correct token
+	// Copy items
 	unsigned int	i;
-	VectorTokenNode	*lpTemp;
 
-	lpTemp = m_lpFirst;
+	for (i = 0; i < vOp2.m_nItems; ++i)
+		push_back(vOp2.m_lpItems[i]);
 
-	for (i=0; i<nIndex; i++)
-		lpTemp = lpTemp->lpNext;
+	return *this;								// Return this object that generated the call
 
-	return lpTemp->tItem;
 
-} // operator[]()
+} // operator=()
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// Overloaded operator=()
+// grow()
+// Doubles the allocated size, tokens are swapped across rather than copied
 ///////////////////////////////////////////////////////////////////////////////
 
-VectorToken& VectorToken::operator=(VectorToken &vOp2)
+void VectorToken::grow(void)
 {
-	if ( this == &vOp2 )
-		return *this;
-
-	// Clear this vector
-	clear();
+	unsigned int	i;
+	Token			*lpNew = new Token[m_nAlloc * 2];
 
-	// Copy items
-	int nSize = vOp2.size();
-	for (int i=0; i<nSize; ++i)
-		push_back(vOp2[i]);
+	for (i = 0; i < m_nItems; ++i)
+		lpNew[i].Swap(m_lpItems[i]);
 
-	return *this;								// Return this object that generated the call
+	if (m_lpItems != m_Inline)
+		delete [] m_lpItems;
 
+	m_lpItems	= lpNew;
+	m_nAlloc	*= 2;
 
-} // operator=()
+} // grow()
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -159,26 +142,23 @@ VectorToken& VectorToken::operator=(VectorToken &vOp2)
 
 void VectorToken::push_back(const Token &tItem)
 {
-	VectorTokenNode	*lpTemp;
-
-	// Create a new node
-	lpTemp			= new VectorTokenNode;
-	lpTemp->tItem	= tItem;
-	lpTemp->lpNext	= NULL;
-
-	// Add it to the end of the vector
-	if (m_lpLast)
+	if (m_nItems == m_nAlloc)
 	{
-		m_lpLast->lpNext	= lpTemp;
-		m_lpLast			= lpTemp;
-	}
-	else
-	{
-		// First entry
-		m_lpFirst = m_lpLast = lpTemp;
+		// Full - if the item is one of ours it will move when we grow
+		if (&tItem >= m_lpItems && &tItem < m_lpItems + m_nItems)
+		{
+			unsigned int	nIndex = (unsigned int)(&tItem - m_lpItems);
+
+			grow();
+			m_lpItems[m_nItems] = m_lpItems[nIndex];
+			++m_nItems;
+			return;
+		}
+
+		grow();
 	}
 
-	m_nItems++;
+	m_lpItems[m_nItems++] = tItem;
 
 } // push_back()
 
@@ -200,27 +180,16 @@ bool VectorToken::empty(void) const
 
 ///////////////////////////////////////////////////////////////////////////////
 // clear()
-// Clears all items in the vector
+// Clears all items in the vector (the allocation is kept for reuse)
 ///////////////////////////////////////////////////////////////////////////////
 
 void VectorToken::clear(void)
 {
-	VectorTokenNode	*lpTemp, *lpTemp2;
-
-	lpTemp = m_lpFirst;
+	unsigned int	i;
 
-	while(lpTemp != NULL)
-	{
-		lpTemp2 = lpTemp->lpNext;
-		delete lpTemp;
-		lpTemp = lpTemp2;
-	}
+	for (i = 0; i < m_nItems; ++i)
+		m_lpItems[i].settype(TOK_UNDEFINED);	// Frees any string
 
-	m_nItems	= 0;
-	m_lpFirst	= NULL;
-	m_lpLast	= NULL;
+	m_nItems = 0;
 
 } // clear()
-
-
-
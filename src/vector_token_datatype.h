@@ -50,13 +50,7 @@
 #include "token_datatype.h"
 
 
-// Structs for stack node
-typedef struct _VectorTokenNode
-{
-	Token					tItem;			// The item
-	struct _VectorTokenNode	*lpNext;		// Next node (or NULL)
-
-} VectorTokenNode;
+#define VECTORTOKEN_INLINE	8					// Tokens stored without a heap allocation
 
 
 class VectorToken
@@ -77,17 +71,29 @@ public:
 
 
 	// Overloads
-	Token&			operator[](unsigned int nIndex);// Overloaded []
+	Token&			operator[](unsigned int nIndex)			// Overloaded []
+	{
+		if (nIndex < m_nItems)
+			return m_lpItems[nIndex];
+
+		m_tNull.m_nType = TOK_END;
+		return m_tNull;						// return an END token
+	}
+
 	VectorToken&	operator=(VectorToken &vOp2);	// Overloaded = for vectortokens
 
 
 private:
 	// Variables
 	unsigned int	m_nItems;				// Number of items on stack
-	VectorTokenNode	*m_lpFirst;				// Pointer to first node
-	VectorTokenNode	*m_lpLast;				// Pointer to last node
+	unsigned int	m_nAlloc;				// Number of items allocated
+	Token			*m_lpItems;				// The items (m_Inline until it is outgrown)
+	Token			m_Inline[VECTORTOKEN_INLINE];
 	Token			m_tNull;
 
+	// Functions
+	void			grow(void);
+
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -58,7 +58,7 @@
 // Constructor()
 ///////////////////////////////////////////////////////////////////////////////
 
-VectorVariant::VectorVariant() : m_nItems(0), m_lpFirst(NULL), m_lpLast(NULL)
+VectorVariant::VectorVariant() : m_nItems(0), m_nAlloc(VECTORVARIANT_INLINE), m_lpItems(m_Inline)
 {
 
 } // VectorVariant()
@@ -68,16 +68,12 @@ VectorVariant::VectorVariant() : m_nItems(0), m_lpFirst(NULL), m_lpLast(NULL)
 // Copy Constructor()
 ///////////////////////////////////////////////////////////////////////////////
 
-VectorVariant::VectorVariant(const VectorVariant &vSource) : m_nItems(0), m_lpFirst(NULL), m_lpLast(NULL)
+VectorVariant::VectorVariant(const VectorVariant &vSource) : m_nItems(0), m_nAlloc(VECTORVARIANT_INLINE), m_lpItems(m_Inline)
 {
-	VectorVariantNode	*lpTemp;
+	unsigned int	i;
 
-	lpTemp = vSource.m_lpFirst;
-	while(lpTemp != NULL)
-	{
-		push_back(lpTemp->vItem);
-		lpTemp = lpTemp->lpNext;
-	}
+	for (i = 0; i < vSource.m_nItems; ++i)
+		push_back(vSource.m_lpItems[i]);
 }
 
 
@@ -87,48 +83,32 @@ VectorVariant::VectorVariant(const VectorVariant &vSource) : m_nItems(0), m_lpFi
 
 VectorVariant::~VectorVariant()
 {
-	VectorVariantNode	*lpTemp, *lpTemp2;
-
-	lpTemp = m_lpFirst;
-
-	while(lpTemp != NULL)
-	{
-		lpTemp2 = lpTemp->lpNext;
-		delete lpTemp;
-		lpTemp = lpTemp2;
-	}
+	if (m_lpItems != m_Inline)
+		delete [] m_lpItems;
 
 } // ~VectorVariant()
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// Overloaded operator[]()
+// grow()
+// Doubles the allocated size, variants are swapped across rather than copied
 ///////////////////////////////////////////////////////////////////////////////
 
-Variant& VectorVariant::operator[](unsigned int nIndex)
+void VectorVariant::grow(void)
 {
-	// Check bounds
-	if (nIndex >= m_nItems)
-	{
-//		Variant vTemp;
-//		vTemp = 0;
-//		return vTemp;							// return 0
-		return m_vNull;							// Return our dummy variant
-	}
-
-
-	// Loop through and return the correct token
 	unsigned int	i;
-	VectorVariantNode	*lpTemp;
+	Variant			*lpNew = new Variant[m_nAlloc * 2];
 
-	lpTemp = m_lpFirst;
+	for (i = 0; i < m_nItems; ++i)
+		lpNew[i].Swap(m_lpItems[i]);
 
-	for (i=0; i<nIndex; i++)
-		lpTemp = lpTemp->lpNext;
+	if (m_lpItems != m_Inline)
+		delete [] m_lpItems;
 
-	return lpTemp->vItem;
+	m_lpItems	= lpNew;
+	m_nAlloc	*= 2;
 
-} // operator[]()
+} // grow()
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -138,30 +118,42 @@ Variant& VectorVariant::operator[](unsigned int nIndex)
 
 void VectorVariant::push_back(const Variant &vItem)
 {
-	VectorVariantNode	*lpTemp;
-
-	// Create a new node
-	lpTemp			= new VectorVariantNode;
-	lpTemp->vItem	= vItem;
-	lpTemp->lpNext	= NULL;
-
-	// Add it to the end of the vector
-	if (m_lpLast)
-	{
-		m_lpLast->lpNext	= lpTemp;
-		m_lpLast			= lpTemp;
-	}
-	else
+	if (m_nItems == m_nAlloc)
 	{
-		// First entry
-		m_lpFirst = m_lpLast = lpTemp;
+		// Full - if the item is one of ours it will move when we grow
+		if (&vItem >= m_lpItems && &vItem < m_lpItems + m_nItems)
+		{
+			unsigned int	nIndex = (unsigned int)(&vItem - m_lpItems);
+
+			grow();
+			m_lpItems[m_nItems] = m_lpItems[nIndex];
+			++m_nItems;
+			return;
+		}
+
+		grow();
 	}
 
-	m_nItems++;
+	m_lpItems[m_nItems++] = vItem;
 
 } // push_back()
 
 
+///////////////////////////////////////////////////////////////////////////////
+// pushmove()
+// Pushes a value onto the end of the vector without copying it
+///////////////////////////////////////////////////////////////////////////////
+
+void VectorVariant::pushmove(Variant &vItem)
+{
+	if (m_nItems == m_nAlloc)
+		grow();
+
+	m_lpItems[m_nItems++].Swap(vItem);
+
+} // pushmove()
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // empty()
 // Returns true if the stack is empty
@@ -179,24 +171,16 @@ bool VectorVariant::empty(void) const
 
 ///////////////////////////////////////////////////////////////////////////////
 // clear()
-// Clears all items in the vector
+// Clears all items in the vector (the allocation is kept for reuse)
 ///////////////////////////////////////////////////////////////////////////////
 
 void VectorVariant::clear(void)
 {
-	VectorVariantNode	*lpTemp, *lpTemp2;
-
-	lpTemp = m_lpFirst;
+	unsigned int	i;
 
-	while(lpTemp != NULL)
-	{
-		lpTemp2 = lpTemp->lpNext;
-		delete lpTemp;
-		lpTemp = lpTemp2;
-	}
+	for (i = 0; i < m_nItems; ++i)
+		m_lpItems[i] = 0;						// Frees any string/array
 
-	m_nItems	= 0;
-	m_lpFirst	= NULL;
-	m_lpLast	= NULL;
+	m_nItems = 0;
 
 } // clear()
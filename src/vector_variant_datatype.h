@@ -50,13 +50,7 @@
 #include "variant_datatype.h"
 
 
-// Structs for stack node
-typedef struct _VectorVariantNode
-{
-	Variant						vItem;			// The item
-	struct _VectorVariantNode	*lpNext;		// Next node (or NULL)
-
-} VectorVariantNode;
+#define VECTORVARIANT_INLINE	6				// Variants stored without a heap allocation
 
 
 class VectorVariant
@@ -68,6 +62,7 @@ public:
 	~VectorVariant();							// Destructor
 
 	void			push_back(const Variant &tItem);	// Push item onto end of vector
+	void			pushmove(Variant &vItem);			// Push item by swapping (vItem gets an unused value)
 	void			clear(void);						// Deletes all items
 
 
@@ -77,14 +72,24 @@ public:
 
 
 	// Overloads
-	Variant&		operator[](unsigned int nIndex);		// Overloaded []
+	Variant&		operator[](unsigned int nIndex)			// Overloaded []
+	{
+		if (nIndex < m_nItems)
+			return m_lpItems[nIndex];
+		else
+			return m_vNull;						// Return our dummy variant
+	}
 
 private:
 	// Variables
 	unsigned int		m_nItems;				// Number of items on stack
-	VectorVariantNode	*m_lpFirst;				// Pointer to first node
-	VectorVariantNode	*m_lpLast;				// Pointer to last node
+	unsigned int		m_nAlloc;				// Number of items allocated
+	Variant				*m_lpItems;				// The items (m_Inline until it is outgrown)
+	Variant				m_Inline[VECTORVARIANT_INLINE];
 	Variant				m_vNull;				// Dummy variant to return if [] is out of bounds
+
+	// Functions
+	void				grow(void);
 };
 
 ///////////////////////////////////////////////////////////////////////////////